@@ -2,6 +2,7 @@
 #define __AI__
 
 #include "Debugger.h"
+#include "Mutex.h"
 #include "Types.h"
 
 #define BAGS_FILE_NAME           "Bags.cfg"
@@ -105,12 +106,11 @@ struct AIDataPlane
     }
 
     bool Assigned;
-    int  RefCounter;
-    void AddRef() { RefCounter++; }
+    long RefCounter;
+    void AddRef() { InterlockedIncrement( &RefCounter ); }
     void Release()
     {
-        RefCounter--;
-        if( !RefCounter ) delete this;
+        if( !InterlockedDecrement( &RefCounter ) ) delete this;
     }
     AIDataPlane( uint type, uint priority ) : Type( type ), Priority( priority ), Identifier( 0 ), IdentifierExt( 0 ), ChildPlane( NULL ), IsMove( false ), Assigned( false ), RefCounter( 1 )
     {
@@ -60,6 +60,7 @@ const CmdDef cmdlist[] =
     { "dropuid", COMMAND_DROP_UID },
     { "drop", COMMAND_DROP_UID },
     { "log", COMMAND_LOG },
+    { "profiler", COMMAND_PROFILER },
 };
 
 void PackCommand( const char* str, BufferManager& buf, void (*logcb)( const char* ), const char* name )
@@ -690,6 +691,26 @@ void PackCommand( const char* str, BufferManager& buf, void (*logcb)( const char
             buf.Push( flags, 16 );
             break;
         }
+        case COMMAND_PROFILER:
+        {
+            char action[128];
+            uint sample_time = 0;
+            if( sscanf( args, "%127s%u", action, &sample_time ) < 1 ||
+                ( !Str::CompareCase( action, "on" ) && !Str::CompareCase( action, "off" ) && !Str::CompareCase( action, "dump" ) && !Str::CompareCase( action, "clear" ) ) )
+            {
+                logcb( "Invalid arguments. Example: <~profiler [on,off,dump,clear] [sample_interval_ms]>." );
+                break;
+            }
+            action[15] = 0;
+            msg_len += 16 + sizeof(sample_time);
+
+            buf << msg;
+            buf << msg_len;
+            buf << cmd;
+            buf.Push( action, 16 );
+            buf << sample_time;
+            break;
+        }
         default:
             break;
     }
@@ -148,12 +148,12 @@ uint ScriptString::lengthUTF8() const
 
 void ScriptString::AddRef() const
 {
-    refCount++;
+    asAtomicInc( refCount );
 }
 
 void ScriptString::Release() const
 {
-    if( --refCount == 0 )
+    if( asAtomicDec( refCount ) == 0 )
         delete this;
 }
 
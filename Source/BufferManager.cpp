@@ -514,8 +514,6 @@ bool BufferManager::NeedProcess()
             return NETMSG_SEND_COMBAT_SIZE + bufReadPos <= bufEndPos;
         case NETMSG_LOADMAP:
             return NETMSG_LOADMAP_SIZE + bufReadPos <= bufEndPos;
-        case NETMSG_SEND_GIVE_MAP:
-            return NETMSG_SEND_GIVE_MAP_SIZE + bufReadPos <= bufEndPos;
         case NETMSG_SEND_LOAD_MAP_OK:
             return NETMSG_SEND_LOAD_MAP_OK_SIZE + bufReadPos <= bufEndPos;
         case NETMSG_SHOW_SCREEN:
@@ -580,6 +578,7 @@ bool BufferManager::NeedProcess()
         case NETMSG_TALK_NPC:
         case NETMSG_SEND_BARTER:
         case NETMSG_MAP:
+        case NETMSG_SEND_GIVE_MAP:
         case NETMSG_RUN_CLIENT_SCRIPT:
         case NETMSG_SEND_RUN_SERVER_SCRIPT:
         case NETMSG_GLOBAL_INFO:
@@ -776,9 +775,6 @@ void BufferManager::SkipMsg( uint msg )
         case NETMSG_LOADMAP:
             size = NETMSG_LOADMAP_SIZE;
             break;
-        case NETMSG_SEND_GIVE_MAP:
-            size = NETMSG_SEND_GIVE_MAP_SIZE;
-            break;
         case NETMSG_SEND_LOAD_MAP_OK:
             size = NETMSG_SEND_LOAD_MAP_OK_SIZE;
             break;
@@ -844,6 +840,7 @@ void BufferManager::SkipMsg( uint msg )
         case NETMSG_TALK_NPC:
         case NETMSG_SEND_BARTER:
         case NETMSG_MAP:
+        case NETMSG_SEND_GIVE_MAP:
         case NETMSG_RUN_CLIENT_SCRIPT:
         case NETMSG_SEND_RUN_SERVER_SCRIPT:
         case NETMSG_GLOBAL_INFO:
@@ -55,7 +55,7 @@ FOClient::FOClient() : Active( false )
 {
     Self = this;
 
-    ComLen = 4096;
+    ComLen = NET_RECV_CHUNK;
     ComBuf = new char[ComLen];
     ZStreamOk = false;
     Sock = INVALID_SOCKET;
@@ -63,6 +63,7 @@ FOClient::FOClient() : Active( false )
     BytesRealReceive = 0;
     BytesSend = 0;
     IsConnected = false;
+    MapCacheResetPid = 0;
     InitNetReason = INIT_NET_REASON_NONE;
 
     Chosen = NULL;
@@ -2874,113 +2875,83 @@ bool FOClient::NetOutput()
 
 int FOClient::NetInput( bool unpack )
 {
-    timeval tv;
-    tv.tv_sec = 0;
-    tv.tv_usec = 0;
-    FD_ZERO( &SockSet );
-    FD_ZERO( &SockSetErr );
-    FD_SET( Sock, &SockSet );
-    FD_SET( Sock, &SockSetErr );
-    if( select( Sock + 1, &SockSet, NULL, &SockSetErr, &tv ) == SOCKET_ERROR )
-        WriteLogF( _FUNC_, " - Select error<%s>.\n", GetLastSocketError() );
-    if( FD_ISSET( Sock, &SockSetErr ) )
-        WriteLogF( _FUNC_, " - Socket error.\n" );
-    if( !FD_ISSET( Sock, &SockSet ) )
-        return 0;
-
-    #ifdef FO_WINDOWS
-    DWORD  len;
-    DWORD  flags = 0;
-    WSABUF buf;
-    buf.buf = ComBuf;
-    buf.len = ComLen;
-    if( WSARecv( Sock, &buf, 1, &len, &flags, NULL, NULL ) == SOCKET_ERROR )
-    #else
-    int len = recv( Sock, ComBuf, ComLen, 0 );
-    if( len < 0 )
-    #endif
-    {
-        WriteLogF( _FUNC_, " - Socket error while receive from server, error<%s>.\n", GetLastSocketError() );
-        return -1;
-    }
-    if( len == 0 )
-    {
-        WriteLogF( _FUNC_, " - Socket is closed.\n" );
-        return -2;
-    }
+    // Compact only when consumed part outweighs unread one, unprocessed burst is not moved every frame
+    if( Bin.GetCurPos() >= Bin.GetEndPos() - Bin.GetCurPos() )
+        Bin.Refresh();
+    uint old_pos = Bin.GetEndPos();     // Fix position
+    uint received = 0;
 
-    uint pos = len;
-    while( pos == ComLen )
+    // Read socket by chunks of ComBuf, each chunk goes to Bin right away
+    while( true )
     {
-        uint  newcomlen = (ComLen << 1);
-        char* combuf = new char[newcomlen];
-        memcpy( combuf, ComBuf, ComLen );
-        SAFEDELA( ComBuf );
-        ComBuf = combuf;
-        ComLen = newcomlen;
+        timeval tv;
+        tv.tv_sec = 0;
+        tv.tv_usec = 0;
+        FD_ZERO( &SockSet );
+        FD_ZERO( &SockSetErr );
+        FD_SET( Sock, &SockSet );
+        FD_SET( Sock, &SockSetErr );
+        if( select( Sock + 1, &SockSet, NULL, &SockSetErr, &tv ) == SOCKET_ERROR )
+            WriteLogF( _FUNC_, " - Select error<%s>.\n", GetLastSocketError() );
+        if( FD_ISSET( Sock, &SockSetErr ) )
+            WriteLogF( _FUNC_, " - Socket error.\n" );
+        if( !FD_ISSET( Sock, &SockSet ) )
+            break;
 
         #ifdef FO_WINDOWS
-        flags = 0;
-        buf.buf = ComBuf + pos;
-        buf.len = ComLen - pos;
+        DWORD  len;
+        DWORD  flags = 0;
+        WSABUF buf;
+        buf.buf = ComBuf;
+        buf.len = ComLen;
         if( WSARecv( Sock, &buf, 1, &len, &flags, NULL, NULL ) == SOCKET_ERROR )
         #else
-        int len = recv( Sock, ComBuf + pos, ComLen - pos, 0 );
+        int len = recv( Sock, ComBuf, ComLen, 0 );
         if( len < 0 )
         #endif
         {
-            WriteLogF( _FUNC_, " - Socket error (2) while receive from server, error<%s>.\n", GetLastSocketError() );
+            WriteLogF( _FUNC_, " - Socket error while receive from server, error<%s>.\n", GetLastSocketError() );
             return -1;
         }
         if( len == 0 )
         {
-            WriteLogF( _FUNC_, " - Socket is closed (2).\n" );
+            WriteLogF( _FUNC_, " - Socket is closed.\n" );
             return -2;
         }
+        received += (uint)len;
 
-        pos += len;
-    }
-
-    Bin.Refresh();
-    uint old_pos = Bin.GetEndPos();     // Fix position
-
-    if( unpack && !GameOpt.DisableZlibCompression )
-    {
-        ZStream.next_in = (uchar*)ComBuf;
-        ZStream.avail_in = pos;
-        ZStream.next_out = (uchar*)Bin.GetData() + Bin.GetEndPos();
-        ZStream.avail_out = Bin.GetLen() - Bin.GetEndPos();
-
-        if( inflate( &ZStream, Z_SYNC_FLUSH ) != Z_OK )
+        if( unpack && !GameOpt.DisableZlibCompression )
         {
-            WriteLogF( _FUNC_, " - ZStream Inflate error.\n" );
-            return -3;
-        }
+            // Inflate straight to the end of Bin, grow it only when output space is over
+            ZStream.next_in = (uchar*)ComBuf;
+            ZStream.avail_in = (uint)len;
+            while( ZStream.avail_in )
+            {
+                Bin.GrowBuf( (uint)len );
 
-        Bin.SetEndPos( (uint)( (size_t)ZStream.next_out - (size_t)Bin.GetData() ) );
+                ZStream.next_out = (uchar*)Bin.GetData() + Bin.GetEndPos();
+                ZStream.avail_out = Bin.GetLen() - Bin.GetEndPos();
 
-        while( ZStream.avail_in )
-        {
-            Bin.GrowBuf( 2048 );
-
-            ZStream.next_out = (uchar*)Bin.GetData() + Bin.GetEndPos();
-            ZStream.avail_out = Bin.GetLen() - Bin.GetEndPos();
+                if( inflate( &ZStream, Z_SYNC_FLUSH ) != Z_OK )
+                {
+                    WriteLogF( _FUNC_, " - ZStream Inflate error.\n" );
+                    return -3;
+                }
 
-            if( inflate( &ZStream, Z_SYNC_FLUSH ) != Z_OK )
-            {
-                WriteLogF( _FUNC_, " - ZStream Inflate continue error.\n" );
-                return -4;
+                Bin.SetEndPos( (uint)( (size_t)ZStream.next_out - (size_t)Bin.GetData() ) );
             }
-
-            Bin.SetEndPos( (uint)( (size_t)ZStream.next_out - (size_t)Bin.GetData() ) );
         }
-    }
-    else
-    {
-        Bin.Push( ComBuf, pos, true );
+        else
+        {
+            Bin.Push( ComBuf, (uint)len, true );
+        }
+
+        // Partially filled chunk means socket is drained
+        if( (uint)len < ComLen )
+            break;
     }
 
-    BytesReceive += pos;
+    BytesReceive += received;
     BytesRealReceive += Bin.GetEndPos() - old_pos;
     return Bin.GetEndPos() - old_pos;
 }
@@ -3027,8 +2998,13 @@ void FOClient::NetProcess()
         return;
     }
 
+    // Rest of big burst is processed on next frames
+    uint tick = Timer::FastTick();
     while( Bin.NeedProcess() )
     {
+        if( Timer::FastTick() - tick >= NET_PROCESS_TIME )
+            break;
+
         uint msg = 0;
         Bin >> msg;
 
@@ -3667,15 +3643,20 @@ void FOClient::Net_SendGetGameInfo()
     Bout << NETMSG_SEND_GET_INFO;
 }
 
-void FOClient::Net_SendGiveMap( bool automap, ushort map_pid, uint loc_id, uint tiles_hash, uint walls_hash, uint scen_hash )
+void FOClient::Net_SendGiveMap( bool automap, ushort map_pid, uint loc_id, const UIntVec& region_hashes )
 {
-    Bout << NETMSG_SEND_GIVE_MAP;
+    uint   msg = NETMSG_SEND_GIVE_MAP;
+    ushort regions_count = (ushort)region_hashes.size();
+    uint   msg_len = sizeof(msg) + sizeof(msg_len) + sizeof(automap) + sizeof(map_pid) + sizeof(loc_id) + sizeof(regions_count) + regions_count * sizeof(uint);
+
+    Bout << msg;
+    Bout << msg_len;
     Bout << automap;
     Bout << map_pid;
     Bout << loc_id;
-    Bout << tiles_hash;
-    Bout << walls_hash;
-    Bout << scen_hash;
+    Bout << regions_count;
+    for( ushort i = 0; i < regions_count; i++ )
+        Bout << region_hashes[i];
 }
 
 void FOClient::Net_SendLoadMapOk()
@@ -5705,15 +5686,11 @@ void FOClient::Net_OnLoadMap()
     ushort map_pid;
     int    map_time;
     uchar  map_rain;
-    uint   hash_tiles;
-    uint   hash_walls;
-    uint   hash_scen;
+    uint   hash_regions;
     Bin >> map_pid;
     Bin >> map_time;
     Bin >> map_rain;
-    Bin >> hash_tiles;
-    Bin >> hash_walls;
-    Bin >> hash_scen;
+    Bin >> hash_regions;
 
     GameOpt.SpritesZoom = 1.0f;
     WorldmapZoom = 1.0f;
@@ -5758,23 +5735,34 @@ void FOClient::Net_OnLoadMap()
     }
 
     // Local
-    uint hash_tiles_cl = 0;
-    uint hash_walls_cl = 0;
-    uint hash_scen_cl = 0;
-    HexMngr.GetMapHash( map_pid, hash_tiles_cl, hash_walls_cl, hash_scen_cl );
+    ushort  maxhx, maxhy;
+    uint    hash_regions_cl = 0;
+    UIntVec region_hashes;
+    HexMngr.GetMapRegions( map_pid, maxhx, maxhy, hash_regions_cl, region_hashes );
 
-    if( hash_tiles != hash_tiles_cl || hash_walls != hash_walls_cl || hash_scen != hash_scen_cl )
+    if( hash_regions != hash_regions_cl )
     {
-        Net_SendGiveMap( false, map_pid, 0, hash_tiles_cl, hash_walls_cl, hash_scen_cl );
+        Net_SendGiveMap( false, map_pid, 0, region_hashes );
         return;
     }
 
     if( !HexMngr.LoadMap( map_pid ) )
     {
+        // Missing or broken region in cache, drop it and download whole map once
+        if( MapCacheResetPid != map_pid )
+        {
+            WriteLog( "Map not loaded, request all regions.\n" );
+            MapCacheResetPid = map_pid;
+            HexMngr.SetMapRegions( map_pid, 0, 0, 0, MapRegionCacheVec() );
+            Net_SendGiveMap( false, map_pid, 0, UIntVec() );
+            return;
+        }
+
         WriteLog( "Map not loaded. Disconnect.\n" );
         IsConnected = false;
         return;
     }
+    MapCacheResetPid = 0;
 
     HexMngr.SetWeather( map_time, map_rain );
     SetDayTime( true );
@@ -5799,192 +5787,102 @@ void FOClient::Net_OnMap()
     uint   msg_len;
     ushort map_pid;
     ushort maxhx, maxhy;
-    uchar  send_info;
+    uint   hash_regions;
+    ushort regions_count;
+    ushort send_count;
     Bin >> msg_len;
     Bin >> map_pid;
     Bin >> maxhx;
     Bin >> maxhy;
-    Bin >> send_info;
-
-    WriteLogX( "<%u>... ", map_pid );
+    Bin >> hash_regions;
+    Bin >> regions_count;
+    Bin >> send_count;
+    CHECK_IN_BUFF_ERROR;
 
-    char map_name[256];
-    Str::Format( map_name, "map%u", map_pid );
+    WriteLogX( "<%u>, regions %u of %u... ", map_pid, send_count, regions_count );
 
-    bool  tiles = false;
-    char* tiles_data = NULL;
-    uint  tiles_len = 0;
-    bool  walls = false;
-    char* walls_data = NULL;
-    uint  walls_len = 0;
-    bool  scen = false;
-    char* scen_data = NULL;
-    uint  scen_len = 0;
+    // Cached regions, unchanged ones are kept
+    ushort            old_maxhx, old_maxhy;
+    uint              old_hash_regions;
+    MapRegionCacheVec regions;
+    if( !HexMngr.GetMapRegions( map_pid, old_maxhx, old_maxhy, old_hash_regions, regions ) ||
+        regions.size() != regions_count || old_maxhx != maxhx || old_maxhy != maxhy )
+        regions.clear();
+    regions.resize( regions_count );
 
-    WriteLogX( "New:" );
-    if( FLAG( send_info, SENDMAP_TILES ) )
+    // Changed regions
+    for( ushort i = 0; i < send_count; i++ )
     {
-        WriteLogX( " Tiles" );
-        uint count_tiles;
-        Bin >> count_tiles;
-        if( count_tiles )
-        {
-            tiles_len = count_tiles * sizeof(ProtoMap::Tile);
-            tiles_data = new char[tiles_len];
-            Bin.Pop( tiles_data, tiles_len );
-        }
-        tiles = true;
-    }
+        ushort region;
+        uint   hash;
+        uint   tiles_count, walls_count, scen_count;
 
-    if( FLAG( send_info, SENDMAP_WALLS ) )
-    {
-        WriteLogX( " Walls" );
-        uint count_walls = 0;
-        Bin >> count_walls;
-        if( count_walls )
+        Bin >> region;
+        Bin >> hash;
+        Bin >> tiles_count;
+        if( region >= regions_count || tiles_count > msg_len / sizeof(ProtoMap::Tile) )
         {
-            walls_len = count_walls * sizeof(SceneryCl);
-            walls_data = new char[walls_len];
-            Bin.Pop( walls_data, walls_len );
+            WriteLog( "Invalid region data, disconnect.\n" );
+            IsConnected = false;
+            return;
         }
-        walls = true;
-    }
+        UCharVec& data = regions[region].Data;
+        uint      tiles_len = tiles_count * sizeof(ProtoMap::Tile);
+        data.resize( tiles_len );
+        if( tiles_len )
+            Bin.Pop( (char*)&data[0], tiles_len );
 
-    if( FLAG( send_info, SENDMAP_SCENERY ) )
-    {
-        WriteLogX( " Scenery" );
-        uint count_scen = 0;
-        Bin >> count_scen;
-        if( count_scen )
+        Bin >> walls_count;
+        if( walls_count > msg_len / sizeof(SceneryCl) )
         {
-            scen_len = count_scen * sizeof(SceneryCl);
-            scen_data = new char[scen_len];
-            Bin.Pop( scen_data, scen_len );
+            WriteLog( "Invalid region data, disconnect.\n" );
+            IsConnected = false;
+            return;
         }
-        scen = true;
-    }
-
-    CHECK_IN_BUFF_ERROR;
-
-    uint        cache_len;
-    uchar*      cache = Crypt.GetCache( map_name, cache_len );
-    FileManager fm;
+        uint walls_len = walls_count * sizeof(SceneryCl);
+        data.resize( tiles_len + walls_len );
+        if( walls_len )
+            Bin.Pop( (char*)&data[tiles_len], walls_len );
 
-    WriteLogX( " Old:" );
-    if( cache && fm.LoadStream( cache, cache_len ) )
-    {
-        uint   buf_len = fm.GetFsize();
-        uchar* buf = Crypt.Uncompress( fm.GetBuf(), buf_len, 50 );
-        if( buf )
+        Bin >> scen_count;
+        if( scen_count > msg_len / sizeof(SceneryCl) )
         {
-            fm.UnloadFile();
-            fm.LoadStream( buf, buf_len );
-            delete[] buf;
-
-            if( fm.GetBEUInt() == CLIENT_MAP_FORMAT_VER )
-            {
-                fm.SetCurPos( 0x04 );           // Skip pid
-                fm.GetBEUInt();                 // Skip max hx/hy
-                fm.GetBEUInt();                 // Reserved
-                fm.GetBEUInt();                 // Reserved
-
-                fm.SetCurPos( 0x20 );
-                uint old_tiles_len = fm.GetBEUInt();
-                uint old_walls_len = fm.GetBEUInt();
-                uint old_scen_len = fm.GetBEUInt();
-
-                if( !tiles )
-                {
-                    WriteLogX( " Tiles" );
-                    tiles_len = old_tiles_len;
-                    fm.SetCurPos( 0x2C );
-                    tiles_data = new char[tiles_len];
-                    fm.CopyMem( tiles_data, tiles_len );
-                    tiles = true;
-                }
-
-                if( !walls )
-                {
-                    WriteLogX( " Walls" );
-                    walls_len = old_walls_len;
-                    fm.SetCurPos( 0x2C + old_tiles_len );
-                    walls_data = new char[walls_len];
-                    fm.CopyMem( walls_data, walls_len );
-                    walls = true;
-                }
+            WriteLog( "Invalid region data, disconnect.\n" );
+            IsConnected = false;
+            return;
+        }
+        uint scen_len = scen_count * sizeof(SceneryCl);
+        data.resize( tiles_len + walls_len + scen_len );
+        if( scen_len )
+            Bin.Pop( (char*)&data[tiles_len + walls_len], scen_len );
 
-                if( !scen )
-                {
-                    WriteLogX( " Scenery" );
-                    scen_len = old_scen_len;
-                    fm.SetCurPos( 0x2C + old_tiles_len + old_walls_len );
-                    scen_data = new char[scen_len];
-                    fm.CopyMem( scen_data, scen_len );
-                    scen = true;
-                }
+        CHECK_IN_BUFF_ERROR;
 
-                fm.UnloadFile();
-            }
-        }
+        regions[region].Hash = hash;
+        regions[region].TilesCount = tiles_count;
+        regions[region].WallsCount = walls_count;
+        regions[region].ScenCount = scen_count;
     }
-    SAFEDELA( cache );
 
-    if( tiles && walls && scen )
+    // Region hashes are never zero
+    for( ushort r = 0; r < regions_count; r++ )
     {
-        fm.ClearOutBuf();
-
-        fm.SetBEUInt( CLIENT_MAP_FORMAT_VER );
-        fm.SetBEUInt( map_pid );
-        fm.SetBEUShort( maxhx );
-        fm.SetBEUShort( maxhy );
-        fm.SetBEUInt( 0 );
-        fm.SetBEUInt( 0 );
-
-        fm.SetBEUInt( tiles_len / sizeof(ProtoMap::Tile) );
-        fm.SetBEUInt( walls_len / sizeof(SceneryCl) );
-        fm.SetBEUInt( scen_len / sizeof(SceneryCl) );
-        fm.SetBEUInt( tiles_len );
-        fm.SetBEUInt( walls_len );
-        fm.SetBEUInt( scen_len );
-
-        if( tiles_len )
-            fm.SetData( tiles_data, tiles_len );
-        if( walls_len )
-            fm.SetData( walls_data, walls_len );
-        if( scen_len )
-            fm.SetData( scen_data, scen_len );
-
-        uint   obuf_len = fm.GetOutBufLen();
-        uchar* buf = Crypt.Compress( fm.GetOutBuf(), obuf_len );
-        if( !buf )
+        if( !regions[r].Hash )
         {
-            WriteLog( "Failed to compress data<%s>, disconnect.\n", map_name );
+            WriteLog( "Not for all data of map, disconnect.\n" );
             IsConnected = false;
-            fm.ClearOutBuf();
             return;
         }
-
-        fm.ClearOutBuf();
-        fm.SetData( buf, obuf_len );
-        delete[] buf;
-
-        Crypt.SetCache( map_name, fm.GetOutBuf(), fm.GetOutBufLen() );
-        fm.ClearOutBuf();
     }
-    else
+
+    // Whole map goes to one cache entry
+    if( !HexMngr.SetMapRegions( map_pid, maxhx, maxhy, hash_regions, regions ) )
     {
-        WriteLog( "Not for all data of map, disconnect.\n" );
+        WriteLog( "Failed to save map<%u>, disconnect.\n", map_pid );
         IsConnected = false;
-        SAFEDELA( tiles_data );
-        SAFEDELA( walls_data );
-        SAFEDELA( scen_data );
         return;
     }
 
-    SAFEDELA( tiles_data );
-    SAFEDELA( walls_data );
-    SAFEDELA( scen_data );
-
     AutomapWaitPids.erase( map_pid );
     AutomapReceivedPids.insert( map_pid );
 
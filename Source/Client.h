@@ -69,6 +69,9 @@ public:
     void ParseKeyboard();
     void ParseMouse();
 
+    #define NET_RECV_CHUNK      (0x10000) // Size of reusable receive buffer
+    #define NET_PROCESS_TIME    (10)      // Time budget for incoming messages per frame, ms
+
     char*         ComBuf;
     uint          ComLen;
     BufferManager Bin;
@@ -83,6 +86,7 @@ public:
     bool          UIDFail;
     Item          SomeItem;
     bool          IsConnected;
+    ushort        MapCacheResetPid; // Map which cache was dropped because of load failure
     bool          InitNetBegin;
     int           InitNetReason;
 
@@ -113,7 +117,7 @@ public:
     void Net_SendGetGameInfo();
     void Net_SendGiveGlobalInfo( uchar info_flags );
     void Net_SendRuleGlobal( uchar command, uint param1 = 0, uint param2 = 0 );
-    void Net_SendGiveMap( bool automap, ushort map_pid, uint loc_id, uint tiles_hash, uint walls_hash, uint scen_hash );
+    void Net_SendGiveMap( bool automap, ushort map_pid, uint loc_id, const UIntVec& region_hashes );
     void Net_SendLoadMapOk();
     void Net_SendCommand( char* str );
     void Net_SendText( const char* send_str, uchar how_say );
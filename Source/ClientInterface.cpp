@@ -8662,7 +8662,7 @@ void FOClient::PipDraw()
                     break;
                 }
 
-                Net_SendGiveMap( true, map_pid, AutomapSelected.LocId, 0, 0, 0 );
+                Net_SendGiveMap( true, map_pid, AutomapSelected.LocId, UIntVec() );
                 AutomapWaitPids.insert( map_pid );
                 break;
             }
@@ -11403,7 +11403,8 @@ void FOClient::SaveLoadCollect()
     // For each all saves in folder
     StrVec fnames;
     FileManager::GetFolderFileNames( FileManager::GetPath( PATH_SAVE ), true, "fo", fnames );
-    PtrVec open_handles;
+    PtrVec         open_handles;
+    list<UCharVec> unpacked_heads;
     for( uint i = 0; i < fnames.size(); i++ )
     {
         const string& fname = fnames[i];
@@ -11422,20 +11423,41 @@ void FOClient::SaveLoadCollect()
         if( !FileRead( f, signature, sizeof(signature) ) )
             continue;
 
+        ushort version = BINARY_SIGNATURE_VERSION( signature );
         if( memcmp( WorldSaveSignature, signature, sizeof(WorldSaveSignature) ) != 0 )
         {
             if( !BINARY_SIGNATURE_VALID( WorldSaveSignature, signature ) )
                 continue;
 
-            uchar version = BINARY_SIGNATURE_VERSION( signature );
             if( !version || version < WORLD_SAVE_V1 || version > WORLD_SAVE_LAST )
                 continue;
         }
 
+        // Game info is second packed section, see FOServer::SaveWorld
+        uint base = sizeof(signature);
+        if( version >= WORLD_SAVE_V2 )
+        {
+            uint sizes[2];
+            if( !FileRead( f, sizes, sizeof(sizes) ) || !FileSetPointer( f, sizes[1], SEEK_CUR ) || !FileRead( f, sizes, sizeof(sizes) ) || !sizes[0] )
+                continue;
+
+            UCharVec packed( sizes[1] );
+            unpacked_heads.push_back( UCharVec( sizes[0] ) );
+            UCharVec& head = unpacked_heads.back();
+            uLongf    head_size = sizes[0];
+            if( packed.empty() || !FileRead( f, &packed[0], sizes[1] ) ||
+                uncompress( &head[0], &head_size, &packed[0], sizes[1] ) != Z_OK )
+                continue;
+
+            f = FileOpenMemory( &head[0], (uint)head_size );
+            open_handles.push_back( f );
+            base = 0;
+        }
+
         // Read save data, offsets see SaveGameInfoFile in Server.cpp
         #pragma TODO("FULL REWRITE")
-        uint pos1 = 6;
-        uint pos2 = 10;
+        uint pos1 = base;
+        uint pos2 = base + 4;
 
         // Check singleplayer data
         uint sp;
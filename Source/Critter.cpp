@@ -6,6 +6,7 @@
 #include "CritterType.h"
 #include "Exception.h"
 #include "ItemManager.h"
+#include "Jobs.h"
 #include "Log.h"
 #include "MapManager.h"
 #include "MsgStr.h"
@@ -92,12 +93,14 @@ Item*     Critter::SlotEnabledCacheDataExt[0x100] = { 0 };
 
 Critter::Critter() : CritterIsNpc( false ), RefCounter( 1 ), IsNotValid( false ),
     GroupMove( NULL ), PrevHexTick( 0 ), PrevHexX( 0 ), PrevHexY( 0 ),
+    GridCell( MAP_CRITTERS_GRID_NONE ), GridHexX( 0 ), GridHexY( 0 ), GridVisRadius( 0 ), GlobalGridCell( -1 ),
     startBreakTime( 0 ), breakTime( 0 ), waitEndTick( 0 ), KnockoutAp( 0 ), CacheValuesNextTick( 0 ), IntellectCacheValue( 0 ),
     Flags( 0 ), AccessContainerId( 0 ), ItemTransferCount( 0 ),
     TryingGoHomeTick( 0 ), ApRegenerationTick( 0 ), GlobalIdleNextTick( 0 ), LockMapTransfers( 0 ),
     ViewMapId( 0 ), ViewMapPid( 0 ), ViewMapLook( 0 ), ViewMapHx( 0 ), ViewMapHy( 0 ), ViewMapDir( 0 ),
-    DisableSend( 0 ), CanBeRemoved( false )
+    DisableSend( 0 ), IsSaveChanged( true ), SaveCrc( 0 ), CanBeRemoved( false )
 {
+    Sync.SetType( SYNC_OBJECT_CRITTER );
     memzero( &Data, sizeof(Data) );
     DataExt = NULL;
     memzero( FuncId, sizeof(FuncId) );
@@ -126,6 +129,7 @@ Critter::~Critter()
 
 CritDataExt* Critter::GetDataExt()
 {
+    IsSaveChanged = true;
     if( !DataExt )
     {
         DataExt = new CritDataExt();
@@ -177,7 +181,10 @@ void Critter::SetBreakTimeDelta( uint ms )
 
 void Critter::SetWait( uint ms )
 {
-    waitEndTick = Timer::GameTick() + ms;
+    uint wait_end_tick = Timer::GameTick() + ms;
+    if( IsNpc() && wait_end_tick < waitEndTick )
+        Job::Wake( this );
+    waitEndTick = wait_end_tick;
 }
 
 bool Critter::IsWait()
@@ -185,6 +192,47 @@ bool Critter::IsWait()
     return Timer::GameTick() < waitEndTick;
 }
 
+uint Critter::GetNextProcessTick()
+{
+    // Players, global map group leaders, turn based battles and pending changes
+    if( IsPlayer() || IsNotValid || CanBeRemoved || IsKnockout() || IsTurnBased() || ParamsChanged.size() )
+        return 0;
+    if( !GetMap() && GroupMove && GroupMove->Rule == this )
+        return 0;
+
+    uint tick = Timer::GameTick();
+    uint next_tick = GlobalIdleNextTick;
+
+    // Moving, attacking, waiting
+    if( IsBusy() )
+        next_tick = MIN( next_tick, startBreakTime + breakTime );
+    if( IsLife() )
+    {
+        Npc* npc = (Npc*)this;
+        if( !IsWait() && !IsBusy() )
+            return 0;
+        if( npc->IsNeedRefreshBag() )
+            return 0;
+        next_tick = MIN( next_tick, waitEndTick );
+    }
+
+    // Action points regeneration
+    if( GetRealAp() < GetParam( ST_ACTION_POINTS ) * AP_DIVIDER )
+        next_tick = MIN( next_tick, (ApRegenerationTick ? ApRegenerationTick : tick) + 500 );
+
+    // Time events
+    if( !CrTimeEvents.empty() )
+    {
+        uint next_time = CrTimeEvents[0].NextTime;
+        if( !next_time || GameOpt.FullSecond >= next_time )
+            return 0;
+        uint delta = (next_time - GameOpt.FullSecond) * 1000 / MAX( GameOpt.TimeMultiplier, 1 );
+        next_tick = MIN( next_tick, tick + delta );
+    }
+
+    return next_tick > tick ? next_tick : 0;
+}
+
 void Critter::FullClear()
 {
     IsNotValid = true;
@@ -205,6 +253,18 @@ int Critter::GetLook()
     return look;
 }
 
+uint Critter::GetGridVisRadius( int look )
+{
+    uint radius = look;
+    if( (FuncId[CRITTER_EVENT_SHOW_CRITTER_1] > 0 || FuncId[CRITTER_EVENT_HIDE_CRITTER_1] > 0) && Data.ShowCritterDist1 > 0 )
+        radius = MAX( radius, Data.ShowCritterDist1 );
+    if( (FuncId[CRITTER_EVENT_SHOW_CRITTER_2] > 0 || FuncId[CRITTER_EVENT_HIDE_CRITTER_2] > 0) && Data.ShowCritterDist2 > 0 )
+        radius = MAX( radius, Data.ShowCritterDist2 );
+    if( (FuncId[CRITTER_EVENT_SHOW_CRITTER_3] > 0 || FuncId[CRITTER_EVENT_HIDE_CRITTER_3] > 0) && Data.ShowCritterDist3 > 0 )
+        radius = MAX( radius, Data.ShowCritterDist3 );
+    return radius;
+}
+
 uint Critter::GetTalkDistance( Critter* talker )
 {
     int dist = Data.Params[ST_TALK_DISTANCE];
@@ -399,12 +459,37 @@ void Critter::ProcessVisibleCritters()
         return;
 
     CrVec critters;
-    map->GetCritters( critters, true );
+    if( FLAG( GameOpt.LookChecks, LOOK_CHECK_SCRIPT ) )
+    {
+        // Script may allow any distance
+        map->GetCritters( critters, true );
+    }
+    else
+    {
+        // Only critters near previous and current position may change visibility
+        uint radius = GetGridVisRadius( look_base_self );
+        ushort prev_hx = GridHexX;
+        ushort prev_hy = GridHexY;
+        map->SetCritterGrid( this, radius );
+
+        radius = map->GetCrittersGridVisRadius();
+        map->GetCrittersGrid( GetHexX(), GetHexY(), radius, critters, false );
+        if( prev_hx != GetHexX() || prev_hy != GetHexY() )
+            map->GetCrittersGrid( prev_hx, prev_hy, radius, critters, false );
+        critters.insert( critters.end(), VisCr.begin(), VisCr.end() );
+        critters.insert( critters.end(), VisCrSelf.begin(), VisCrSelf.end() );
+        std::sort( critters.begin(), critters.end() );
+        critters.erase( std::unique( critters.begin(), critters.end() ), critters.end() );
+
+        if( LogicMT )
+            for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
+                SYNC_LOCK( *it );
+    }
 
     for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
     {
         Critter* cr = *it;
-        if( cr == this || cr->IsNotValid )
+        if( cr == this || cr->IsNotValid || cr->GetMap() != map->GetId() )
             continue;
 
         int dist = DistGame( GetHexX(), GetHexY(), cr->GetHexX(), cr->GetHexY() );
@@ -1219,6 +1304,7 @@ void Critter::SetItem( Item* item )
         GroupMove->CarId = item->GetId();
     invItems.push_back( item );
     item->AccCritter.Id = GetId();
+    item->IsSaveChanged = true;
 
     if( item->Accessory != ITEM_ACCESSORY_CRITTER )
     {
@@ -1279,6 +1365,7 @@ void Critter::EraseItem( Item* item, bool send )
     }
 
     item->Accessory = 0xd0;
+    item->IsSaveChanged = true;
     TakeDefaultItem( item->AccCritter.Slot );
     if( send )
         Send_EraseItem( item );
@@ -1664,8 +1751,12 @@ bool Critter::MoveItem( uchar from_slot, uchar to_slot, uint item_id, uint count
     }
 
     item->AccCritter.Slot = to_slot;
+    item->IsSaveChanged = true;
     if( item_swap )
+    {
         item_swap->AccCritter.Slot = from_slot;
+        item_swap->IsSaveChanged = true;
+    }
 
     SendAA_MoveItem( item, CRITTER_ACTION_MOVE_ITEM, from_slot );
     item->EventMove( this, from_slot );
@@ -1720,6 +1811,9 @@ bool Critter::IsHaveGeckItem()
 void Critter::ToKnockout( uint anim2begin, uint anim2idle, uint anim2end, uint lost_ap, ushort knock_hx, ushort knock_hy )
 {
     Data.Cond = CRITTER_CONDITION_KNOCKOUT;
+    IsSaveChanged = true;
+    if( IsNpc() )
+        Job::Wake( this );
     Data.Anim2Knockout = anim2idle;
     Data.Anim2KnockoutEnd = anim2end;
     KnockoutAp = lost_ap;
@@ -1752,6 +1846,7 @@ void Critter::TryUpOnKnockout()
 
     // Stand up
     Data.Cond = CRITTER_CONDITION_LIFE;
+    IsSaveChanged = true;
     SendAA_Action( CRITTER_ACTION_STANDUP, Data.Anim2KnockoutEnd, NULL );
     SetBreakTime( GameOpt.Breaktime );
 }
@@ -1763,6 +1858,7 @@ void Critter::ToDead( uint anim2, bool send_all )
     if( GetParam( ST_CURRENT_HP ) > 0 )
         Data.Params[ST_CURRENT_HP] = 0;
     Data.Cond = CRITTER_CONDITION_DEAD;
+    IsSaveChanged = true;
     Data.Anim2Dead = anim2;
 
     Item* item = ItemSlotMain;
@@ -1803,6 +1899,7 @@ bool Critter::ParseScript( const char* script, bool first_time )
             return false;
         }
         Data.ScriptId = func_num;
+        IsSaveChanged = true;
     }
 
     if( Data.ScriptId && Script::PrepareContext( Script::GetScriptFuncBindId( Data.ScriptId ), _FUNC_, GetInfo() ) )
@@ -2707,33 +2804,65 @@ void Critter::Send_CritterLexems( Critter* cr )
     if( IsPlayer() )
         ( (Client*)this )->Send_CritterLexems( cr );
 }
+void Critter::Send_Broadcast( BufferManager& msg )
+{
+    if( IsPlayer() )
+        ( (Client*)this )->Send_Broadcast( msg );
+}
 
-void Critter::SendA_Move( uint move_params )
+// Messages for all visible players serialized once per thread buffer
+static THREAD BufferManager* BroadcastBuf = NULL;
+static BufferManager& BeginBroadcast()
 {
-    if( VisCr.empty() )
-        return;
-    // SyncLockCritters(true);
+    if( !BroadcastBuf )
+        BroadcastBuf = new BufferManager();
+    BroadcastBuf->Reset();
+    return *BroadcastBuf;
+}
 
+static void BroadcastXY( BufferManager& msg, Critter* cr )
+{
+    msg << NETMSG_CRITTER_XY;
+    msg << cr->GetId();
+    msg << cr->GetHexX();
+    msg << cr->GetHexY();
+    msg << cr->GetDir();
+}
+
+void Critter::SendA_Broadcast( BufferManager& msg )
+{
     for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
     {
         Critter* cr = *it;
         if( cr->IsPlayer() )
-            cr->Send_Move( this, move_params );
+            cr->Send_Broadcast( msg );
     }
 }
 
+void Critter::SendA_Move( uint move_params )
+{
+    if( VisCr.empty() )
+        return;
+    // SyncLockCritters(true);
+
+    BufferManager& msg = BeginBroadcast();
+    msg << NETMSG_CRITTER_MOVE;
+    msg << GetId();
+    msg << move_params;
+    msg << GetHexX();
+    msg << GetHexY();
+    SendA_Broadcast( msg );
+}
+
 void Critter::SendA_XY()
 {
     if( VisCr.empty() )
         return;
     // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_XY( this );
-    }
+    BufferManager& msg = BeginBroadcast();
+    BroadcastXY( msg, this );
+    SendA_Broadcast( msg );
 }
 
 void Critter::SendA_Action( int action, int action_ext, Item* item )
@@ -2742,12 +2871,22 @@ void Critter::SendA_Action( int action, int action_ext, Item* item )
         return;
     // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
+    BufferManager& msg = BeginBroadcast();
+    BroadcastXY( msg, this );
+    if( item )
     {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Action( this, action, action_ext, item );
+        msg << NETMSG_SOME_ITEM;
+        msg << item->GetId();
+        msg << item->GetProtoId();
+        msg << item->AccCritter.Slot;
+        msg.Push( (char*)&item->Data, Item::ItemData::SendMask[ITEM_DATA_MASK_CRITTER], sizeof(item->Data) );
     }
+    msg << NETMSG_CRITTER_ACTION;
+    msg << GetId();
+    msg << action;
+    msg << action_ext;
+    msg << (bool)(item ? true : false);
+    SendA_Broadcast( msg );
 }
 
 void Critter::SendAA_Action( int action, int action_ext, Item* item )
@@ -2773,12 +2912,15 @@ void Critter::SendA_Knockout( uint anim2begin, uint anim2idle, ushort knock_hx,
         return;
     // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Knockout( this, anim2begin, anim2idle, knock_hx, knock_hy );
-    }
+    BufferManager& msg = BeginBroadcast();
+    BroadcastXY( msg, this );
+    msg << NETMSG_CRITTER_KNOCKOUT;
+    msg << GetId();
+    msg << anim2begin;
+    msg << anim2idle;
+    msg << knock_hx;
+    msg << knock_hy;
+    SendA_Broadcast( msg );
 }
 
 void Critter::SendAA_MoveItem( Item* item, uchar action, uchar prev_slot )
@@ -3005,12 +3147,11 @@ void Critter::SendA_Dir()
         return;
     // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_Dir( this );
-    }
+    BufferManager& msg = BeginBroadcast();
+    msg << NETMSG_CRITTER_DIR;
+    msg << GetId();
+    msg << GetDir();
+    SendA_Broadcast( msg );
 }
 
 void Critter::SendA_Follow( uchar follow_type, ushort map_pid, uint follow_wait )
@@ -3041,12 +3182,12 @@ void Critter::SendA_ParamOther( ushort num_param, int val )
         return;
     // SyncLockCritters(true);
 
-    for( auto it = VisCr.begin(), end = VisCr.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->IsPlayer() )
-            cr->Send_CritterParam( this, num_param, val );
-    }
+    BufferManager& msg = BeginBroadcast();
+    msg << NETMSG_CRITTER_PARAM;
+    msg << GetId();
+    msg << num_param;
+    msg << val;
+    SendA_Broadcast( msg );
 }
 
 void Critter::SendA_ParamCheck( ushort num_param )
@@ -3211,8 +3352,11 @@ int Critter::GetParam( uint index )
 
 void Critter::ChangeParam( uint index )
 {
+    IsSaveChanged = true;
     if( !ParamsIsChanged[index] && ParamLocked != (int)index )
     {
+        if( ParamsChanged.empty() && IsNpc() )
+            Job::Wake( this );
         ParamsChanged.push_back( index );
         ParamsChanged.push_back( Data.Params[index] );
         ParamsIsChanged[index] = true;
@@ -3273,6 +3417,11 @@ void Critter::ProcessChangedParams()
                     SendA_ParamCheck( index );
             }
         }
+
+        // Look may be changed, other critters visibility queries rely on it
+        Map* map = MapMngr.GetMap( GetMap(), false );
+        if( map )
+            map->SetCritterGridVisRadius( this, GetGridVisRadius( GetLook() ) );
     }
 }
 
@@ -3534,6 +3683,10 @@ void Critter::AddCrTimeEvent( uint func_num, uint rate, uint duration, int ident
     cte.NextTime = duration;
     cte.Identifier = identifier;
     CrTimeEvents.insert( it, cte );
+    IsSaveChanged = true;
+
+    if( IsNpc() )
+        Job::Wake( this );
 }
 
 void Critter::EraseCrTimeEvent( int index )
@@ -3541,6 +3694,7 @@ void Critter::EraseCrTimeEvent( int index )
     if( index >= (int)CrTimeEvents.size() )
         return;
     CrTimeEvents.erase( CrTimeEvents.begin() + index );
+    IsSaveChanged = true;
 }
 
 void Critter::ContinueTimeEvents( int offs_time )
@@ -3551,6 +3705,10 @@ void Critter::ContinueTimeEvents( int offs_time )
         if( cte.NextTime )
             cte.NextTime += offs_time;
     }
+    IsSaveChanged = true;
+
+    if( IsNpc() )
+        Job::Wake( this );
 }
 
 void Critter::Delete()
@@ -3828,9 +3986,7 @@ void Client::Send_LoadMap( Map* map )
     ushort pid_map = 0;
     int    map_time = -1;
     uchar  map_rain = 0;
-    uint   hash_tiles = 0;
-    uint   hash_walls = 0;
-    uint   hash_scen = 0;
+    uint   hash_regions = 0;
 
     if( !map )
         map = MapMngr.GetMap( GetMap(), false );
@@ -3839,9 +3995,7 @@ void Client::Send_LoadMap( Map* map )
         pid_map = map->GetPid();
         map_time = map->GetTime();
         map_rain = map->GetRain();
-        hash_tiles = map->Proto->HashTiles;
-        hash_walls = map->Proto->HashWalls;
-        hash_scen = map->Proto->HashScen;
+        hash_regions = map->Proto->HashRegions;
     }
 
     BOUT_BEGIN( this );
@@ -3849,9 +4003,7 @@ void Client::Send_LoadMap( Map* map )
     Bout << pid_map;
     Bout << map_time;
     Bout << map_rain;
-    Bout << hash_tiles;
-    Bout << hash_walls;
-    Bout << hash_scen;
+    Bout << hash_regions;
     BOUT_END( this );
 
     GameState = STATE_TRANSFERRING;
@@ -4370,6 +4522,16 @@ void Client::Send_GlobalMapFog( ushort zx, ushort zy, uchar fog )
     BOUT_END( this );
 }
 
+void Client::Send_Broadcast( BufferManager& msg )
+{
+    if( IsSendDisabled() || IsOffline() )
+        return;
+
+    BOUT_BEGIN( this );
+    Bout.Push( msg.GetData(), msg.GetEndPos() );
+    BOUT_END( this );
+}
+
 void Client::Send_XY( Critter* cr )
 {
     if( IsSendDisabled() || IsOffline() )
@@ -5631,6 +5793,7 @@ bool Npc::AddPlane( int reason, AIDataPlane* plane, bool is_child, Critter* some
                 SetBestCurPlane();
         }
     }
+    Job::Wake( this );
     return true;
 }
 
@@ -72,6 +72,10 @@ public:
     bool             IsRuning;
     uint             PrevHexTick;
     ushort           PrevHexX, PrevHexY;
+    int              GridCell;             // Map critters grid, position of last visibility processing
+    ushort           GridHexX, GridHexY;
+    uint             GridVisRadius;
+    int              GlobalGridCell;       // Critter manager global map grid, -1 not placed
     int              LockMapTransfers;
     Critter*         ThisPtr[MAX_PARAMETERS_ARRAYS];
     uint             AllowedToDownloadMap;
@@ -103,6 +107,7 @@ public:
     {
         Data.MapId = map_id;
         Data.MapPid = map_pid;
+        IsSaveChanged = true;
     }
     void SetLexems( const char* lexems );
     bool IsLexems() { return Data.Lexems[0] != 0; }
@@ -276,6 +281,9 @@ public:
     void SetWait( uint ms );
     bool IsWait();
 
+    // Game tick of next FOServer::ProcessCritter call, zero if every cycle
+    uint GetNextProcessTick();
+
     void FullClear();
 
     // Send
@@ -328,6 +336,7 @@ public:
     void Send_PlaySound( uint crid_synchronize, const char* sound_name );
     void Send_PlaySoundType( uint crid_synchronize, uchar sound_type, uchar sound_type_ext, uchar sound_id, uchar sound_id_ext );
     void Send_CritterLexems( Critter* cr );
+    void Send_Broadcast( BufferManager& msg );
 
     // Send all
     void SendA_Move( uint move_params );
@@ -347,6 +356,7 @@ public:
     void SendA_Follow( uchar follow_type, ushort map_pid, uint follow_wait );
     void SendA_ParamOther( ushort num_param, int val );
     void SendA_ParamCheck( ushort num_param );
+    void SendA_Broadcast( BufferManager& msg );
 
     // Chosen data
     void Send_AddAllItems();
@@ -391,6 +401,7 @@ public:
     bool IsDmgTwoArm()             { return Data.Params[DAMAGE_RIGHT_ARM] != 0 && Data.Params[DAMAGE_LEFT_ARM] != 0; }
     void SendMessage( int num, int val, int to );
     int  GetLook();
+    uint GetGridVisRadius( int look ); // Max distance of seeing or show/hide events
     uint GetTalkDistance( Critter* talker );
     uint GetAttackDist( Item* weap, int use );
     uint GetUseDist();
@@ -485,6 +496,10 @@ public:
     uint GlobalIdleNextTick;
     uint ApRegenerationTick;
 
+    // World save
+    bool IsSaveChanged; // Written to next world save journal
+    uint SaveCrc;       // Checksum of last saved record
+
     // Reference counter
     bool IsNotValid;
     bool CanBeRemoved;
@@ -524,6 +539,7 @@ public:
         Mutex         Locker;
         Client*       PClient;
         bufferevent*  BEV;
+        uint          Loop;
         # if defined (LIBEVENT_TIMEOUTS_WORKAROUND)
         MutexSpinlock BEVLocker;
         # endif
@@ -647,6 +663,7 @@ public:
     void Send_PlaySound( uint crid_synchronize, const char* sound_name );
     void Send_PlaySoundType( uint crid_synchronize, uchar sound_type, uchar sound_type_ext, uchar sound_id, uchar sound_id_ext );
     void Send_CritterLexems( Critter* cr );
+    void Send_Broadcast( BufferManager& msg );
     void Send_MapText( ushort hx, ushort hy, uint color, const char* text, ushort text_len, ushort intellect, bool unsafe_text );
     void Send_MapTextMsg( ushort hx, ushort hy, uint color, ushort num_msg, uint num_str );
     void Send_MapTextMsgLex( ushort hx, ushort hy, uint color, ushort num_msg, uint num_str, const char* lexems, ushort lexems_len );
@@ -75,7 +75,11 @@ void CritterManager::Clear()
     for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
         SAFEREL( (*it).second );
     allCritters.clear();
+    playersByName.clear();
+    npcsByPid.clear();
+    globalGrid.clear();
     crToDelete.clear();
+    saveProtoParams.clear();
     playersCount = 0;
     npcCount = 0;
     lastNpcId = CRITTER_ID_START_NPC;
@@ -206,6 +210,43 @@ CritData* CritterManager::GetAllProtos()
 }
 
 #ifdef FOCLASSIC_SERVER
+void CritterManager::SaveProtoParamsFile( void (*save_func)( void*, size_t ) )
+{
+    // All loaded prototypes, journal may reference any of them
+    uint count = 0;
+    for( uint pid = 1; pid < MAX_PROTO_CRITTERS; pid++ )
+        if( allProtos[pid].ProtoId )
+            count++;
+
+    save_func( &count, sizeof(count) );
+    for( ushort pid = 1; pid < MAX_PROTO_CRITTERS; pid++ )
+    {
+        if( allProtos[pid].ProtoId )
+        {
+            save_func( &pid, sizeof(pid) );
+            save_func( allProtos[pid].Params, sizeof(allProtos[pid].Params) );
+        }
+    }
+}
+
+bool CritterManager::LoadProtoParamsFile( void* f )
+{
+    saveProtoParams.clear();
+
+    uint count = 0;
+    if( !FileRead( f, &count, sizeof(count) ) )
+        return false;
+    for( uint i = 0; i < count; i++ )
+    {
+        ushort pid = 0;
+        IntVec params( MAX_PARAMS );
+        if( !FileRead( f, &pid, sizeof(pid) ) || !FileRead( f, &params[0], MAX_PARAMS * sizeof(int) ) )
+            return false;
+        saveProtoParams[pid].swap( params );
+    }
+    return true;
+}
+
 void CritterManager::SaveCrittersFile( void (*save_func)( void*, size_t ) )
 {
     CrVec crits;
@@ -219,17 +260,35 @@ void CritterManager::SaveCrittersFile( void (*save_func)( void*, size_t ) )
     uint count = (uint)crits.size();   // npcCount
     save_func( &count, sizeof(count) );
     for( auto it = crits.begin(), end = crits.end(); it != end; ++it )
+        SaveCritter( *it, save_func );
+}
+
+void CritterManager::SaveCritter( Critter* cr, void (*save_func)( void*, size_t ) )
+{
+    cr->Data.IsDataExt = (cr->DataExt ? true : false);
+
+    // Params relative to prototype, mostly zeros for packer
+    CritData* proto = GetProto( cr->Data.ProtoId );
+    if( proto )
+    {
+        int params[MAX_PARAMS];
+        for( uint i = 0; i < MAX_PARAMS; i++ )
+            params[i] = (int)( (uint)cr->Data.Params[i] - (uint)proto->Params[i] );
+        const size_t params_end = offsetof( CritData, Params ) + sizeof(params);
+        save_func( &cr->Data, offsetof( CritData, Params ) );
+        save_func( params, sizeof(params) );
+        save_func( (uchar*)&cr->Data + params_end, sizeof(cr->Data) - params_end );
+    }
+    else
     {
-        Critter* cr = *it;
-        cr->Data.IsDataExt = (cr->DataExt ? true : false);
         save_func( &cr->Data, sizeof(cr->Data) );
-        if( cr->Data.IsDataExt )
-            save_func( cr->DataExt, sizeof(CritDataExt) );
-        uint te_count = (uint)cr->CrTimeEvents.size();
-        save_func( &te_count, sizeof(te_count) );
-        if( te_count )
-            save_func( &cr->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
     }
+    if( cr->Data.IsDataExt )
+        save_func( cr->DataExt, sizeof(CritDataExt) );
+    uint te_count = (uint)cr->CrTimeEvents.size();
+    save_func( &te_count, sizeof(te_count) );
+    if( te_count )
+        save_func( &cr->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
 }
 
 bool CritterManager::LoadCrittersFile( void* f, uint version )
@@ -262,6 +321,14 @@ bool CritterManager::LoadCrittersFile( void* f, uint version )
             FileRead( f, &tevents[0], te_count * sizeof(Critter::CrTimeEvent) );
         }
 
+        // Prototypes params loaded only for WORLD_SAVE_V2 and later
+        auto it = saveProtoParams.find( data.ProtoId );
+        if( it != saveProtoParams.end() )
+        {
+            for( uint j = 0; j < MAX_PARAMS; j++ )
+                data.Params[j] = (int)( (uint)data.Params[j] + (uint)(*it).second[j] );
+        }
+
         if( data.Id > lastNpcId )
             lastNpcId = data.Id;
 
@@ -289,6 +356,8 @@ bool CritterManager::LoadCrittersFile( void* f, uint version )
         AddCritter( npc );
     }
 
+    saveProtoParams.clear();
+
     WriteLog( "Load NPCs... loaded<%u>", count - errors );
     if( errors )
         WriteLogX( ", errors<%u>", errors );
@@ -343,7 +412,10 @@ void CritterManager::CritterGarbager()
                 continue;
             }
             allCritters.erase( it_cr );
+            removedNpcIds.push_back( *it );
             npcCount--;
+            npcsByPid[( (Npc*)cr )->GetProtoId()].erase( cr->GetId() );
+            EraseGlobalGrid( cr );
             crLocker.Unlock();
 
             SYNC_LOCK( cr );
@@ -565,25 +637,41 @@ Npc* CritterManager::CreateNpc( ushort proto_id, bool copy_data )
 
 void CritterManager::AddCritter( Critter* cr )
 {
-    SCOPE_LOCK( crLocker );
-
+    crLocker.Lock();
     allCritters.insert( PAIR( cr->GetId(), cr ) );
     if( cr->IsPlayer() )
+    {
+        char key[UTF8_BUF_SIZE( MAX_NAME )];
+        Str::Copy( key, ( (Client*)cr )->Name );
+        Str::LowerUTF8( key );
+        playersByName[key] = (Client*)cr;
         playersCount++;
+    }
     else
+    {
+        npcsByPid[( (Npc*)cr )->GetProtoId()].insert( PAIR( cr->GetId(), (Npc*)cr ) );
         npcCount++;
+    }
+    crLocker.Unlock();
+
+    SetGlobalGrid( cr );
 }
 
-void CritterManager::GetCopyCritters( CrVec& critters, bool sync_lock )
+void CritterManager::GetRemovedNpcIds( UIntVec& ids )
 {
-    crLocker.Lock();
-    CrMap all_critters = allCritters;
-    crLocker.Unlock();
+    SCOPE_LOCK( crLocker );
+    ids.swap( removedNpcIds );
+    removedNpcIds.clear();
+}
 
+void CritterManager::GetCopyCritters( CrVec& critters, bool sync_lock )
+{
     CrVec find_critters;
-    find_critters.reserve( all_critters.size() );
-    for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
+    crLocker.Lock();
+    find_critters.reserve( allCritters.size() );
+    for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
         find_critters.push_back( (*it).second );
+    crLocker.Unlock();
 
     if( sync_lock && LogicMT )
     {
@@ -592,14 +680,12 @@ void CritterManager::GetCopyCritters( CrVec& critters, bool sync_lock )
             SYNC_LOCK( *it );
 
         // Recheck
-        crLocker.Lock();
-        all_critters = allCritters;
-        crLocker.Unlock();
-
         CrVec find_critters2;
-        find_critters2.reserve( find_critters.size() );
-        for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
+        crLocker.Lock();
+        find_critters2.reserve( allCritters.size() );
+        for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
             find_critters2.push_back( (*it).second );
+        crLocker.Unlock();
 
         // Search again, if different
         if( !CompareContainers( find_critters, find_critters2 ) )
@@ -614,18 +700,16 @@ void CritterManager::GetCopyCritters( CrVec& critters, bool sync_lock )
 
 void CritterManager::GetCopyNpcs( PcVec& npcs, bool sync_lock )
 {
-    crLocker.Lock();
-    CrMap all_critters = allCritters;
-    crLocker.Unlock();
-
     PcVec find_npcs;
-    find_npcs.reserve( all_critters.size() );
-    for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
+    crLocker.Lock();
+    find_npcs.reserve( npcCount );
+    for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
     {
         Critter* cr = (*it).second;
         if( cr->IsNpc() )
             find_npcs.push_back( (Npc*)cr );
     }
+    crLocker.Unlock();
 
     if( sync_lock && LogicMT )
     {
@@ -634,18 +718,16 @@ void CritterManager::GetCopyNpcs( PcVec& npcs, bool sync_lock )
             SYNC_LOCK( *it );
 
         // Recheck
-        crLocker.Lock();
-        all_critters = allCritters;
-        crLocker.Unlock();
-
         PcVec find_npcs2;
-        find_npcs2.reserve( find_npcs.size() );
-        for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
+        crLocker.Lock();
+        find_npcs2.reserve( npcCount );
+        for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
         {
             Critter* cr = (*it).second;
             if( cr->IsNpc() )
                 find_npcs2.push_back( (Npc*)cr );
         }
+        crLocker.Unlock();
 
         // Search again, if different
         if( !CompareContainers( find_npcs, find_npcs2 ) )
@@ -658,20 +740,62 @@ void CritterManager::GetCopyNpcs( PcVec& npcs, bool sync_lock )
     npcs = find_npcs;
 }
 
-void CritterManager::GetCopyPlayers( ClVec& players, bool sync_lock )
+void CritterManager::GetCopyNpcs( ushort pid, PcVec& npcs, bool sync_lock )
 {
+    PcVec find_npcs;
     crLocker.Lock();
-    CrMap all_critters = allCritters;
+    auto it_pid = npcsByPid.find( pid );
+    if( it_pid != npcsByPid.end() )
+    {
+        PcMap& pid_npcs = (*it_pid).second;
+        find_npcs.reserve( pid_npcs.size() );
+        for( auto it = pid_npcs.begin(), end = pid_npcs.end(); it != end; ++it )
+            find_npcs.push_back( (*it).second );
+    }
     crLocker.Unlock();
 
+    if( sync_lock && LogicMT )
+    {
+        // Synchronize
+        for( auto it = find_npcs.begin(), end = find_npcs.end(); it != end; ++it )
+            SYNC_LOCK( *it );
+
+        // Recheck
+        PcVec find_npcs2;
+        crLocker.Lock();
+        it_pid = npcsByPid.find( pid );
+        if( it_pid != npcsByPid.end() )
+        {
+            PcMap& pid_npcs = (*it_pid).second;
+            find_npcs2.reserve( pid_npcs.size() );
+            for( auto it = pid_npcs.begin(), end = pid_npcs.end(); it != end; ++it )
+                find_npcs2.push_back( (*it).second );
+        }
+        crLocker.Unlock();
+
+        // Search again, if different
+        if( !CompareContainers( find_npcs, find_npcs2 ) )
+        {
+            GetCopyNpcs( pid, npcs, sync_lock );
+            return;
+        }
+    }
+
+    npcs = find_npcs;
+}
+
+void CritterManager::GetCopyPlayers( ClVec& players, bool sync_lock )
+{
     ClVec find_players;
-    find_players.reserve( all_critters.size() );
-    for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
+    crLocker.Lock();
+    find_players.reserve( playersCount );
+    for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
     {
         Critter* cr = (*it).second;
         if( cr->IsPlayer() )
             find_players.push_back( (Client*)cr );
     }
+    crLocker.Unlock();
 
     if( sync_lock && LogicMT )
     {
@@ -680,18 +804,16 @@ void CritterManager::GetCopyPlayers( ClVec& players, bool sync_lock )
             SYNC_LOCK( *it );
 
         // Recheck
-        crLocker.Lock();
-        all_critters = allCritters;
-        crLocker.Unlock();
-
         ClVec find_players2;
-        find_players2.reserve( find_players.size() );
-        for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
+        crLocker.Lock();
+        find_players2.reserve( playersCount );
+        for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
         {
             Critter* cr = (*it).second;
             if( cr->IsPlayer() )
                 find_players2.push_back( (Client*)cr );
         }
+        crLocker.Unlock();
 
         // Search again, if different
         if( !CompareContainers( find_players, find_players2 ) )
@@ -704,21 +826,41 @@ void CritterManager::GetCopyPlayers( ClVec& players, bool sync_lock )
     players = find_players;
 }
 
+void CritterManager::FindGlobalMapCritters( ushort wx, ushort wy, uint radius, int find_type, CrVec& critters )
+{
+    // Invoked in locked scope
+    if( globalGrid.empty() )
+        return;
+
+    // Euclidean distance not less than coordinates difference, so square of zones covers radius
+    int r = (int)MIN( radius, (uint)GM_MAXX + GM_MAXY );
+    int min_zx = MIN( (int)GM_ZONE( MAX( (int)wx - r, 0 ) ), GM__MAXZONEX - 1 );
+    int min_zy = MIN( (int)GM_ZONE( MAX( (int)wy - r, 0 ) ), GM__MAXZONEY - 1 );
+    int max_zx = MIN( (int)GM_ZONE( (int)wx + r ), GM__MAXZONEX - 1 );
+    int max_zy = MIN( (int)GM_ZONE( (int)wy + r ), GM__MAXZONEY - 1 );
+
+    for( int zy = min_zy; zy <= max_zy; zy++ )
+    {
+        for( int zx = min_zx; zx <= max_zx; zx++ )
+        {
+            CrVec& cell = globalGrid[zy * GM__MAXZONEX + zx];
+            for( auto it = cell.begin(), end = cell.end(); it != end; ++it )
+            {
+                Critter* cr = *it;
+                if( !cr->GetMap() && cr->GroupMove && DistSqrt( (int)cr->GroupMove->CurX, (int)cr->GroupMove->CurY, wx, wy ) <= radius &&
+                    cr->CheckFind( find_type ) )
+                    critters.push_back( cr );
+            }
+        }
+    }
+}
+
 void CritterManager::GetGlobalMapCritters( ushort wx, ushort wy, uint radius, int find_type, CrVec& critters, bool sync_lock )
 {
     crLocker.Lock();
-    CrMap all_critters = allCritters;
-    crLocker.Unlock();
-
     CrVec find_critters;
-    find_critters.reserve( all_critters.size() );
-    for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
-    {
-        Critter* cr = (*it).second;
-        if( !cr->GetMap() && cr->GroupMove && DistSqrt( (int)cr->GroupMove->CurX, (int)cr->GroupMove->CurY, wx, wy ) <= radius &&
-            cr->CheckFind( find_type ) )
-            find_critters.push_back( cr );
-    }
+    FindGlobalMapCritters( wx, wy, radius, find_type, find_critters );
+    crLocker.Unlock();
 
     if( sync_lock && LogicMT )
     {
@@ -728,18 +870,9 @@ void CritterManager::GetGlobalMapCritters( ushort wx, ushort wy, uint radius, in
 
         // Recheck
         crLocker.Lock();
-        all_critters = allCritters;
-        crLocker.Unlock();
-
         CrVec find_critters2;
-        find_critters2.reserve( find_critters.size() );
-        for( auto it = all_critters.begin(), end = all_critters.end(); it != end; ++it )
-        {
-            Critter* cr = (*it).second;
-            if( !cr->GetMap() && cr->GroupMove && DistSqrt( (int)cr->GroupMove->CurX, (int)cr->GroupMove->CurY, wx, wy ) <= radius &&
-                cr->CheckFind( find_type ) )
-                find_critters2.push_back( cr );
-        }
+        FindGlobalMapCritters( wx, wy, radius, find_type, find_critters2 );
+        crLocker.Unlock();
 
         // Search again, if different
         if( !CompareContainers( find_critters, find_critters2 ) )
@@ -752,6 +885,43 @@ void CritterManager::GetGlobalMapCritters( ushort wx, ushort wy, uint radius, in
     critters = find_critters;
 }
 
+void CritterManager::SetGlobalGrid( Critter* cr )
+{
+    SCOPE_LOCK( crLocker );
+
+    // Only registered critters, which moves on global map
+    if( cr->GetMap() || !cr->GroupMove || !allCritters.count( cr->GetId() ) )
+    {
+        EraseGlobalGrid( cr );
+        return;
+    }
+
+    int zx = MIN( (int)GM_ZONE( MAX( (int)cr->GroupMove->CurX, 0 ) ), GM__MAXZONEX - 1 );
+    int zy = MIN( (int)GM_ZONE( MAX( (int)cr->GroupMove->CurY, 0 ) ), GM__MAXZONEY - 1 );
+    int cell = zy * GM__MAXZONEX + zx;
+    if( cell != cr->GlobalGridCell )
+    {
+        EraseGlobalGrid( cr );
+        if( globalGrid.empty() )
+            globalGrid.resize( GM__MAXZONEX * GM__MAXZONEY );
+        globalGrid[cell].push_back( cr );
+        cr->GlobalGridCell = cell;
+    }
+}
+
+void CritterManager::EraseGlobalGrid( Critter* cr )
+{
+    // Invoked in locked scope
+    if( cr->GlobalGridCell < 0 )
+        return;
+
+    CrVec& cell = globalGrid[cr->GlobalGridCell];
+    auto   it = std::find( cell.begin(), cell.end(), cr );
+    if( it != cell.end() )
+        cell.erase( it );
+    cr->GlobalGridCell = -1;
+}
+
 Critter* CritterManager::GetCritter( uint crid, bool sync_lock )
 {
     Critter* cr = NULL;
@@ -791,16 +961,14 @@ Client* CritterManager::GetPlayer( const char* name, bool sync_lock )
 {
     Client* cl = NULL;
 
+    char    key[UTF8_BUF_SIZE( MAX_NAME )];
+    Str::Copy( key, name );
+    Str::LowerUTF8( key );
+
     crLocker.Lock();
-    for( auto it = allCritters.begin(), end = allCritters.end(); it != end; ++it )
-    {
-        Critter* cr = (*it).second;
-        if( cr->IsPlayer() && Str::CompareCaseUTF8( name, cr->GetName() ) )
-        {
-            cl = (Client*)cr;
-            break;
-        }
-    }
+    auto it = playersByName.find( key );
+    if( it != playersByName.end() )
+        cl = (*it).second;
     crLocker.Unlock();
 
     if( cl && sync_lock )
@@ -836,14 +1004,27 @@ void CritterManager::EraseCritter( Critter* cr )
     if( it != allCritters.end() )
     {
         if( cr->IsPlayer() )
+        {
+            char key[UTF8_BUF_SIZE( MAX_NAME )];
+            Str::Copy( key, ( (Client*)cr )->Name );
+            Str::LowerUTF8( key );
+            auto it_name = playersByName.find( key );
+            if( it_name != playersByName.end() && (*it_name).second == cr )
+                playersByName.erase( it_name );
             playersCount--;
+        }
         else
+        {
+            npcsByPid[( (Npc*)cr )->GetProtoId()].erase( cr->GetId() );
+            removedNpcIds.push_back( cr->GetId() );
             npcCount--;
+        }
         allCritters.erase( it );
     }
+    EraseGlobalGrid( cr );
 }
 
-void CritterManager::GetNpcIds( UIntSet& npc_ids )
+void CritterManager::GetNpcIds( CIdMask& npc_ids )
 {
     SCOPE_LOCK( crLocker );
 
@@ -851,7 +1032,7 @@ void CritterManager::GetNpcIds( UIntSet& npc_ids )
     {
         Critter* cr = (*it).second;
         if( cr->IsNpc() )
-            npc_ids.insert( cr->GetId() );
+            npc_ids.SetBit( cr->GetId() );
     }
 }
 
@@ -30,14 +30,25 @@ public:
 
     #ifdef FOCLASSIC_SERVER
 private:
-    CrMap   allCritters;
-    UIntVec crToDelete;
-    uint    lastNpcId;
-    uint    playersCount, npcCount;
-    Mutex   crLocker;
+    CrMap                allCritters;
+    UIntVec              crToDelete;
+    UIntVec              removedNpcIds; // For world save journal
+    uint                 lastNpcId;
+    uint                 playersCount, npcCount;
+    Mutex                crLocker;
+    map<string, Client*> playersByName; // Lower case name -> player
+    map<ushort, PcMap>   npcsByPid;
+    vector<CrVec>        globalGrid;    // Critters on global map, by zones of group position
+    map<ushort, IntVec>  saveProtoParams; // Prototypes params of loading worldsave, npc params stored relative to them
+
+    void EraseGlobalGrid( Critter* cr );
+    void FindGlobalMapCritters( ushort wx, ushort wy, uint radius, int find_type, CrVec& critters );
 
 public:
+    void SaveProtoParamsFile( void (* save_func)( void*, size_t ) );
+    bool LoadProtoParamsFile( void* f );
     void SaveCrittersFile( void (* save_func)( void*, size_t ) );
+    void SaveCritter( Critter* cr, void (* save_func)( void*, size_t ) );
     bool LoadCrittersFile( void* f, uint version );
 
     void RunInitScriptCritters();
@@ -50,16 +61,19 @@ public:
 
     void     AddCritter( Critter* cr );
     CrMap&   GetCrittersNoLock() { return allCritters; }
+    void     GetRemovedNpcIds( UIntVec& ids );
     void     GetCopyCritters( CrVec& critters, bool sync_lock );
     void     GetCopyNpcs( PcVec& npcs, bool sync_lock );
+    void     GetCopyNpcs( ushort pid, PcVec& npcs, bool sync_lock );
     void     GetCopyPlayers( ClVec& players, bool sync_lock );
     void     GetGlobalMapCritters( ushort wx, ushort wy, uint radius, int find_type, CrVec& critters, bool sync_lock );
+    void     SetGlobalGrid( Critter* cr );
     Critter* GetCritter( uint crid, bool sync_lock );
     Client*  GetPlayer( uint crid, bool sync_lock );
     Client*  GetPlayer( const char* name, bool sync_lock );
     Npc*     GetNpc( uint crid, bool sync_lock );
     void     EraseCritter( Critter* cr );
-    void     GetNpcIds( UIntSet& npc_ids );
+    void     GetNpcIds( CIdMask& npc_ids );
 
     uint PlayersInGame();
     uint NpcInGame();
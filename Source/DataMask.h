@@ -209,6 +209,41 @@ private:
     uint   height;
 };
 
+// Set of object ids, bit per id starting from lowest one
+class CIdMask
+{
+public:
+    CIdMask() : baseId( 0 ) {}
+
+    void SetBit( uint id )
+    {
+        if( data.empty() )
+            baseId = id & ~31U;
+        if( id < baseId )
+        {
+            uint new_base = id & ~31U;
+            data.insert( data.begin(), (baseId - new_base) / 32, 0 );
+            baseId = new_base;
+        }
+        uint index = (id - baseId) / 32;
+        if( index >= data.size() )
+            data.resize( index + 1, 0 );
+        data[index] |= 1U << (id % 32);
+    }
+
+    bool GetBit( uint id )
+    {
+        if( id < baseId )
+            return false;
+        uint index = (id - baseId) / 32;
+        return index < data.size() && ( (data[index] >> (id % 32) ) & 1 ) != 0;
+    }
+
+private:
+    uint    baseId;
+    UIntVec data;
+};
+
 
 /*template<int Size>
    class CBitMask_
@@ -9,6 +9,7 @@
 #include "Ini.h"
 #include "Script.h"
 #include "Text.h"
+#include "Thread.h"
 #include "Vars.h"
 
 DialogManager DlgMngr;
@@ -52,7 +53,56 @@ DialogAnswer::~DialogAnswer()
 
 //
 
-bool DialogManager::LoadDialogs( const char* list_name )
+struct DialogLoadEntry
+{
+    uint        Id;
+    string      Name;
+    DialogPack* Pack;
+};
+typedef vector<DialogLoadEntry> DialogLoadEntryVec;
+
+struct DialogLoadQueue
+{
+    DialogLoadEntryVec* Entries;
+    uint                Next;
+    Mutex               Locker;
+};
+
+static void LoadDialogs_Work( void* data )
+{
+    DialogLoadQueue* queue = (DialogLoadQueue*)data;
+    DialogManager    parser; // Own errors buffer
+    while( true )
+    {
+        queue->Locker.Lock();
+        uint index = queue->Next++;
+        queue->Locker.Unlock();
+        if( index >= queue->Entries->size() )
+            break;
+
+        DialogLoadEntry& entry = queue->Entries->at( index );
+
+        char name[256];
+        Str::Copy( name, entry.Name.c_str() );
+        Str::Append( name, DIALOG_FILE_EXT );
+
+        FileManager fdlg;
+        if( !fdlg.LoadFile( name, PATH_SERVER_DIALOGS ) )
+        {
+            WriteLog( "Unable to open dialog file, id<%u>, name<%s>.\n", entry.Id, name );
+            continue;
+        }
+
+        if( ConfigFile->GetBool( SECTION_SERVER, "VerboseInit", false ) )
+            WriteLog( "Load dialog<%u:%s>\n", entry.Id, entry.Name.c_str() );
+
+        entry.Pack = parser.ParseDialog( entry.Name.c_str(), entry.Id, (char*)fdlg.GetBuf() );
+        if( !entry.Pack )
+            WriteLog( "Unable to parse dialog, id<%u>, path<%s>.\n", entry.Id, entry.Name.c_str() );
+    }
+}
+
+bool DialogManager::LoadDialogs( const char* list_name, uint threads /* = 1 */ )
 {
     WriteLog( "Load dialogs..." );
 
@@ -71,9 +121,11 @@ bool DialogManager::LoadDialogs( const char* list_name )
 
     WriteLogX( "\n" );
 
-    istrstream str( (char*)lst.GetBuf() );
-    int        dlg_count = 0;
-    int        dlg_loaded = 0;
+    istrstream         str( (char*)lst.GetBuf() );
+    int                dlg_count = 0;
+    int                dlg_loaded = 0;
+    DialogLoadEntryVec entries;
+    UIntSet            ids;
     while( !str.eof() )
     {
         char ch;
@@ -99,36 +151,53 @@ bool DialogManager::LoadDialogs( const char* list_name )
             continue;
         }
 
-        if( DialogsPacks.count( dlg_id ) )
+        if( DialogsPacks.count( dlg_id ) || !ids.insert( dlg_id ).second )
         {
             WriteLog( "Dialog id<%u> is already parsed.\n", dlg_id );
             continue;
         }
 
-        char name[256];
-        Str::Copy( name, dlg_name );
-        Str::Append( name, DIALOG_FILE_EXT );
+        DialogLoadEntry entry;
+        entry.Id = dlg_id;
+        entry.Name = dlg_name;
+        entry.Pack = NULL;
+        entries.push_back( entry );
+    }
 
-        FileManager fdlg;
-        if( !fdlg.LoadFile( name, PATH_SERVER_DIALOGS ) )
+    // Dialog files are independent, parse them in parallel
+    DialogLoadQueue queue;
+    queue.Entries = &entries;
+    queue.Next = 0;
+    if( threads > entries.size() )
+        threads = (uint)entries.size();
+    vector<Thread*> workers;
+    for( uint i = 1; i < threads; i++ )
+    {
+        Thread* thread = new Thread();
+        if( !thread->Start( LoadDialogs_Work, Str::FormatBuf( "LoadDialogs%u", i ), &queue ) )
         {
-            WriteLog( "Unable to open dialog file, id<%u>, name<%s>.\n", dlg_id, name );
-            continue;
+            delete thread;
+            break;
         }
+        workers.push_back( thread );
+    }
+    LoadDialogs_Work( &queue );
+    for( uint i = 0; i < workers.size(); i++ )
+    {
+        workers[i]->Wait();
+        delete workers[i];
+    }
 
-        if( ConfigFile->GetBool( SECTION_SERVER, "VerboseInit", false ) )
-            WriteLog( "Load dialog<%u:%s>\n", dlg_id, dlg_name );
-
-        DialogPack* pack = ParseDialog( dlg_name, dlg_id, (char*)fdlg.GetBuf() );
-        if( !pack )
-        {
-            WriteLog( "Unable to parse dialog, id<%u>, path<%s>.\n", dlg_id, dlg_name );
+    // Register in list order
+    for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+    {
+        DialogLoadEntry& entry = *it;
+        if( !entry.Pack )
             continue;
-        }
 
-        if( !AddDialogs( pack ) )
+        if( !AddDialogs( entry.Pack ) )
         {
-            WriteLog( "Unable to add dialogs pack, id<%u>, path<%s>.\n", dlg_id, dlg_name );
+            WriteLog( "Unable to add dialogs pack, id<%u>, path<%s>.\n", entry.Id, entry.Name.c_str() );
             continue;
         }
 
@@ -378,29 +447,29 @@ DialogPack* DialogManager::ParseDialog( const char* name, uint id, const char* d
                     read_demands = false;
                 else if( ch == '*' )
                 {
-                    DemandResult* dr = LoadDemandResult( input, read_demands );
-                    if( !dr )
+                    DemandResult dr;
+                    if( !LoadDemandResult( input, read_demands, dr ) )
                         LOAD_FAIL( "Demand or result not loaded." );
                     if( read_demands )
-                        current_answer.Demands.push_back( *dr );
+                        current_answer.Demands.push_back( dr );
                     else
-                        current_answer.Results.push_back( *dr );
+                        current_answer.Results.push_back( dr );
                 }
                 // Demands
                 else if( ch == 'D' )
                 {
-                    DemandResult* d = LoadDemandResult( input, true );
-                    if( !d )
+                    DemandResult d;
+                    if( !LoadDemandResult( input, true, d ) )
                         LOAD_FAIL( "Demand not loaded." );
-                    current_answer.Demands.push_back( *d );
+                    current_answer.Demands.push_back( d );
                 }
                 // Results
                 else if( ch == 'R' )
                 {
-                    DemandResult* r = LoadDemandResult( input, false );
-                    if( !r )
+                    DemandResult r;
+                    if( !LoadDemandResult( input, false, r ) )
                         LOAD_FAIL( "Result not loaded." );
-                    current_answer.Results.push_back( *r );
+                    current_answer.Results.push_back( r );
                 }
                 // Flags
                 /*else if(ch=='F')
@@ -430,7 +499,7 @@ DialogPack* DialogManager::ParseDialog( const char* name, uint id, const char* d
     return pack;
 }
 
-DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand )
+bool DialogManager::LoadDemandResult( istrstream& input, bool is_demand, DemandResult& result )
 {
     int  errors = 0;
     char who = 'p';
@@ -456,7 +525,7 @@ DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand
     if( input.fail() )
     {
         AddError( "Parse dr type fail." );
-        return NULL;
+        return false;
     }
 
     bool deprecated = false;
@@ -469,7 +538,7 @@ DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand
         if( input.fail() )
         {
             AddError( "Parse dr type fail2." );
-            return NULL;
+            return false;
         }
         type = GetDRType( type_str, deprecated );
     }
@@ -701,7 +770,7 @@ DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand
             if( id <= 0 )
             {
                 WriteLogF( _FUNC_, " - Script<%s> bind error.\n", name );
-                return NULL;
+                return false;
             }
             if( id > 0xFFFF )
                 WriteLogF( _FUNC_, " - Id greater than 0xFFFF.\n" );
@@ -716,7 +785,7 @@ DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand
         case DR_OR:
             break;
         default:
-            return NULL;
+            return false;
     }
 
     // Validate parsing
@@ -727,7 +796,6 @@ DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand
     }
 
     // Fill
-    static DemandResult result;
     result.Type = type;
     result.Who = who;
     result.ParamId = id;
@@ -750,10 +818,8 @@ DemandResult* DialogManager::LoadDemandResult( istrstream& input, bool is_demand
     result.ValueExt[2] = script_val[2];
     result.ValueExt[3] = script_val[3];
     result.ValueExt[4] = script_val[4];
-    if( errors )
-        return NULL;
     #endif
-    return &result;
+    return errors == 0;
 }
 
 ushort DialogManager::GetTempVarId( const char* str )
@@ -883,7 +949,7 @@ bool DialogManager::CheckWho( char who )
 
 void DialogManager::AddError( const char* fmt, ... )
 {
-    static char res[1024];
+    char res[1024];
 
     va_list list;
     va_start( list, fmt );
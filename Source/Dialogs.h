@@ -171,7 +171,7 @@ public:
     StrUIntMap    DlgPacksNames;
     string        LastErrors;
 
-    bool LoadDialogs( const char* list_name );
+    bool LoadDialogs( const char* list_name, uint threads = 1 );
     void SaveList( const char* path, const char* list_name );
     void Finish();
 
@@ -187,13 +187,13 @@ public:
     ushort      GetTempVarId( const char* str );
 
 private:
-    DemandResult* LoadDemandResult( istrstream& input, bool is_demand );
-    bool          CheckLockTime( int time );
-    int           GetNotAnswerAction( const char* str, bool& ret_val );
-    int           GetDRType( const char* str, bool& deprecated );
-    bool          CheckOper( char oper );
-    bool          CheckWho( char who );
-    void          AddError( const char* fmt, ... );
+    bool LoadDemandResult( istrstream& input, bool is_demand, DemandResult& result );
+    bool CheckLockTime( int time );
+    int  GetNotAnswerAction( const char* str, bool& ret_val );
+    int  GetDRType( const char* str, bool& deprecated );
+    bool CheckOper( char oper );
+    bool CheckWho( char who );
+    void AddError( const char* fmt, ... );
 };
 
 extern DialogManager DlgMngr;
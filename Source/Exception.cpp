@@ -2,6 +2,7 @@
 
 #include "Exception.h"
 #include "FileManager.h"
+#include "Log.h"
 #include "Text.h"
 #include "Thread.h"
 #include "Timer.h"
@@ -70,6 +71,9 @@ LONG WINAPI TopLevelFilterReadableDump( EXCEPTION_POINTERS* except )
     char        dump_path[MAX_FOPATH];
     char        dump_path_dir[MAX_FOPATH];
 
+    // Write out queued log messages
+    LogFlushOnCrash();
+
     DateTime    dt;
     Timer::GetCurrentDateTime( dt );
     const char* dump_str = except ? "CrashDump" : ManualDumpAppendix;
@@ -447,6 +451,9 @@ LONG WINAPI TopLevelFilterMiniDump( EXCEPTION_POINTERS* except )
     char       dump_path[MAX_FOPATH];
     char       dump_path_dir[MAX_FOPATH];
 
+    // Write out queued log messages
+    LogFlushOnCrash();
+
     DateTime    dt;
     Timer::GetCurrentDateTime( dt );
     const char* dump_str = except ? "CrashDump" : ManualDumpAppendix;
@@ -572,6 +579,9 @@ void TerminationHandler( int signum, siginfo_t* siginfo, void* context )
     char        dump_path[MAX_FOPATH];
     char        dump_path_dir[MAX_FOPATH];
 
+    // Write out queued log messages
+    LogFlushOnCrash();
+
     DateTime    dt;
     Timer::GetCurrentDateTime( dt );
     const char* dump_str = siginfo ? "CrashDump" : ManualDumpAppendix;
@@ -1,11 +1,44 @@
 #include "Core.h"
 
+#include <unordered_map>
+
 #include "FileManager.h"
 #include "FileSystem.h"
 #include "Log.h"
+#include "Mutex.h"
 #include "Text.h"
 
-#define OUT_BUF_START_SIZE    (0x100)
+#define OUT_BUF_START_SIZE           (0x100)
+#define DATA_FILES_CACHE_SIZE        (32 * 1024 * 1024)
+#define DATA_FILES_CACHE_MAX_ENTRY   (DATA_FILES_CACHE_SIZE / 8)
+
+// Owner of each packed file name among all loaded data files
+typedef std::unordered_map<string, DataFile*> DataFilesIndexMap;
+DataFilesIndexMap DataFilesIndex;
+
+// Recently loaded packed files, most recent first
+struct DataFilesCacheEntry
+{
+    string    Name;
+    DataFile* Owner;
+    uchar*    Buf;
+    uint      Size;
+};
+typedef list<DataFilesCacheEntry>                                      DataFilesCacheList;
+typedef std::unordered_map<string, DataFilesCacheList::iterator>       DataFilesCacheMap;
+DataFilesCacheList DataFilesCache;
+DataFilesCacheMap  DataFilesCacheIndex;
+uint               DataFilesCacheSize = 0;
+Mutex              DataFilesLocker;
+
+static void ClearDataFilesCache()
+{
+    for( auto it = DataFilesCache.begin(), end = DataFilesCache.end(); it != end; ++it )
+        delete[] it->Buf;
+    DataFilesCache.clear();
+    DataFilesCacheIndex.clear();
+    DataFilesCacheSize = 0;
+}
 
 const char* PathList[PATH_LIST_COUNT] =
 {
@@ -202,11 +235,24 @@ bool FileManager::LoadDataFile( const char* path )
     }
 
     dataFiles.insert( dataFiles.begin(), pfile );
+
+    // New file has top priority
+    StrVec names;
+    pfile->GetFileNames( "", true, NULL, names );
+
+    SCOPE_LOCK( DataFilesLocker );
+    for( auto it = names.begin(), end = names.end(); it != end; ++it )
+        DataFilesIndex[*it] = pfile;
+    ClearDataFilesCache();
     return true;
 }
 
 void FileManager::EndOfWork()
 {
+    SCOPE_LOCK( DataFilesLocker );
+    DataFilesIndex.clear();
+    ClearDataFilesCache();
+
     for( auto it = dataFiles.begin(), end = dataFiles.end(); it != end; ++it )
         delete *it;
     dataFiles.clear();
@@ -319,19 +365,66 @@ bool FileManager::LoadFile( const char* fname, int path_type )
     }
     #endif
 
-    for( auto it = dataFiles.begin(), end = dataFiles.end(); it != end; ++it )
+    DataFile* dat;
     {
-        DataFile* dat = *it;
-        fileBuf = dat->OpenFile( dat_path, fileSize );
-        if( fileBuf )
+        SCOPE_LOCK( DataFilesLocker );
+
+        // Cached copy
+        auto it_cache = DataFilesCacheIndex.find( dat_path );
+        if( it_cache != DataFilesCacheIndex.end() )
         {
+            DataFilesCacheList::iterator it = it_cache->second;
+            DataFilesCache.splice( DataFilesCache.begin(), DataFilesCache, it );
+
+            fileSize = it->Size;
+            fileBuf = new uchar[fileSize + 1];
+            memcpy( fileBuf, it->Buf, fileSize + 1 );
             curPos = 0;
-            dat->GetTime( &timeCreate, &timeAccess, &timeWrite );
+            it->Owner->GetTime( &timeCreate, &timeAccess, &timeWrite );
             return true;
         }
+
+        auto it_index = DataFilesIndex.find( dat_path );
+        if( it_index == DataFilesIndex.end() )
+            return false;
+        dat = it_index->second;
     }
 
-    return false;
+    fileBuf = dat->OpenFile( dat_path, fileSize );
+    if( !fileBuf )
+        return false;
+
+    curPos = 0;
+    dat->GetTime( &timeCreate, &timeAccess, &timeWrite );
+
+    // Store copy, drop least recently used entries
+    if( fileSize <= DATA_FILES_CACHE_MAX_ENTRY )
+    {
+        SCOPE_LOCK( DataFilesLocker );
+
+        if( !DataFilesCacheIndex.count( dat_path ) )
+        {
+            while( DataFilesCacheSize + fileSize > DATA_FILES_CACHE_SIZE && !DataFilesCache.empty() )
+            {
+                DataFilesCacheEntry& last = DataFilesCache.back();
+                DataFilesCacheSize -= last.Size;
+                DataFilesCacheIndex.erase( last.Name );
+                delete[] last.Buf;
+                DataFilesCache.pop_back();
+            }
+
+            DataFilesCacheEntry entry;
+            entry.Name = dat_path;
+            entry.Owner = dat;
+            entry.Size = fileSize;
+            entry.Buf = new uchar[fileSize + 1];
+            memcpy( entry.Buf, fileBuf, fileSize + 1 );
+            DataFilesCache.push_front( entry );
+            DataFilesCacheIndex[entry.Name] = DataFilesCache.begin();
+            DataFilesCacheSize += fileSize;
+        }
+    }
+    return true;
 }
 
 bool FileManager::LoadStream( const uchar* stream, uint length )
@@ -208,9 +208,6 @@ bool HexManager::Init()
     isShowTrack = false;
     curPidMap = 0;
     curMapTime = -1;
-    curHashTiles = 0;
-    curHashWalls = 0;
-    curHashScen = 0;
     isShowCursor = false;
     cursorX = 0;
     cursorY = 0;
@@ -3531,40 +3528,13 @@ bool HexManager::LoadMap( ushort map_pid )
     if( curDataPrefix != GameOpt.MapDataPrefix.c_std_str() )
         ReloadSprites();
 
-    // Make name
-    char map_name[256];
-    Str::Format( map_name, "map%u", map_pid );
-
-    // Find in cache
-    uint   cache_len;
-    uchar* cache = Crypt.GetCache( map_name, cache_len );
-    if( !cache )
-    {
-        WriteLog( "Load map<%s> from cache fail.\n", map_name );
-        return false;
-    }
-
+    // Assemble from cached regions
     FileManager fm;
-    if( !fm.LoadStream( cache, cache_len ) )
+    if( !LoadMapCache( map_pid, fm ) )
     {
-        WriteLog( "Load map<%s> from stream fail.\n", map_name );
-        delete[] cache;
+        WriteLog( "Load map<%u> from cache fail.\n", map_pid );
         return false;
     }
-    delete[] cache;
-
-    // Header
-    uint   buf_len = fm.GetFsize();
-    uchar* buf = Crypt.Uncompress( fm.GetBuf(), buf_len, 50 );
-    if( !buf )
-    {
-        WriteLog( "Uncompress map fail.\n" );
-        return false;
-    }
-
-    fm.UnloadFile();
-    fm.LoadStream( buf, buf_len );
-    delete[] buf;
 
     if( fm.GetBEUInt() != CLIENT_MAP_FORMAT_VER )
     {
@@ -3622,8 +3592,6 @@ bool HexManager::LoadMap( ushort map_pid )
 
     // Tiles
     fm.SetCurPos( 0x2C );
-    curHashTiles = maxhx * maxhy;
-    Crypt.Crc32( fm.GetCurBuf(), tiles_len, curHashTiles );
 
     SprMngr.SurfFilterNearest = true;
     for( uint i = 0; i < tiles_count; i++ )
@@ -3667,8 +3635,6 @@ bool HexManager::LoadMap( ushort map_pid )
 
     // Walls
     fm.SetCurPos( 0x2C + tiles_len );
-    curHashWalls = maxhx * maxhy;
-    Crypt.Crc32( fm.GetCurBuf(), walls_len, curHashWalls );
 
     for( uint i = 0; i < walls_count; i++ )
     {
@@ -3690,8 +3656,6 @@ bool HexManager::LoadMap( ushort map_pid )
 
     // Scenery
     fm.SetCurPos( 0x2C + tiles_len + walls_len );
-    curHashScen = maxhx * maxhy;
-    Crypt.Crc32( fm.GetCurBuf(), scen_len, curHashScen );
 
     for( uint i = 0; i < scen_count; i++ )
     {
@@ -3781,152 +3745,201 @@ void HexManager::UnloadMap()
 
     curPidMap = 0;
     curMapTime = -1;
-    curHashTiles = 0;
-    curHashWalls = 0;
-    curHashScen = 0;
 
     crittersContour = 0;
     critterContour = 0;
 }
 
-void HexManager::GetMapHash( ushort map_pid, uint& hash_tiles, uint& hash_walls, uint& hash_scen )
+// Map cache entries are compressed
+static bool ReadMapCache( const char* name, FileManager& fm )
 {
-    WriteLog( "Get hash of map, pid<%u>...", map_pid );
+    uint   buf_len;
+    uchar* cache = Crypt.GetCache( name, buf_len );
+    if( !cache )
+        return false;
 
-    hash_tiles = 0;
-    hash_walls = 0;
-    hash_scen = 0;
+    uchar* buf = Crypt.Uncompress( cache, buf_len, 50 );
+    delete[] cache;
+    if( !buf )
+        return false;
 
-    if( map_pid == curPidMap )
-    {
-        hash_tiles = curHashTiles;
-        hash_walls = curHashWalls;
-        hash_scen = curHashScen;
+    bool result = fm.LoadStream( buf, buf_len );
+    delete[] buf;
+    return result;
+}
 
-        WriteLog( "Hashes of loaded map: tiles<%u>, walls<%u>, scenery<%u>.\n", hash_tiles, hash_walls, hash_scen );
-        return;
-    }
+static bool WriteMapCache( const char* name, FileManager& fm )
+{
+    uint   buf_len = fm.GetOutBufLen();
+    uchar* buf = Crypt.Compress( fm.GetOutBuf(), buf_len );
+    fm.ClearOutBuf();
+    if( !buf )
+        return false;
 
-    char map_name[256];
-    Str::Format( map_name, "map%u", map_pid );
+    bool result = Crypt.SetCache( name, buf, buf_len );
+    delete[] buf;
+    return result;
+}
 
-    uint   cache_len;
-    uchar* cache = Crypt.GetCache( map_name, cache_len );
-    if( !cache )
-    {
-        WriteLog( "Load map<%s> from cache fail.\n", map_name );
-        return;
-    }
+bool HexManager::GetMapRegions( ushort map_pid, ushort& maxhx, ushort& maxhy, uint& hash_regions, UIntVec& region_hashes )
+{
+    region_hashes.clear();
 
-    FileManager fm;
-    if( !fm.LoadStream( cache, cache_len ) )
-    {
-        WriteLog( "Load map<%s> from stream fail.\n", map_name );
-        delete[] cache;
-        return;
-    }
-    delete[] cache;
+    MapRegionCacheVec regions;
+    if( !GetMapRegions( map_pid, maxhx, maxhy, hash_regions, regions ) )
+        return false;
 
-    uint   buf_len = fm.GetFsize();
-    uchar* buf = Crypt.Uncompress( fm.GetBuf(), buf_len, 50 );
-    if( !buf )
-    {
-        WriteLog( "Uncompress map fail.\n" );
-        return;
-    }
+    region_hashes.resize( regions.size() );
+    for( uint i = 0; i < regions.size(); i++ )
+        region_hashes[i] = regions[i].Hash;
+    return true;
+}
 
-    fm.LoadStream( buf, buf_len );
-    delete[] buf;
+// Whole map with all its regions is kept in one cache entry,
+// cache table has fixed descriptors count
+bool HexManager::GetMapRegions( ushort map_pid, ushort& maxhx, ushort& maxhy, uint& hash_regions, MapRegionCacheVec& regions )
+{
+    maxhx = maxhy = 0;
+    hash_regions = 0;
+    regions.clear();
 
-    if( fm.GetBEUInt() != CLIENT_MAP_FORMAT_VER )
-    {
-        WriteLog( "Map format is not supported.\n" );
-        return;
-    }
+    char map_name[256];
+    Str::Format( map_name, "map%u", map_pid );
 
-    if( fm.GetBEUInt() != map_pid )
-    {
-        WriteLog( "Invalid proto number.\n" );
-        return;
-    }
+    FileManager fm;
+    if( !ReadMapCache( map_name, fm ) )
+        return false;
 
-    // Reserved
-    ushort maxhx = fm.GetBEUShort();
-    if( maxhx == 0xAABB )
-        maxhx = 400;
-    ushort maxhy = fm.GetBEUShort();
-    if( maxhy == 0xCCDD )
-        maxhy = 400;
-    fm.GetBEUInt();
-    fm.GetBEUInt();
-    uint tiles_count = fm.GetBEUInt();
-    uint walls_count = fm.GetBEUInt();
-    uint scen_count = fm.GetBEUInt();
-    uint tiles_len = fm.GetBEUInt();
-    uint walls_len = fm.GetBEUInt();
-    uint scen_len = fm.GetBEUInt();
+    if( fm.GetBEUInt() != CLIENT_MAP_FORMAT_VER || fm.GetBEUInt() != map_pid )
+        return false;
 
-    // Data Check Sum
-    if( tiles_count * sizeof(ProtoMap::Tile) != tiles_len )
-    {
-        WriteLog( "Invalid check sum tiles.\n" );
-        return;
-    }
+    ushort hx = fm.GetBEUShort();
+    ushort hy = fm.GetBEUShort();
+    uint   hash = fm.GetBEUInt();
+    uint   count = fm.GetBEUInt();
+    if( fm.GetFsize() < 0x14 || count > ( fm.GetFsize() - 0x14 ) / 0x10 )
+        return false;
 
-    if( walls_count * sizeof(SceneryCl) != walls_len )
+    MapRegionCacheVec regions_;
+    regions_.resize( count );
+    for( uint r = 0; r < count; r++ )
     {
-        WriteLog( "Invalid check sum walls.\n" );
-        return;
-    }
+        if( fm.GetFsize() - fm.GetCurPos() < 0x10 )
+            return false;
 
-    if( scen_count * sizeof(SceneryCl) != scen_len )
-    {
-        WriteLog( "Invalid check sum scenery.\n" );
-        return;
-    }
+        MapRegionCache& region = regions_[r];
+        region.Hash = fm.GetBEUInt();
+        region.TilesCount = fm.GetBEUInt();
+        region.WallsCount = fm.GetBEUInt();
+        region.ScenCount = fm.GetBEUInt();
 
-    fm.SetCurPos( 0x2C );
-    hash_tiles = maxhx * maxhy;
-    Crypt.Crc32( fm.GetCurBuf(), tiles_len, hash_tiles );
-    fm.SetCurPos( 0x2C + tiles_len );
-    hash_walls = maxhx * maxhy;
-    Crypt.Crc32( fm.GetCurBuf(), walls_len, hash_walls );
-    fm.SetCurPos( 0x2C + tiles_len + walls_len );
-    hash_scen = maxhx * maxhy;
-    Crypt.Crc32( fm.GetCurBuf(), scen_len, hash_scen );
+        uint left = fm.GetFsize() - fm.GetCurPos();
+        if( region.TilesCount > left / sizeof(ProtoMap::Tile) || region.WallsCount > left / sizeof(SceneryCl) ||
+            region.ScenCount > left / sizeof(SceneryCl) )
+            return false;
+        uint data_len = region.TilesCount * sizeof(ProtoMap::Tile) + (region.WallsCount + region.ScenCount) * sizeof(SceneryCl);
+        if( data_len > left )
+            return false;
+
+        if( data_len )
+        {
+            region.Data.resize( data_len );
+            memcpy( &region.Data[0], fm.GetCurBuf(), data_len );
+            fm.GoForward( data_len );
+        }
+    }
+    if( !fm.IsEOF() )
+        return false;
 
-    WriteLog( "complete.\n" );
+    maxhx = hx;
+    maxhy = hy;
+    hash_regions = hash;
+    regions.swap( regions_ );
+    return true;
 }
 
-bool HexManager::GetMapData( ushort map_pid, ItemVec& items, ushort& maxhx, ushort& maxhy )
+bool HexManager::SetMapRegions( ushort map_pid, ushort maxhx, ushort maxhy, uint hash_regions, const MapRegionCacheVec& regions )
 {
     char map_name[256];
     Str::Format( map_name, "map%u", map_pid );
 
-    uint   cache_len;
-    uchar* cache = Crypt.GetCache( map_name, cache_len );
-    if( !cache )
-        return false;
-
     FileManager fm;
-    if( !fm.LoadStream( cache, cache_len ) )
-    {
-        delete[] cache;
-        return false;
-    }
-    delete[] cache;
+    fm.SetBEUInt( CLIENT_MAP_FORMAT_VER );
+    fm.SetBEUInt( map_pid );
+    fm.SetBEUShort( maxhx );
+    fm.SetBEUShort( maxhy );
+    fm.SetBEUInt( hash_regions );
+    fm.SetBEUInt( (uint)regions.size() );
+    for( uint r = 0; r < regions.size(); r++ )
+    {
+        const MapRegionCache& region = regions[r];
+        fm.SetBEUInt( region.Hash );
+        fm.SetBEUInt( region.TilesCount );
+        fm.SetBEUInt( region.WallsCount );
+        fm.SetBEUInt( region.ScenCount );
+        if( region.Data.size() )
+            fm.SetData( (void*)&region.Data[0], (uint)region.Data.size() );
+    }
+    return WriteMapCache( map_name, fm );
+}
 
-    uint   buf_len = fm.GetFsize();
-    uchar* buf = Crypt.Uncompress( fm.GetBuf(), buf_len, 50 );
-    if( !buf )
+bool HexManager::LoadMapCache( ushort map_pid, FileManager& fm )
+{
+    ushort            maxhx, maxhy;
+    uint              hash_regions;
+    MapRegionCacheVec regions;
+    if( !GetMapRegions( map_pid, maxhx, maxhy, hash_regions, regions ) )
         return false;
 
-    if( !fm.LoadStream( buf, buf_len ) )
+    // Gather regions back to whole map layout
+    UCharVec tiles, walls, scen;
+    for( uint r = 0; r < regions.size(); r++ )
     {
-        delete[] buf;
+        const MapRegionCache& region = regions[r];
+        if( !region.Hash )
+        {
+            WriteLog( "Map<%u> region<%u> not found in cache.\n", map_pid, r );
+            return false;
+        }
+
+        uint         tiles_len = region.TilesCount * sizeof(ProtoMap::Tile);
+        uint         walls_len = region.WallsCount * sizeof(SceneryCl);
+        uint         scen_len = region.ScenCount * sizeof(SceneryCl);
+        const uchar* data = (region.Data.size() ? &region.Data[0] : NULL);
+        tiles.insert( tiles.end(), data, data + tiles_len );
+        data += tiles_len;
+        walls.insert( walls.end(), data, data + walls_len );
+        data += walls_len;
+        scen.insert( scen.end(), data, data + scen_len );
+    }
+
+    FileManager out;
+    out.SetBEUInt( CLIENT_MAP_FORMAT_VER );
+    out.SetBEUInt( map_pid );
+    out.SetBEUShort( maxhx );
+    out.SetBEUShort( maxhy );
+    out.SetBEUInt( 0 );
+    out.SetBEUInt( 0 );
+    out.SetBEUInt( (uint)tiles.size() / sizeof(ProtoMap::Tile) );
+    out.SetBEUInt( (uint)walls.size() / sizeof(SceneryCl) );
+    out.SetBEUInt( (uint)scen.size() / sizeof(SceneryCl) );
+    out.SetBEUInt( (uint)tiles.size() );
+    out.SetBEUInt( (uint)walls.size() );
+    out.SetBEUInt( (uint)scen.size() );
+    if( tiles.size() )
+        out.SetData( &tiles[0], (uint)tiles.size() );
+    if( walls.size() )
+        out.SetData( &walls[0], (uint)walls.size() );
+    if( scen.size() )
+        out.SetData( &scen[0], (uint)scen.size() );
+    return fm.LoadStream( out.GetOutBuf(), out.GetOutBufLen() );
+}
+
+bool HexManager::GetMapData( ushort map_pid, ItemVec& items, ushort& maxhx, ushort& maxhy )
+{
+    FileManager fm;
+    if( !LoadMapCache( map_pid, fm ) )
         return false;
-    }
-    delete[] buf;
 
     if( fm.GetBEUInt() != CLIENT_MAP_FORMAT_VER )
         return false;
@@ -4216,9 +4229,6 @@ bool HexManager::SetProtoMap( ProtoMap& pmap )
 
     curPidMap = 0xFFFF;
 //	curMapTime=pmap.Time;
-    curHashTiles = 0xFFFF;
-    curHashWalls = 0xFFFF;
-    curHashScen = 0xFFFF;
     CurProtoMap = &pmap;
     WriteLog( "Create map from prototype complete.\n" );
     return true;
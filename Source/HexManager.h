@@ -113,6 +113,22 @@ struct Drop
 };
 typedef vector<Drop*> DropVec;
 
+/************************************************************************/
+/* Map cache                                                            */
+/************************************************************************/
+
+struct MapRegionCache
+{
+    uint     Hash;
+    uint     TilesCount;
+    uint     WallsCount;
+    uint     ScenCount;
+    UCharVec Data;
+
+    MapRegionCache() : Hash( 0 ), TilesCount( 0 ), WallsCount( 0 ), ScenCount( 0 ) {};
+};
+typedef vector<MapRegionCache> MapRegionCacheVec;
+
 /************************************************************************/
 /* HexField                                                             */
 /************************************************************************/
@@ -161,16 +177,17 @@ private:
     int    curMapTime;
     int    dayTime[4];
     uchar  dayColor[12];
-    uint   curHashTiles;
-    uint   curHashWalls;
-    uint   curHashScen;
+
+    bool LoadMapCache( ushort map_pid, FileManager& fm );
 
 public:
     bool   IsMapLoaded()  { return hexField != NULL; }
     ushort GetCurPidMap() { return curPidMap; }
     bool   LoadMap( ushort map_pid );
     void   UnloadMap();
-    void   GetMapHash( ushort map_pid, uint& hash_tiles, uint& hash_walls, uint& hash_scen );
+    bool   GetMapRegions( ushort map_pid, ushort& maxhx, ushort& maxhy, uint& hash_regions, UIntVec& region_hashes );
+    bool   GetMapRegions( ushort map_pid, ushort& maxhx, ushort& maxhy, uint& hash_regions, MapRegionCacheVec& regions );
+    bool   SetMapRegions( ushort map_pid, ushort maxhx, ushort maxhy, uint hash_regions, const MapRegionCacheVec& regions );
     bool   GetMapData( ushort map_pid, ItemVec& items, ushort& maxhx, ushort& maxhy );
     bool   ParseScenery( SceneryCl& scen );
     int    GetDayTime();
@@ -58,6 +58,10 @@ Item::Item()
     # endif
     RefCounter = 1;
     IsNotValid = false;
+    # if defined (FOCLASSIC_SERVER)
+    Sync.SetType( SYNC_OBJECT_ITEM );
+    IsSaveChanged = true;
+    # endif
     MEMORY_PROCESS( MEMORY_ITEM, sizeof(Item) );
 }
 
@@ -208,6 +212,7 @@ bool Item::ParseScript( const char* script, bool first_time )
             return false;
         }
         Data.ScriptId = func_num;
+        IsSaveChanged = true;
     }
 
     if( Data.ScriptId && Script::PrepareContext( Script::GetScriptFuncBindId( Data.ScriptId ), _FUNC_, Str::FormatBuf( "Item id<%u>, pid<%u>", GetId(), GetProtoId() ) ) )
@@ -339,6 +344,9 @@ void Item::SetSortValue( ItemPtrVec& items )
             sort_value = item->GetSortValue() - 1;
     }
     Data.SortValue = sort_value;
+    #ifdef FOCLASSIC_SERVER
+    IsSaveChanged = true;
+    #endif
 }
 
 bool SortItemsFunc( const Item& l, const Item& r ) { return l.Data.SortValue < r.Data.SortValue; }
@@ -359,6 +367,9 @@ void Item::Count_Set( uint val )
     else if( Data.Count < val )
         ItemMngr.AddItemStatistics( GetProtoId(), val - Data.Count );
     Data.Count = val;
+    #ifdef FOCLASSIC_SERVER
+    IsSaveChanged = true;
+    #endif
 }
 
 void Item::Count_Add( uint val )
@@ -368,6 +379,9 @@ void Item::Count_Add( uint val )
 
     Data.Count += val;
     ItemMngr.AddItemStatistics( GetProtoId(), val );
+    #ifdef FOCLASSIC_SERVER
+    IsSaveChanged = true;
+    #endif
 }
 
 void Item::Count_Sub( uint val )
@@ -379,6 +393,9 @@ void Item::Count_Sub( uint val )
         val = Data.Count;
     Data.Count -= val;
     ItemMngr.SubItemStatistics( GetProtoId(), val );
+    #ifdef FOCLASSIC_SERVER
+    IsSaveChanged = true;
+    #endif
 }
 
 #ifdef FOCLASSIC_SERVER
@@ -392,6 +409,7 @@ void Item::Repair()
     {
         UNSETFLAG( flags, BI_BROKEN );
         deterioration = 0;
+        IsSaveChanged = true;
     }
 }
 #endif
@@ -456,6 +474,9 @@ void Item::SetMode( uchar mode )
         mode = (aim << 4) | (use & 0xF);
     }
     Data.Mode = mode;
+    #ifdef FOCLASSIC_SERVER
+    IsSaveChanged = true;
+    #endif
 }
 
 uint Item::GetCost1st()
@@ -476,6 +497,7 @@ uint Item::GetCost1st()
 #ifdef FOCLASSIC_SERVER
 void Item::SetLexems( const char* lexems )
 {
+    IsSaveChanged = true;
     if( lexems )
     {
         uint len = Str::Length( lexems );
@@ -564,6 +586,7 @@ void Item::ContSetItem( Item* item )
     ChildItems->push_back( item );
     item->Accessory = ITEM_ACCESSORY_CONTAINER;
     item->AccContainer.ContainerId = GetId();
+    item->IsSaveChanged = true;
 }
 
 void Item::ContEraseItem( Item* item )
@@ -591,6 +614,7 @@ void Item::ContEraseItem( Item* item )
         WriteLogF( _FUNC_, " - Item not found, id<%u>, pid<%u>, container<%u>.\n", item->GetId(), item->GetProtoId(), GetId() );
 
     item->Accessory = 0xd3;
+    item->IsSaveChanged = true;
 
     if( ChildItems->empty() )
         SAFEDEL( ChildItems );
@@ -286,7 +286,7 @@ public:
         char        Reserved[2];
     } Data;
 
-    short RefCounter;
+    long  RefCounter;
     bool  IsNotValid;
 
     #ifdef FOCLASSIC_SERVER
@@ -295,6 +295,8 @@ public:
     ItemPtrVec* ChildItems;
     char*       PLexems;
     SyncObject  Sync;
+    bool        IsSaveChanged; // Written to next world save journal
+    uint        SaveCrc;       // Checksum of last saved record
     #endif
     #ifdef FOCLASSIC_CLIENT
     ScriptString Lexems;
@@ -307,8 +309,8 @@ public:
 
     bool operator==( const uint& id ) { return Id == id; }
 
-    void AddRef()  { RefCounter++; }
-    void Release() { if( --RefCounter <= 0 ) delete this; }
+    void AddRef()  { InterlockedIncrement( &RefCounter ); }
+    void Release() { if( InterlockedDecrement( &RefCounter ) <= 0 ) delete this; }
 
     #ifdef FOCLASSIC_SERVER
     void FullClear();
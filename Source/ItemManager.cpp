@@ -72,6 +72,7 @@ void ItemManager::Finish()
         item->Release();
     }
     gameItems.clear();
+    gameItemsByPid.clear();
     #endif
 
     Clear();
@@ -87,6 +88,7 @@ void ItemManager::Clear()
     for( auto it = gameItems.begin(), end = gameItems.end(); it != end; ++it )
         SAFEREL( (*it).second );
     gameItems.clear();
+    gameItemsByPid.clear();
     radioItems.clear();
     itemToDelete.clear();
     itemToDeleteCount.clear();
@@ -597,24 +599,26 @@ void ItemManager::SaveAllItemsFile( void (*save_func)( void*, size_t ) )
     uint count = (uint)gameItems.size();
     save_func( &count, sizeof(count) );
     for( auto it = gameItems.begin(), end = gameItems.end(); it != end; ++it )
+        SaveItem( (*it).second, save_func );
+}
+
+void ItemManager::SaveItem( Item* item, void (*save_func)( void*, size_t ) )
+{
+    save_func( &item->Id, sizeof(item->Id) );
+    save_func( &item->Proto->ProtoId, sizeof(item->Proto->ProtoId) );
+    save_func( &item->Accessory, sizeof(item->Accessory) );
+    save_func( &item->AccBuffer[0], sizeof(item->AccBuffer) );
+    save_func( &item->Data, sizeof(item->Data) );
+    if( item->PLexems )
     {
-        Item* item = (*it).second;
-        save_func( &item->Id, sizeof(item->Id) );
-        save_func( &item->Proto->ProtoId, sizeof(item->Proto->ProtoId) );
-        save_func( &item->Accessory, sizeof(item->Accessory) );
-        save_func( &item->AccBuffer[0], sizeof(item->AccBuffer) );
-        save_func( &item->Data, sizeof(item->Data) );
-        if( item->PLexems )
-        {
-            uchar lex_len = Str::Length( item->PLexems );
-            save_func( &lex_len, sizeof(lex_len) );
-            save_func( item->PLexems, lex_len );
-        }
-        else
-        {
-            uchar zero = 0;
-            save_func( &zero, sizeof(zero) );
-        }
+        uchar lex_len = Str::Length( item->PLexems );
+        save_func( &lex_len, sizeof(lex_len) );
+        save_func( item->PLexems, lex_len );
+    }
+    else
+    {
+        uchar zero = 0;
+        save_func( &zero, sizeof(zero) );
     }
 }
 
@@ -719,6 +723,27 @@ void ItemManager::GetGameItems( ItemPtrVec& items )
     }
 }
 
+void ItemManager::GetRemovedItemIds( UIntVec& ids )
+{
+    SCOPE_LOCK( itemLocker );
+    ids.swap( removedItemIds );
+    removedItemIds.clear();
+}
+
+void ItemManager::GetGameItems( ushort pid, ItemPtrVec& items )
+{
+    SCOPE_LOCK( itemLocker );
+
+    auto it_pid = gameItemsByPid.find( pid );
+    if( it_pid == gameItemsByPid.end() )
+        return;
+
+    ItemPtrMap& pid_items = (*it_pid).second;
+    items.reserve( pid_items.size() );
+    for( auto it = pid_items.begin(), end = pid_items.end(); it != end; ++it )
+        items.push_back( (*it).second );
+}
+
 uint ItemManager::GetItemsCount()
 {
     SCOPE_LOCK( itemLocker );
@@ -754,12 +779,12 @@ void ItemManager::SetCritterItems( Critter* cr )
     }
 }
 
-void ItemManager::GetItemIds( UIntSet& item_ids )
+void ItemManager::GetItemIds( CIdMask& item_ids )
 {
     SCOPE_LOCK( itemLocker );
 
     for( auto it = gameItems.begin(), end = gameItems.end(); it != end; ++it )
-        item_ids.insert( (*it).second->GetId() );
+        item_ids.SetBit( (*it).second->GetId() );
 }
 
 Item* ItemManager::CreateItem( ushort pid, uint count, uint item_id /* = 0 */ )
@@ -806,6 +831,7 @@ Item* ItemManager::CreateItem( ushort pid, uint count, uint item_id /* = 0 */ )
     // Main collection
     itemLocker.Lock();
     gameItems.insert( PAIR( item->Id, item ) );
+    gameItemsByPid[pid].insert( PAIR( item->Id, item ) );
     itemLocker.Unlock();
 
     // Radio collection
@@ -906,6 +932,8 @@ void ItemManager::ItemGarbager()
             }
             Item* item = (*it).second;
             gameItems.erase( it );
+            gameItemsByPid[item->GetProtoId()].erase( id );
+            removedItemIds.push_back( id );
             itemLocker.Unlock();
 
             // Synchronize
@@ -916,6 +944,7 @@ void ItemManager::ItemGarbager()
             {
                 itemLocker.Lock();
                 gameItems.insert( PAIR( item->Id, item ) );
+                gameItemsByPid[item->GetProtoId()].insert( PAIR( item->Id, item ) );
                 itemLocker.Unlock();
 
                 item->Count_Sub( count );
@@ -952,6 +981,7 @@ void ItemManager::ItemGarbager()
 
 void ItemManager::NotifyChangeItem( Item* item )
 {
+    item->IsSaveChanged = true;
     switch( item->Accessory )
     {
         case ITEM_ACCESSORY_CRITTER:
@@ -973,6 +1003,17 @@ void ItemManager::NotifyChangeItem( Item* item )
     }
 }
 
+void ItemManager::ChangeItemProto( Item* item, ProtoItem* proto )
+{
+    SCOPE_LOCK( itemLocker );
+
+    bool in_game = (gameItemsByPid[item->GetProtoId()].erase( item->GetId() ) != 0);
+    item->Proto = proto;
+    item->IsSaveChanged = true;
+    if( in_game )
+        gameItemsByPid[item->GetProtoId()].insert( PAIR( item->Id, item ) );
+}
+
 void ItemManager::EraseItemHolder( Item* item )
 {
     switch( item->Accessory )
@@ -1004,6 +1045,7 @@ void ItemManager::EraseItemHolder( Item* item )
             break;
     }
     item->Accessory = 45;
+    item->IsSaveChanged = true;
 }
 
 void ItemManager::MoveItem( Item* item, uint count, Critter* to_cr )
@@ -1,6 +1,7 @@
 #ifndef __ITEM_MANAGER__
 #define __ITEM_MANAGER__
 
+#include "DataMask.h"
 #include "Defines.h"
 #include "Item.h"
 #include "Mutex.h"
@@ -50,22 +51,27 @@ public:
 
     #ifdef FOCLASSIC_SERVER
 private:
-    ItemPtrMap gameItems;
-    UIntVec    itemToDelete;
-    UIntVec    itemToDeleteCount;
-    uint       lastItemId;
-    Mutex      itemLocker;
+    ItemPtrMap              gameItems;
+    map<ushort, ItemPtrMap> gameItemsByPid;
+    UIntVec                 itemToDelete;
+    UIntVec                 itemToDeleteCount;
+    UIntVec                 removedItemIds; // For world save journal
+    uint                    lastItemId;
+    Mutex                   itemLocker;
 
 public:
     void SaveAllItemsFile( void (*save_func)( void*, size_t ) );
+    void SaveItem( Item* item, void (*save_func)( void*, size_t ) );
     bool LoadAllItemsFile( void* f, int version );
     bool CheckProtoFunctions();
     void RunInitScriptItems();
 
     void GetGameItems( ItemPtrVec& items );
+    void GetRemovedItemIds( UIntVec& ids );
+    void GetGameItems( ushort pid, ItemPtrVec& items );
     uint GetItemsCount();
     void SetCritterItems( Critter* cr );
-    void GetItemIds( UIntSet& item_ids );
+    void GetItemIds( CIdMask& item_ids );
 
     Item* CreateItem( ushort pid, uint count, uint item_id = 0 );
     Item* SplitItem( Item* item, uint count );
@@ -75,6 +81,7 @@ public:
     void ItemGarbager();
 
     void NotifyChangeItem( Item* item );
+    void ChangeItemProto( Item* item, ProtoItem* proto );
 
     void EraseItemHolder( Item* item );
     void MoveItem( Item* item, uint count, Critter* to_cr );
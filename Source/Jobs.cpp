@@ -2,16 +2,58 @@
 
 #include "Critter.h"
 #include "Jobs.h"
+#include "Log.h"
 #include "Mutex.h"
 #include "Map.h"
 #include "Item.h"
 #include "Thread.h"
+#include "Timer.h"
 #include "Vars.h"
 
-static Mutex JobLocker; // Defense code from simultaneously execution
-
 typedef deque<Job> JobDeque;
-static JobDeque Jobs;
+
+// Jobs queue
+// Global queue collects jobs from non-logic threads (network, main loop),
+// every logic thread owns local queue and steals from others when idle
+struct JobQueue
+{
+    Mutex         Locker;
+    JobDeque      Jobs;
+    volatile long Size;
+    uint          OwnerId;
+
+    // Statistics, changed only by owner
+    uint          LocalCount;
+    uint          GlobalCount;
+    uint          StolenCount;
+    uint          StealFails;
+
+    JobQueue() : Size( 0 ), OwnerId( 0 ), LocalCount( 0 ), GlobalCount( 0 ), StolenCount( 0 ), StealFails( 0 ) {}
+};
+
+static JobQueue         GlobalQueue;
+static JobQueue*        LocalQueues[JOB_MAX_THREADS];
+static volatile long    LocalQueuesCount = 0;
+static Mutex            LocalQueuesLocker; // Registration and erasing
+static THREAD JobQueue* CurQueue = NULL;
+static volatile long    JobsCount = 0;
+
+// Scheduled jobs
+struct WheelEntry
+{
+    Job  ScheduledJob;
+    uint Tick;
+};
+typedef list<WheelEntry>                      WheelSlot;
+typedef pair<WheelSlot*, WheelSlot::iterator> WheelPos;
+typedef map<void*, WheelPos>                  WheelPosMap;
+
+static WheelSlot   Wheel[JOB_WHEEL_LEVELS][JOB_WHEEL_SLOTS];
+static WheelPosMap WheelIndex;
+static set<void*>  WheelWakeRequests; // Wake arrived while job was out of wheel
+static uint        WheelTime = 0;     // In resolution units
+static bool        WheelStarted = false;
+static Mutex       WheelLocker;
 
 Job::Job() : Type( JOB_NOP ),
     Data( NULL ),
@@ -26,84 +68,444 @@ Job::Job( int type, void* data, bool cur_thread ) : Type( type ),
         ThreadId = Thread::GetCurrentId();
 }
 
-void Job::PushBack( int type )
+static JobQueue* GetPushQueue( const Job& job )
 {
-    SCOPE_LOCK( JobLocker );
+    if( CurQueue && ( !job.ThreadId || job.ThreadId == CurQueue->OwnerId ) )
+        return CurQueue;
 
-    Jobs.push_back( Job( type, NULL, 0 ) );
+    // Thread owned job from other thread
+    if( job.ThreadId )
+    {
+        for( long i = 0, j = LocalQueuesCount; i < j; i++ )
+            if( LocalQueues[i]->OwnerId == job.ThreadId )
+                return LocalQueues[i];
+    }
+    return &GlobalQueue;
 }
 
-void Job::PushBack( int type, void* data )
+static void PushToQueue( JobQueue* queue, const Job& job, bool front )
+{
+    queue->Locker.Lock();
+    if( front )
+        queue->Jobs.push_front( job );
+    else
+        queue->Jobs.push_back( job );
+    InterlockedIncrement( &queue->Size );
+    queue->Locker.Unlock();
+}
+
+void Job::PushBack( int type )
 {
-    SCOPE_LOCK( JobLocker );
+    PushBack( Job( type, NULL, false ) );
+}
 
-    Jobs.push_back( Job( type, data, 0 ) );
+void Job::PushBack( int type, void* data )
+{
+    PushBack( Job( type, data, false ) );
 }
 
 uint Job::PushBack( const Job& job )
 {
-    SCOPE_LOCK( JobLocker );
-
-    Jobs.push_back( job );
-    uint size = (uint)Jobs.size();
-    return size;
+    PushToQueue( GetPushQueue( job ), job, false );
+    return (uint)InterlockedIncrement( &JobsCount );
 }
 
 void Job::PushFront( const Job& job )
 {
-    SCOPE_LOCK( JobLocker );
+    PushToQueue( GetPushQueue( job ), job, true );
+    InterlockedIncrement( &JobsCount );
+}
 
-    Jobs.push_front( job );
+static bool PopGlobal( Job& job, uint tid )
+{
+    SCOPE_LOCK( GlobalQueue.Locker );
+
+    for( auto it = GlobalQueue.Jobs.begin(), end = GlobalQueue.Jobs.end(); it != end; ++it )
+    {
+        if( !it->ThreadId || it->ThreadId == tid )
+        {
+            job = *it;
+            GlobalQueue.Jobs.erase( it );
+            InterlockedDecrement( &GlobalQueue.Size );
+            return true;
+        }
+    }
+    return false;
 }
 
-Job Job::PopFront()
+static bool PopLocal( JobQueue* queue, Job& job )
 {
-    SCOPE_LOCK( JobLocker );
+    SCOPE_LOCK( queue->Locker );
+
+    if( queue->Jobs.empty() )
+        return false;
 
-    if( Jobs.empty() )
-        return Job( JOB_NOP, NULL, false );
+    job = queue->Jobs.front();
+    queue->Jobs.pop_front();
+    InterlockedDecrement( &queue->Size );
+    return true;
+}
+
+// Take up to count not owned jobs from back of victim queue
+static uint StealJobs( JobQueue* victim, JobDeque& stolen, uint count )
+{
+    SCOPE_LOCK( victim->Locker );
 
-    Job job = Jobs.front();
+    uint result = 0;
+    for( auto it = victim->Jobs.end(); it != victim->Jobs.begin() && result < count;)
+    {
+        --it;
+        if( !it->ThreadId )
+        {
+            stolen.push_back( *it );
+            it = victim->Jobs.erase( it );
+            InterlockedDecrement( &victim->Size );
+            result++;
+        }
+    }
+    return result;
+}
 
-    // Check owner
+Job Job::PopFront()
+{
+    Job  job;
     uint tid = Thread::GetCurrentId();
-    if( job.ThreadId && job.ThreadId != tid )
+
+    // Not logic thread
+    JobQueue* queue = CurQueue;
+    if( !queue )
     {
-        for( auto it = Jobs.begin() + 1; it != Jobs.end(); ++it )
+        if( PopGlobal( job, tid ) )
+            InterlockedDecrement( &JobsCount );
+        return job;
+    }
+
+    // Injected jobs first, they must not wait whole cycle
+    if( InterlockedCompareExchange( &GlobalQueue.Size, 0, 0 ) && PopGlobal( job, tid ) )
+    {
+        queue->GlobalCount++;
+        InterlockedDecrement( &JobsCount );
+        return job;
+    }
+
+    // Own jobs
+    if( PopLocal( queue, job ) )
+    {
+        queue->LocalCount++;
+        InterlockedDecrement( &JobsCount );
+        return job;
+    }
+
+    // Steal from others
+    long count = LocalQueuesCount;
+    long index = 0;
+    for( ; index < count; index++ )
+        if( LocalQueues[index] == queue )
+            break;
+    for( long i = 1; i < count; i++ )
+    {
+        JobQueue* victim = LocalQueues[(index + i) % count];
+        if( !InterlockedCompareExchange( &victim->Size, 0, 0 ) )
+            continue;
+
+        JobDeque stolen;
+        if( StealJobs( victim, stolen, 1 ) )
         {
-            Job& job_ = *it;
-            if( !job_.ThreadId || job_.ThreadId == tid )
-            {
-                Job job__ = job_;
-                Jobs.erase( it );
-                return job__;
-            }
+            queue->StolenCount++;
+            InterlockedDecrement( &JobsCount );
+            return stolen.front();
         }
-        return Job( JOB_NOP, NULL, false );
     }
 
-    Jobs.pop_front();
+    queue->StealFails++;
     return job;
 }
 
 void Job::Erase( int type )
 {
-    SCOPE_LOCK( JobLocker );
-
-    for( auto it = Jobs.begin(); it != Jobs.end();)
+    WheelLocker.Lock();
+    for( auto it = WheelIndex.begin(); it != WheelIndex.end();)
     {
-        Job& job = *it;
-        if( job.Type == type )
-            it = Jobs.erase( it );
+        WheelPos& pos = it->second;
+        if( pos.second->ScheduledJob.Type == type )
+        {
+            pos.first->erase( pos.second );
+            it = WheelIndex.erase( it );
+        }
         else
             ++it;
     }
+    WheelLocker.Unlock();
+
+    SCOPE_LOCK( LocalQueuesLocker );
+
+    for( long i = -1; i < LocalQueuesCount; i++ )
+    {
+        JobQueue* queue = (i == -1 ? &GlobalQueue : LocalQueues[i]);
+        SCOPE_LOCK( queue->Locker );
+
+        for( auto it = queue->Jobs.begin(); it != queue->Jobs.end();)
+        {
+            Job& job = *it;
+            if( job.Type == type )
+            {
+                it = queue->Jobs.erase( it );
+                InterlockedDecrement( &queue->Size );
+                InterlockedDecrement( &JobsCount );
+            }
+            else
+                ++it;
+        }
+    }
 }
 
 uint Job::Count()
 {
-    SCOPE_LOCK( JobLocker );
-    uint count = (uint)Jobs.size();
+    return (uint)InterlockedCompareExchange( &JobsCount, 0, 0 );
+}
+
+void Job::InitThread()
+{
+    SCOPE_LOCK( LocalQueuesLocker );
+
+    if( CurQueue )
+        return;
+
+    // Reuse queue of finished thread
+    uint tid = Thread::GetCurrentId();
+    for( long i = 0; i < LocalQueuesCount; i++ )
+    {
+        if( !LocalQueues[i]->OwnerId )
+        {
+            CurQueue = LocalQueues[i];
+            CurQueue->OwnerId = tid;
+            return;
+        }
+    }
+
+    if( LocalQueuesCount >= JOB_MAX_THREADS )
+    {
+        WriteLogF( _FUNC_, " - Too many logic threads, max<%u>, thread works with global queue.\n", JOB_MAX_THREADS );
+        return;
+    }
+
+    CurQueue = new JobQueue();
+    CurQueue->OwnerId = tid;
+    LocalQueues[LocalQueuesCount] = CurQueue;
+    InterlockedIncrement( &LocalQueuesCount );
+}
+
+void Job::FinishThread()
+{
+    SCOPE_LOCK( LocalQueuesLocker );
+
+    JobQueue* queue = CurQueue;
+    if( !queue )
+        return;
+    CurQueue = NULL;
+
+    // Give rest of jobs to other threads, except owned by this thread
+    queue->Locker.Lock();
+    JobDeque jobs;
+    jobs.swap( queue->Jobs );
+    InterlockedExchange( &queue->Size, 0 );
+    queue->OwnerId = 0;
+    queue->Locker.Unlock();
+
+    for( auto it = jobs.begin(), end = jobs.end(); it != end; ++it )
+    {
+        if( !it->ThreadId )
+            PushToQueue( &GlobalQueue, *it, false );
+        else
+            InterlockedDecrement( &JobsCount );
+    }
+}
+
+void Job::BalanceThread()
+{
+    JobQueue* queue = CurQueue;
+    if( !queue )
+        return;
+
+    // Find most loaded thread
+    long      count = LocalQueuesCount;
+    long      total = 0;
+    long      active = 0;
+    JobQueue* victim = NULL;
+    long      victim_size = 0;
+    for( long i = 0; i < count; i++ )
+    {
+        JobQueue* q = LocalQueues[i];
+        if( !q->OwnerId )
+            continue;
+
+        long size = InterlockedCompareExchange( &q->Size, 0, 0 );
+        total += size;
+        active++;
+        if( q != queue && size > victim_size )
+        {
+            victim = q;
+            victim_size = size;
+        }
+    }
+    if( !victim || active < 2 )
+        return;
+
+    // Take half of difference to average
+    long size = InterlockedCompareExchange( &queue->Size, 0, 0 );
+    long average = total / active;
+    if( size + 1 >= average )
+        return;
+
+    JobDeque stolen;
+    uint     stolen_count = StealJobs( victim, stolen, (uint)( (average - size + 1) / 2 ) );
+    if( !stolen_count )
+        return;
+
+    queue->Locker.Lock();
+    queue->Jobs.insert( queue->Jobs.end(), stolen.begin(), stolen.end() );
+    InterlockedExchangeAdd( &queue->Size, (long)stolen_count );
+    queue->Locker.Unlock();
+    queue->StolenCount += stolen_count;
+}
+
+void Job::GetStatistics( uint& local, uint& global, uint& stolen, uint& steal_fails )
+{
+    local = global = stolen = steal_fails = 0;
+    for( long i = 0, j = LocalQueuesCount; i < j; i++ )
+    {
+        JobQueue* queue = LocalQueues[i];
+        local += queue->LocalCount;
+        global += queue->GlobalCount;
+        stolen += queue->StolenCount;
+        steal_fails += queue->StealFails;
+    }
+}
+
+static void WheelInsert( const WheelEntry& entry )
+{
+    uint time = entry.Tick / JOB_WHEEL_RESOLUTION;
+    if( time <= WheelTime )
+        time = WheelTime + 1;
+
+    // Find level, clamp far events to last one
+    uint delta = time - WheelTime;
+    uint level = 0;
+    while( level < JOB_WHEEL_LEVELS - 1 && delta >= (1U << ( (level + 1) * JOB_WHEEL_SLOT_BITS ) ) )
+        level++;
+    if( delta >= (1U << (JOB_WHEEL_LEVELS * JOB_WHEEL_SLOT_BITS) ) )
+        time = WheelTime + (1U << (JOB_WHEEL_LEVELS * JOB_WHEEL_SLOT_BITS) ) - 1;
+
+    WheelSlot& slot = Wheel[level][(time >> (level * JOB_WHEEL_SLOT_BITS) ) & (JOB_WHEEL_SLOTS - 1)];
+    slot.push_back( entry );
+    WheelIndex[entry.ScheduledJob.Data] = WheelPos( &slot, --slot.end() );
+}
+
+void Job::Schedule( const Job& job, uint tick )
+{
+    SCOPE_LOCK( WheelLocker );
+
+    if( !WheelStarted )
+    {
+        WheelTime = Timer::GameTick() / JOB_WHEEL_RESOLUTION;
+        WheelStarted = true;
+    }
+
+    // Woken during processing
+    if( job.Data && WheelWakeRequests.count( job.Data ) )
+    {
+        WheelWakeRequests.erase( job.Data );
+        PushBack( job );
+        return;
+    }
+
+    WheelEntry entry;
+    entry.ScheduledJob = job;
+    entry.Tick = tick;
+    WheelInsert( entry );
+}
+
+void Job::Wake( void* data )
+{
+    SCOPE_LOCK( WheelLocker );
+
+    auto it = WheelIndex.find( data );
+    if( it == WheelIndex.end() )
+    {
+        WheelWakeRequests.insert( data );
+        return;
+    }
+
+    WheelPos& pos = it->second;
+    Job       job = pos.second->ScheduledJob;
+    pos.first->erase( pos.second );
+    WheelIndex.erase( it );
+    PushBack( job );
+}
+
+void Job::Unschedule( void* data )
+{
+    SCOPE_LOCK( WheelLocker );
+
+    WheelWakeRequests.erase( data );
+    auto it = WheelIndex.find( data );
+    if( it != WheelIndex.end() )
+    {
+        it->second.first->erase( it->second.second );
+        WheelIndex.erase( it );
+    }
+}
+
+void Job::ProcessScheduled()
+{
+    if( !WheelLocker.TryLock() )
+        return;
+
+    uint now = Timer::GameTick() / JOB_WHEEL_RESOLUTION;
+    if( !WheelStarted )
+    {
+        WheelTime = now;
+        WheelStarted = true;
+    }
+
+    JobDeque due;
+    while( (int)( now - WheelTime ) > 0 )
+    {
+        WheelTime++;
+
+        // Cascade upper levels into lower ones
+        for( uint level = 1; level < JOB_WHEEL_LEVELS; level++ )
+        {
+            uint shift = (level * JOB_WHEEL_SLOT_BITS);
+            if( WheelTime & ( (1U << shift) - 1 ) )
+                break;
+
+            WheelSlot& slot = Wheel[level][(WheelTime >> shift) & (JOB_WHEEL_SLOTS - 1)];
+            WheelSlot  entries;
+            entries.swap( slot );
+            for( auto it = entries.begin(), end = entries.end(); it != end; ++it )
+                WheelInsert( *it );
+        }
+
+        WheelSlot& slot = Wheel[0][WheelTime & (JOB_WHEEL_SLOTS - 1)];
+        for( auto it = slot.begin(), end = slot.end(); it != end; ++it )
+        {
+            due.push_back( it->ScheduledJob );
+            WheelIndex.erase( it->ScheduledJob.Data );
+        }
+        slot.clear();
+    }
+
+    WheelLocker.Unlock();
+
+    for( auto it = due.begin(), end = due.end(); it != end; ++it )
+        PushBack( *it );
+}
+
+uint Job::ScheduledCount()
+{
+    SCOPE_LOCK( WheelLocker );
+    uint count = (uint)WheelIndex.size();
     return count;
 }
 
@@ -123,6 +525,8 @@ static Mutex      DeferredReleaseLocker;
 
 void Job::DeferredRelease( Critter* cr )
 {
+    Unschedule( cr );
+
     SCOPE_LOCK( DeferredReleaseLocker );
 
     DeferredReleaseCritters.push_back( cr );
@@ -131,6 +535,8 @@ void Job::DeferredRelease( Critter* cr )
 
 void Job::DeferredRelease( Map* map )
 {
+    Unschedule( map );
+
     SCOPE_LOCK( DeferredReleaseLocker );
 
     DeferredReleaseMaps.push_back( map );
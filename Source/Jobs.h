@@ -21,6 +21,15 @@
 #define JOB_THREAD_FINISH         (16)
 #define JOB_COUNT                 (17)
 
+// Maximum logic threads with own job queue
+#define JOB_MAX_THREADS           (64)
+
+// Scheduled jobs timing wheel, three levels of 64 slots, 16ms resolution (~71 minutes range)
+#define JOB_WHEEL_LEVELS          (3)
+#define JOB_WHEEL_SLOTS           (64)
+#define JOB_WHEEL_SLOT_BITS       (6)
+#define JOB_WHEEL_RESOLUTION      (16)
+
 class Critter;
 class Map;
 class Location;
@@ -45,6 +54,19 @@ public:
     static void Erase( int type );
     static uint Count();
 
+    // Work-stealing, per thread queues
+    static void InitThread();
+    static void FinishThread();
+    static void BalanceThread();
+    static void GetStatistics( uint& local, uint& global, uint& stolen, uint& steal_fails );
+
+    // Scheduled jobs, game tick based
+    static void Schedule( const Job& job, uint tick );
+    static void Wake( void* data );
+    static void Unschedule( void* data );
+    static void ProcessScheduled();
+    static uint ScheduledCount();
+
     // Deferred releasing
     static void DeferredRelease( Critter* cr );
     static void DeferredRelease( Map* cr );
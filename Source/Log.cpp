@@ -13,10 +13,13 @@
 # include "FL/Fl_Text_Display.H"
 #endif
 
+#define LOG_QUEUE_SIZE         (8192)             // Power of two
+#define LOG_QUEUE_MAX_BYTES    (16 * 1024 * 1024)
+
 Mutex              LogLocker;
 void*              LogFileHandle = NULL;
 vector<LogFuncPtr> LogFunctions;
-bool               LogFunctionsInProcess = false;
+THREAD bool        LogFunctionsInProcess = false;
 void*              LogTextBox = NULL;
 string*            LogBufferStr = NULL;
 bool               ToDebugOutput = false;
@@ -24,12 +27,38 @@ bool               LoggingWithTime = false;
 bool               LoggingWithThread = false;
 uint               StartLogTime = 0;
 
+// Asynchronous logging
+// Bounded multi producer queue, consumed by writer thread or any thread who holds LogLocker
+struct LogQueueSlot
+{
+    volatile long Sequence;
+    char*         Str;
+};
+LogQueueSlot  LogQueue[LOG_QUEUE_SIZE];
+volatile long LogQueueHead = 0;
+long          LogQueueTail = 0;
+volatile long LogQueueBytes = 0;
+volatile long LogDropped = 0;
+volatile bool LoggingAsync = false;
+#if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+Thread        LogWriterThread;
+#endif
+MutexEvent    LogWriterEvent;
+volatile long LogWriterWaiting = 0;
+volatile bool LogWriterStop = false;
+
 void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_list& list );
+void LogOutput( const char* str );
+void LogEnqueue( const char* str );
+bool LogQueueEmpty();
+void LogDrain();
+void LogWriter( void* );
 
 void LogToFile( const char* fname )
 {
     SCOPE_LOCK( LogLocker );
 
+    LogDrain();
     if( LogFileHandle )
         FileClose( LogFileHandle );
     LogFileHandle = NULL;
@@ -67,6 +96,7 @@ void LogToBuffer( bool enable )
 {
     SCOPE_LOCK( LogLocker );
 
+    LogDrain();
     SAFEDEL( LogBufferStr );
     if( enable )
     {
@@ -84,6 +114,8 @@ void LogToDebugOutput( bool enable )
 
 void LogFinish()
 {
+    LogAsync( false );
+
     SCOPE_LOCK( LogLocker );
 
     LogToFile( NULL );
@@ -119,8 +151,6 @@ void WriteLogX( const char* frmt, ... )
 
 void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_list& list )
 {
-    SCOPE_LOCK( LogLocker );
-
     if( LogFunctionsInProcess )
         return;
 
@@ -172,6 +202,21 @@ void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_lis
     vsnprintf( &str[len], MAX_LOGTEXT - len, frmt, list );
     str[MAX_LOGTEXT - 1] = 0;
 
+    if( LoggingAsync )
+    {
+        LogEnqueue( str );
+        return;
+    }
+
+    SCOPE_LOCK( LogLocker );
+
+    LogDrain();
+    LogOutput( str );
+}
+
+void LogOutput( const char* str )
+{
+    // Invoked in locked scope
     if( LogFileHandle )
     {
         FileWrite( LogFileHandle, str, Str::Length( str ) );
@@ -203,6 +248,170 @@ void WriteLogInternal( bool prefixes, const char* func, const char* frmt, va_lis
     }
 }
 
+void LogEnqueue( const char* str )
+{
+    uint len = Str::Length( str );
+    if( InterlockedExchangeAdd( &LogQueueBytes, (long)len ) + (long)len > LOG_QUEUE_MAX_BYTES )
+    {
+        InterlockedExchangeAdd( &LogQueueBytes, -(long)len );
+        InterlockedIncrement( &LogDropped );
+        return;
+    }
+
+    // Reserve slot
+    long          pos = LogQueueHead;
+    LogQueueSlot* slot;
+    while( true )
+    {
+        slot = &LogQueue[pos & (LOG_QUEUE_SIZE - 1)];
+        long diff = slot->Sequence - pos;
+        if( diff == 0 )
+        {
+            long prev = InterlockedCompareExchange( &LogQueueHead, pos + 1, pos );
+            if( prev == pos )
+                break;
+            pos = prev;
+        }
+        else if( diff < 0 )
+        {
+            // Full
+            InterlockedExchangeAdd( &LogQueueBytes, -(long)len );
+            InterlockedIncrement( &LogDropped );
+            return;
+        }
+        else
+        {
+            pos = LogQueueHead;
+        }
+    }
+
+    // Publish
+    slot->Str = (char*)malloc( len + 1 );
+    if( slot->Str )
+    {
+        memcpy( slot->Str, str, len + 1 );
+    }
+    else
+    {
+        InterlockedExchangeAdd( &LogQueueBytes, -(long)len );
+        InterlockedIncrement( &LogDropped );
+    }
+    InterlockedExchange( &slot->Sequence, pos + 1 );
+
+    // Wake up writer
+    if( InterlockedCompareExchange( &LogWriterWaiting, 0, 1 ) == 1 )
+        LogWriterEvent.Allow();
+}
+
+bool LogQueueEmpty()
+{
+    LogQueueSlot* slot = &LogQueue[LogQueueTail & (LOG_QUEUE_SIZE - 1)];
+    return slot->Sequence - (LogQueueTail + 1) < 0;
+}
+
+void LogDrain()
+{
+    // Invoked in locked scope
+    while( !LogQueueEmpty() )
+    {
+        LogQueueSlot* slot = &LogQueue[LogQueueTail & (LOG_QUEUE_SIZE - 1)];
+        char*         str = slot->Str;
+        slot->Str = NULL;
+        InterlockedExchange( &slot->Sequence, LogQueueTail + LOG_QUEUE_SIZE );
+        LogQueueTail++;
+
+        if( str )
+        {
+            InterlockedExchangeAdd( &LogQueueBytes, -(long)Str::Length( str ) );
+            LogOutput( str );
+            free( str );
+        }
+    }
+
+    long dropped = InterlockedExchange( &LogDropped, 0 );
+    if( dropped )
+    {
+        char str[MAX_FOTEXT];
+        Str::Format( str, "Log queue overflow, dropped<%d> messages.\n", dropped );
+        LogOutput( str );
+    }
+}
+
+void LogWriter( void* )
+{
+    while( true )
+    {
+        LogWriterEvent.Disallow();
+        InterlockedExchange( &LogWriterWaiting, 1 );
+        if( LogQueueEmpty() && !LogDropped )
+        {
+            if( LogWriterStop )
+                break;
+            LogWriterEvent.Wait();
+        }
+        InterlockedExchange( &LogWriterWaiting, 0 );
+
+        LogLocker.Lock();
+        LogDrain();
+        LogLocker.Unlock();
+    }
+    InterlockedExchange( &LogWriterWaiting, 0 );
+}
+
+void LogAsync( bool enable )
+{
+    #if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+    if( enable == LoggingAsync )
+        return;
+
+    if( enable )
+    {
+        static bool queue_initialized = false;
+        if( !queue_initialized )
+        {
+            for( long i = 0; i < LOG_QUEUE_SIZE; i++ )
+                LogQueue[i].Sequence = i;
+            queue_initialized = true;
+        }
+        LogWriterStop = false;
+        LoggingAsync = true;
+        LogWriterThread.Start( LogWriter, "LogWriter" );
+    }
+    else
+    {
+        LoggingAsync = false;
+        LogWriterStop = true;
+        LogWriterEvent.Allow();
+        LogWriterThread.Wait();
+        LogFlush();
+    }
+    #endif
+}
+
+void LogFlush()
+{
+    SCOPE_LOCK( LogLocker );
+
+    LogDrain();
+}
+
+void LogFlushOnCrash()
+{
+    // Lock may be held by crashed thread, so give up after some time
+    for( int i = 0; i < 100; i++ )
+    {
+        if( LogLocker.TryLock() )
+        {
+            LogDrain();
+            LogLocker.Unlock();
+            return;
+        }
+        #if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+        Thread::Sleep( 10 );
+        #endif
+    }
+}
+
 void LogWithTime( bool enable )
 {
     SCOPE_LOCK( LogLocker );
@@ -221,6 +430,7 @@ void LogGetBuffer( std::string& buf )
 {
     SCOPE_LOCK( LogLocker );
 
+    LogDrain();
     if( LogBufferStr )
     {
         buf = *LogBufferStr;
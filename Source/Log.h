@@ -24,5 +24,8 @@ void LogFinish();                                   // Finish all logging
 void LogWithTime( bool enable );                    // Logging with time
 void LogWithThread( bool enable );                  // Logging with thread name
 void LogGetBuffer( std::string& buf );              // Get buffer, if used LogBuffer
+void LogAsync( bool enable );                       // Write to outputs from separate thread
+void LogFlush();                                    // Write all queued messages
+void LogFlushOnCrash();                             // Same, but not wait for lock forever
 
 #endif // __LOG__
@@ -121,6 +121,7 @@ int main( int argc, char** argv )
     // Logging
     LogWithTime( ConfigFile->GetBool( SECTION_SERVER, "LoggingTime", true ) );
     LogWithThread( ConfigFile->GetBool( SECTION_SERVER, "LoggingThread", true ) );
+    LogAsync( ConfigFile->GetBool( SECTION_SERVER, "LoggingAsync", true ) );
     if( CommandLine->IsOption( "LoggingDebugOutput" ) || ConfigFile->GetBool( SECTION_SERVER, "LoggingDebugOutput", false ) )
         LogToDebugOutput( true );
 
@@ -176,6 +177,16 @@ int main( int argc, char** argv )
         # endif
     }
 
+    // Offline maps binary cache compilation, server is not started
+    if( CommandLine->IsOption( "CompileMaps" ) )
+    {
+        LogToFile( "./FOnlineServerMaps.log" );
+        WriteLog( "FOClassic server (%s), maps compilation\n", FOCLASSIC_VERSION_LOGSTRING );
+        bool compiled = Server.CompileMaps();
+        LogFinish();
+        return compiled ? 0 : 1;
+    }
+
     // GUI
     if( !Singleplayer || CommandLine->IsOption( "ShowUI" ) )
     {
@@ -422,6 +433,7 @@ void GUICallback( Fl_Widget* widget, void* data )
 {
     if( widget == GuiWindow )
     {
+        LogFlush();
         ExitProcess( 0 );
     }
     else if( widget == GuiBtnRlClScript )
@@ -1003,6 +1015,7 @@ int main( int argc, char** argv )
     // Logging
     LogWithTime( ConfigFile->GetBool( SECTION_SERVER, "LoggingTime", true ) );
     LogWithThread( ConfigFile->GetBool( SECTION_SERVER, "LoggingThread", true ) );
+    LogAsync( ConfigFile->GetBool( SECTION_SERVER, "LoggingAsync", true ) );
     LogToDebugOutput( CommandLine->IsOption( "LoggingDebugOutput" ) || ConfigFile->GetBool( "LoggingDebugOutput", false ) );
     LogToFile( "./FOnlineServerDaemon.log" );
 
@@ -1043,6 +1056,7 @@ void GameLoopThread( void* )
     {
         WriteLog( "Initialization fail!\n" );
     }
+    LogFlush();
 }
 
 #endif // SERVER_DAEMON
@@ -1295,6 +1309,7 @@ void AdminWork( void* session_ )
         else if( Str::CompareCase( cmd, "kill" ) )
         {
             ADMIN_LOG( "Kill whole process.\n" );
+            LogFlush();
             ExitProcess( 0 );
         }
         else if( Str::CompareCaseCount( cmd, "log ", 4 ) )
@@ -36,13 +36,14 @@ const char* MapEventFuncName[MAP_EVENT_MAX] =
 /* Map                                                                  */
 /************************************************************************/
 
-Map::Map() : RefCounter( 1 ), IsNotValid( false ), hexFlags( NULL ),
-    mapLocation( NULL ), Proto( NULL ), NeedProcess( false ),
+Map::Map() : RefCounter( 1 ), IsNotValid( false ), hexFlags( NULL ), hexBlockersVersion( 0 ),
+    mapLocation( NULL ), crittersGridWidth( 0 ), crittersGridMultihex( 0 ), Proto( NULL ), NeedProcess( false ),
     IsTurnBasedOn( false ), TurnBasedEndTick( 0 ), TurnSequenceCur( 0 ),
     IsTurnBasedTimeout( false ), TurnBasedBeginSecond( 0 ), NeedEndTurnBased( false ),
     TurnBasedRound( 0 ), TurnBasedTurn( 0 ), TurnBasedWholeTurn( 0 )
 {
     MEMORY_PROCESS( MEMORY_MAP, sizeof(Map) );
+    Sync.SetType( SYNC_OBJECT_MAP );
     memzero( &Data, sizeof(Data) );
     memzero( FuncId, sizeof(FuncId) );
     memzero( LoopEnabled, sizeof(LoopEnabled) );
@@ -67,6 +68,8 @@ bool Map::Init( ProtoMap* proto, Location* location )
     if( !hexFlags )
         return false;
     memzero( hexFlags, proto->Header.MaxHexX * proto->Header.MaxHexY );
+    crittersGridWidth = proto->Header.MaxHexX / MAP_CRITTERS_GRID_CELL + 1;
+    crittersGrid.resize( crittersGridWidth * (proto->Header.MaxHexY / MAP_CRITTERS_GRID_CELL + 1) );
     memzero( &Data, sizeof(Data) );
     Proto = proto;
     mapLocation = location;
@@ -101,6 +104,9 @@ void Map::Clear( bool full )
 
     ItemPtrVec del_items = hexItems;
     hexItems.clear();
+    hexItemsIndex.clear();
+    hexItemsByHex.clear();
+    hexItemsByPid.clear();
 
     dataLocker.Unlock();
 
@@ -458,6 +464,28 @@ void Map::Process()
     }
 }
 
+uint Map::GetNextProcessTick()
+{
+    if( IsTurnBasedOn )
+        return 0;
+
+    // Loops changes wakes map, check it occasionally anyway
+    uint tick = Timer::GameTick();
+    uint next_tick = tick + MAP_MAX_SLEEP_TICK;
+    if( NeedProcess )
+    {
+        for( int i = 0; i < MAP_LOOP_FUNC_MAX; i++ )
+        {
+            if( !LoopEnabled[i] )
+                continue;
+            if( tick - LoopLastTick[i] >= LoopWaitTick[i] )
+                return 0;
+            next_tick = MIN( next_tick, LoopLastTick[i] + LoopWaitTick[i] );
+        }
+    }
+    return next_tick;
+}
+
 Location* Map::GetLocation( bool lock )
 {
     if( lock )
@@ -568,8 +596,14 @@ void Map::AddCritter( Critter* cr )
         mapCritters.push_back( cr );
 
         cr->SetMaps( GetId(), GetPid() );
+
+        cr->GridCell = -1;
+        cr->GridVisRadius = cr->GetLook();
+        crittersGridVisRadius.insert( cr->GridVisRadius );
     }
 
+    SetCritterGrid( cr, cr->GridVisRadius );
+
     SetFlagCritter( cr->GetHexX(), cr->GetHexY(), cr->GetMultihex(), cr->IsDead() );
     cr->SetTimeout( TO_BATTLE, IsTurnBasedOn ? TB_BATTLE_TIMEOUT : 0 );
 }
@@ -608,7 +642,10 @@ void Map::EraseCritter( Critter* cr )
 
         auto it = std::find( mapCritters.begin(), mapCritters.end(), cr );
         if( it != mapCritters.end() )
+        {
             mapCritters.erase( it );
+            EraseCritterGrid( cr );
+        }
     }
 
     cr->SetTimeout( TO_BATTLE, 0 );
@@ -616,6 +653,105 @@ void Map::EraseCritter( Critter* cr )
     MapMngr.RunGarbager();
 }
 
+void Map::EraseCritterGrid( Critter* cr )
+{
+    // Invoked in locked scope
+
+    if( cr->GridCell >= 0 )
+    {
+        CrVec& cell = crittersGrid[cr->GridCell];
+        auto   it = std::find( cell.begin(), cell.end(), cr );
+        if( it != cell.end() )
+            cell.erase( it );
+    }
+    cr->GridCell = MAP_CRITTERS_GRID_NONE;
+
+    auto it = crittersGridVisRadius.find( cr->GridVisRadius );
+    if( it != crittersGridVisRadius.end() )
+        crittersGridVisRadius.erase( it );
+}
+
+void Map::SetCritterGrid( Critter* cr, uint vis_radius )
+{
+    SCOPE_LOCK( dataLocker );
+
+    // Not on this map
+    if( cr->GridCell == MAP_CRITTERS_GRID_NONE || cr->GetMap() != GetId() )
+        return;
+
+    SetCritterGridVisRadius( cr, vis_radius );
+
+    // Cell
+    ushort hx = MIN( cr->GetHexX(), GetMaxHexX() - 1 );
+    ushort hy = MIN( cr->GetHexY(), GetMaxHexY() - 1 );
+    int    cell = (hy / MAP_CRITTERS_GRID_CELL) * crittersGridWidth + hx / MAP_CRITTERS_GRID_CELL;
+    if( cell != cr->GridCell )
+    {
+        if( cr->GridCell >= 0 )
+        {
+            CrVec& old_cell = crittersGrid[cr->GridCell];
+            auto   it = std::find( old_cell.begin(), old_cell.end(), cr );
+            if( it != old_cell.end() )
+                old_cell.erase( it );
+        }
+        crittersGrid[cell].push_back( cr );
+        cr->GridCell = cell;
+    }
+    cr->GridHexX = cr->GetHexX();
+    cr->GridHexY = cr->GetHexY();
+
+    uint multihex = cr->GetMultihex();
+    if( multihex > crittersGridMultihex )
+        crittersGridMultihex = multihex;
+}
+
+void Map::SetCritterGridVisRadius( Critter* cr, uint vis_radius )
+{
+    SCOPE_LOCK( dataLocker );
+
+    if( cr->GridCell == MAP_CRITTERS_GRID_NONE || cr->GetMap() != GetId() || vis_radius == cr->GridVisRadius )
+        return;
+
+    auto it = crittersGridVisRadius.find( cr->GridVisRadius );
+    if( it != crittersGridVisRadius.end() )
+        crittersGridVisRadius.erase( it );
+    crittersGridVisRadius.insert( vis_radius );
+    cr->GridVisRadius = vis_radius;
+}
+
+void Map::GetCrittersGrid( ushort hx, ushort hy, uint radius, CrVec& critters, bool sync_lock )
+{
+    // Hex distance not less than coordinates difference, so square of cells covers radius
+    int min_cx = MAX( (int)hx - (int)radius, 0 ) / MAP_CRITTERS_GRID_CELL;
+    int min_cy = MAX( (int)hy - (int)radius, 0 ) / MAP_CRITTERS_GRID_CELL;
+    int max_cx = MIN( (int)hx + (int)radius, GetMaxHexX() - 1 ) / MAP_CRITTERS_GRID_CELL;
+    int max_cy = MIN( (int)hy + (int)radius, GetMaxHexY() - 1 ) / MAP_CRITTERS_GRID_CELL;
+    uint count = (uint)critters.size();
+
+    dataLocker.Lock();
+    for( int cy = min_cy; cy <= max_cy; cy++ )
+    {
+        for( int cx = min_cx; cx <= max_cx; cx++ )
+        {
+            CrVec& cell = crittersGrid[cy * crittersGridWidth + cx];
+            critters.insert( critters.end(), cell.begin(), cell.end() );
+        }
+    }
+    dataLocker.Unlock();
+
+    if( sync_lock && LogicMT )
+        for( uint i = count, j = (uint)critters.size(); i < j; i++ )
+            SYNC_LOCK( critters[i] );
+}
+
+uint Map::GetCrittersGridVisRadius()
+{
+    SCOPE_LOCK( dataLocker );
+
+    uint radius = (crittersGridVisRadius.empty() ? 0 : *crittersGridVisRadius.rbegin() );
+    return radius;
+}
+
 void Map::EraseCritterEvents( Critter* cr )
 {
     cr->LockMapTransfers++;
@@ -710,8 +846,12 @@ void Map::SetItem( Item* item, ushort hx, ushort hy )
     item->AccHex.MapId = GetId();
     item->AccHex.HexX = hx;
     item->AccHex.HexY = hy;
+    item->IsSaveChanged = true;
 
+    hexItemsIndex[item->GetId()] = (uint)hexItems.size();
     hexItems.push_back( item );
+    hexItemsByHex[(hy << 16) | hx].push_back( item );
+    hexItemsByPid[item->GetProtoId()].push_back( item );
     SetHexFlag( hx, hy, HEX_FLAG_ITEM );
 
     if( !item->IsPassed() )
@@ -737,21 +877,48 @@ void Map::EraseItem( uint item_id )
         return;
     }
 
-    auto it = hexItems.begin();
-    auto end = hexItems.end();
-    for( ; it != end; ++it )
-        if( (*it)->GetId() == item_id )
-            break;
-    if( it == hexItems.end() )
+    auto it = hexItemsIndex.find( item_id );
+    if( it == hexItemsIndex.end() )
         return;
 
-    Item* item = *it;
-    hexItems.erase( it );
+    // Last item takes place of erased one
+    uint  index = (*it).second;
+    Item* item = hexItems[index];
+    hexItemsIndex.erase( it );
+    if( index != hexItems.size() - 1 )
+    {
+        hexItems[index] = hexItems.back();
+        hexItemsIndex[hexItems[index]->GetId()] = index;
+    }
+    hexItems.pop_back();
 
     ushort hx = item->AccHex.HexX;
     ushort hy = item->AccHex.HexY;
 
+    auto it_hex = hexItemsByHex.find( (hy << 16) | hx );
+    if( it_hex != hexItemsByHex.end() )
+    {
+        ItemPtrVec& hex_items = (*it_hex).second;
+        auto        it_ = std::find( hex_items.begin(), hex_items.end(), item );
+        if( it_ != hex_items.end() )
+            hex_items.erase( it_ );
+        if( hex_items.empty() )
+            hexItemsByHex.erase( it_hex );
+    }
+
+    auto it_pid = hexItemsByPid.find( item->GetProtoId() );
+    if( it_pid != hexItemsByPid.end() )
+    {
+        ItemPtrVec& pid_items = (*it_pid).second;
+        auto        it_ = std::find( pid_items.begin(), pid_items.end(), item );
+        if( it_ != pid_items.end() )
+            pid_items.erase( it_ );
+        if( pid_items.empty() )
+            hexItemsByPid.erase( it_pid );
+    }
+
     item->Accessory = 0xd1;
+    item->IsSaveChanged = true;
 
     if( item->IsGeck() )
         mapLocation->GeckCount--;
@@ -891,28 +1058,34 @@ void Map::AnimateItem( Item* item, uchar from_frm, uchar to_frm )
     }
 }
 
+ItemPtrVec* Map::GetHexItemsNoLock( ushort hx, ushort hy )
+{
+    auto it = hexItemsByHex.find( (hy << 16) | hx );
+    return it != hexItemsByHex.end() ? &(*it).second : NULL;
+}
+
 #pragma MESSAGE("Add explicit sync lock.")
 Item* Map::GetItem( uint item_id )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
-    {
-        Item* item = *it;
-        if( item->GetId() == item_id )
-        {
-            SYNC_LOCK( item );
-            return item;
-        }
-    }
-    return NULL;
+    auto it = hexItemsIndex.find( item_id );
+    if( it == hexItemsIndex.end() )
+        return NULL;
+
+    Item* item = hexItems[(*it).second];
+    SYNC_LOCK( item );
+    return item;
 }
 
 Item* Map::GetItemHex( ushort hx, ushort hy, ushort item_pid, Critter* picker )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( !hex_items )
+        return NULL;
+
+    for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
     {
         Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && (item_pid == 0 || item->GetProtoId() == item_pid) &&
-            (!picker || (!item->IsHidden() && picker->CountIdVisItem( item->GetId() ) ) ) )
+        if( (item_pid == 0 || item->GetProtoId() == item_pid) && (!picker || (!item->IsHidden() && picker->CountIdVisItem( item->GetId() ) ) ) )
         {
             SYNC_LOCK( item );
             return item;
@@ -923,10 +1096,14 @@ Item* Map::GetItemHex( ushort hx, ushort hy, ushort item_pid, Critter* picker )
 
 Item* Map::GetItemDoor( ushort hx, ushort hy )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( !hex_items )
+        return NULL;
+
+    for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
     {
         Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && item->IsDoor() )
+        if( item->IsDoor() )
         {
             SYNC_LOCK( item );
             return item;
@@ -937,10 +1114,14 @@ Item* Map::GetItemDoor( ushort hx, ushort hy )
 
 Item* Map::GetItemCar( ushort hx, ushort hy )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( !hex_items )
+        return NULL;
+
+    for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
     {
         Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && item->IsCar() )
+        if( item->IsCar() )
         {
             SYNC_LOCK( item );
             return item;
@@ -951,10 +1132,14 @@ Item* Map::GetItemCar( ushort hx, ushort hy )
 
 Item* Map::GetItemContainer( ushort hx, ushort hy )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( !hex_items )
+        return NULL;
+
+    for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
     {
         Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && item->IsContainer() )
+        if( item->IsContainer() )
         {
             SYNC_LOCK( item );
             return item;
@@ -965,10 +1150,14 @@ Item* Map::GetItemContainer( ushort hx, ushort hy )
 
 Item* Map::GetItemGag( ushort hx, ushort hy )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( !hex_items )
+        return NULL;
+
+    for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
     {
         Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && item->IsGag() )
+        if( item->IsGag() )
         {
             SYNC_LOCK( item );
             return item;
@@ -979,12 +1168,9 @@ Item* Map::GetItemGag( ushort hx, ushort hy )
 
 void Map::GetItemsHex( ushort hx, ushort hy, ItemPtrVec& items, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
-    {
-        Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy )
-            items.push_back( item );
-    }
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( hex_items )
+        items.insert( items.end(), hex_items->begin(), hex_items->end() );
 
     if( lock )
         for( auto it = items.begin(), end = items.end(); it != end; ++it )
@@ -993,11 +1179,59 @@ void Map::GetItemsHex( ushort hx, ushort hy, ItemPtrVec& items, bool lock )
 
 void Map::GetItemsHexEx( ushort hx, ushort hy, uint radius, ushort pid, ItemPtrVec& items, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    // Hex distance not less than coordinates difference, so check rows of square around center
+    int  min_hx = MAX( (int)hx - (int)radius, 0 );
+    int  max_hx = MIN( (int)hx + (int)radius, GetMaxHexX() - 1 );
+    int  min_hy = MAX( (int)hy - (int)radius, 0 );
+    int  max_hy = MIN( (int)hy + (int)radius, GetMaxHexY() - 1 );
+    uint area = (uint)( (max_hx - min_hx + 1) * (max_hy - min_hy + 1) );
+
+    ItemPtrVec* pid_items = NULL;
+    if( pid )
     {
-        Item* item = *it;
-        if( (!pid || item->GetProtoId() == pid) && DistGame( item->AccHex.HexX, item->AccHex.HexY, hx, hy ) <= radius )
-            items.push_back( item );
+        auto it = hexItemsByPid.find( pid );
+        if( it == hexItemsByPid.end() )
+            return;
+        pid_items = &(*it).second;
+    }
+
+    if( pid_items && pid_items->size() <= area )
+    {
+        // Few items of this proto
+        for( auto it = pid_items->begin(), end = pid_items->end(); it != end; ++it )
+        {
+            Item* item = *it;
+            if( DistGame( item->AccHex.HexX, item->AccHex.HexY, hx, hy ) <= radius )
+                items.push_back( item );
+        }
+    }
+    else if( max_hy - min_hy + 1 < (int)hexItemsByHex.size() )
+    {
+        // Rows of hexes in radius
+        for( int y = min_hy; y <= max_hy; y++ )
+        {
+            auto it = hexItemsByHex.lower_bound( (y << 16) | min_hx );
+            auto end = hexItemsByHex.upper_bound( (y << 16) | max_hx );
+            for( ; it != end; ++it )
+            {
+                ushort x = (*it).first & 0xFFFF;
+                if( DistGame( x, y, hx, hy ) > radius )
+                    continue;
+                ItemPtrVec& hex_items = (*it).second;
+                for( auto it_ = hex_items.begin(), end_ = hex_items.end(); it_ != end_; ++it_ )
+                    if( !pid || (*it_)->GetProtoId() == pid )
+                        items.push_back( *it_ );
+            }
+        }
+    }
+    else
+    {
+        for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+        {
+            Item* item = *it;
+            if( (!pid || item->GetProtoId() == pid) && DistGame( item->AccHex.HexX, item->AccHex.HexY, hx, hy ) <= radius )
+                items.push_back( item );
+        }
     }
 
     if( lock )
@@ -1007,11 +1241,15 @@ void Map::GetItemsHexEx( ushort hx, ushort hy, uint radius, ushort pid, ItemPtrV
 
 void Map::GetItemsPid( ushort pid, ItemPtrVec& items, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    if( !pid )
     {
-        Item* item = *it;
-        if( !pid || item->GetProtoId() == pid )
-            items.push_back( item );
+        items.insert( items.end(), hexItems.begin(), hexItems.end() );
+    }
+    else
+    {
+        auto it = hexItemsByPid.find( pid );
+        if( it != hexItemsByPid.end() )
+            items.insert( items.end(), (*it).second.begin(), (*it).second.end() );
     }
 
     if( lock )
@@ -1021,11 +1259,12 @@ void Map::GetItemsPid( ushort pid, ItemPtrVec& items, bool lock )
 
 void Map::GetItemsType( int type, ItemPtrVec& items, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    // All items of one proto have same type
+    for( auto it = hexItemsByPid.begin(), end = hexItemsByPid.end(); it != end; ++it )
     {
-        Item* item = *it;
-        if( item->GetType() == type )
-            items.push_back( item );
+        ItemPtrVec& pid_items = (*it).second;
+        if( pid_items.front()->GetType() == type )
+            items.insert( items.end(), pid_items.begin(), pid_items.end() );
     }
 
     if( lock )
@@ -1035,11 +1274,15 @@ void Map::GetItemsType( int type, ItemPtrVec& items, bool lock )
 
 void Map::GetItemsTrap( ushort hx, ushort hy, ItemPtrVec& traps, bool lock )
 {
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( hex_items )
     {
-        Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && item->FuncId[ITEM_EVENT_WALK] > 0 )
-            traps.push_back( item );
+        for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
+        {
+            Item* item = *it;
+            if( item->FuncId[ITEM_EVENT_WALK] > 0 )
+                traps.push_back( item );
+        }
     }
     if( !traps.size() )
         UnsetHexFlag( hx, hy, HEX_FLAG_WALK_ITEM );
@@ -1053,13 +1296,14 @@ void Map::RecacheHexBlock( ushort hx, ushort hy )
 {
     UnsetHexFlag( hx, hy, HEX_FLAG_BLOCK_ITEM );
     UnsetHexFlag( hx, hy, HEX_FLAG_GAG_ITEM );
-    bool is_block = false;
-    bool is_gag = false;
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    bool        is_block = false;
+    bool        is_gag = false;
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( hex_items )
     {
-        Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy )
+        for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
         {
+            Item* item = *it;
             if( !is_block && !item->IsPassed() )
                 is_block = true;
             if( !is_gag && item->IsGag() )
@@ -1077,10 +1321,14 @@ void Map::RecacheHexBlock( ushort hx, ushort hy )
 void Map::RecacheHexShoot( ushort hx, ushort hy )
 {
     UnsetHexFlag( hx, hy, HEX_FLAG_NRAKE_ITEM );
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( !hex_items )
+        return;
+
+    for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
     {
         Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy && !item->IsRaked() )
+        if( !item->IsRaked() )
         {
             SetHexFlag( hx, hy, HEX_FLAG_NRAKE_ITEM );
             break;
@@ -1093,14 +1341,15 @@ void Map::RecacheHexBlockShoot( ushort hx, ushort hy )
     UnsetHexFlag( hx, hy, HEX_FLAG_BLOCK_ITEM );
     UnsetHexFlag( hx, hy, HEX_FLAG_NRAKE_ITEM );
     UnsetHexFlag( hx, hy, HEX_FLAG_GAG_ITEM );
-    bool is_block = false;
-    bool is_nrake = false;
-    bool is_gag = false;
-    for( auto it = hexItems.begin(), end = hexItems.end(); it != end; ++it )
+    bool        is_block = false;
+    bool        is_nrake = false;
+    bool        is_gag = false;
+    ItemPtrVec* hex_items = GetHexItemsNoLock( hx, hy );
+    if( hex_items )
     {
-        Item* item = *it;
-        if( item->AccHex.HexX == hx && item->AccHex.HexY == hy )
+        for( auto it = hex_items->begin(), end = hex_items->end(); it != end; ++it )
         {
+            Item* item = *it;
             if( !is_block && !item->IsPassed() )
                 is_block = true;
             if( !is_nrake && !item->IsRaked() )
@@ -1127,11 +1376,15 @@ ushort Map::GetHexFlags( ushort hx, ushort hy )
 void Map::SetHexFlag( ushort hx, ushort hy, uchar flag )
 {
     SETFLAG( hexFlags[hy * GetMaxHexX() + hx], flag );
+    if( flag & ~(HEX_FLAG_CRITTER | HEX_FLAG_DEAD_CRITTER) )
+        hexBlockersVersion++;
 }
 
 void Map::UnsetHexFlag( ushort hx, ushort hy, uchar flag )
 {
     UNSETFLAG( hexFlags[hy * GetMaxHexX() + hx], flag );
+    if( flag & ~(HEX_FLAG_CRITTER | HEX_FLAG_DEAD_CRITTER) )
+        hexBlockersVersion++;
 }
 
 bool Map::IsHexPassed( ushort hx, ushort hy )
@@ -1410,17 +1663,36 @@ Critter* Map::GetHexCritter( ushort hx, ushort hy, bool dead, bool sync_lock )
     return cr;
 }
 
+void Map::FindCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters )
+{
+    // Invoked in locked scope
+    // Grid cells around center, extended by largest critter size
+    uint grid_radius = radius + crittersGridMultihex;
+    int  min_cx = MAX( (int)hx - (int)grid_radius, 0 ) / MAP_CRITTERS_GRID_CELL;
+    int  min_cy = MAX( (int)hy - (int)grid_radius, 0 ) / MAP_CRITTERS_GRID_CELL;
+    int  max_cx = MIN( (int)hx + (int)grid_radius, GetMaxHexX() - 1 ) / MAP_CRITTERS_GRID_CELL;
+    int  max_cy = MIN( (int)hy + (int)grid_radius, GetMaxHexY() - 1 ) / MAP_CRITTERS_GRID_CELL;
+
+    for( int cy = min_cy; cy <= max_cy; cy++ )
+    {
+        for( int cx = min_cx; cx <= max_cx; cx++ )
+        {
+            CrVec& cell = crittersGrid[cy * crittersGridWidth + cx];
+            for( auto it = cell.begin(), end = cell.end(); it != end; ++it )
+            {
+                Critter* cr = *it;
+                if( cr->CheckFind( find_type ) && CheckDist( hx, hy, cr->GetHexX(), cr->GetHexY(), radius + cr->GetMultihex() ) )
+                    critters.push_back( cr );
+            }
+        }
+    }
+}
+
 void Map::GetCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters, bool sync_lock )
 {
     dataLocker.Lock();
     CrVec find_critters;
-    find_critters.reserve( mapCritters.size() );
-    for( auto it = mapCritters.begin(), end = mapCritters.end(); it != end; ++it )
-    {
-        Critter* cr = *it;
-        if( cr->CheckFind( find_type ) && CheckDist( hx, hy, cr->GetHexX(), cr->GetHexY(), radius + cr->GetMultihex() ) )
-            find_critters.push_back( cr );
-    }
+    FindCrittersHex( hx, hy, radius, find_type, find_critters );
     dataLocker.Unlock();
 
     if( sync_lock && LogicMT )
@@ -1433,12 +1705,7 @@ void Map::GetCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVe
         dataLocker.Lock();
         CrVec find_critters2;
         find_critters2.reserve( find_critters.size() );
-        for( auto it = mapCritters.begin(), end = mapCritters.end(); it != end; ++it )
-        {
-            Critter* cr = *it;
-            if( cr->CheckFind( find_type ) && CheckDist( hx, hy, cr->GetHexX(), cr->GetHexY(), radius + cr->GetMultihex() ) )
-                find_critters2.push_back( cr );
-        }
+        FindCrittersHex( hx, hy, radius, find_type, find_critters2 );
         dataLocker.Unlock();
 
         // Search again
@@ -1810,6 +2077,7 @@ void Map::SetLoopTime( uint loop_num, uint ms )
     if( loop_num >= MAP_LOOP_FUNC_MAX )
         return;
     LoopWaitTick[loop_num] = ms;
+    Job::Wake( this );
 }
 
 uchar Map::GetRain()
@@ -1983,6 +2251,7 @@ void Map::BeginTurnBased( Critter* first_cr )
         return;
 
     IsTurnBasedOn = true;
+    Job::Wake( this );
     NeedEndTurnBased = false;
     TurnBasedRound = 0;
     TurnBasedTurn = 0;
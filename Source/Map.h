@@ -16,8 +16,13 @@ extern const char* MapEventFuncName[MAP_EVENT_MAX];
 // Loop times
 #define MAP_LOOP_FUNC_MAX        (5)
 #define MAP_LOOP_DEFAULT_TICK    (60 * 60000)
+#define MAP_MAX_SLEEP_TICK       (10000) // Scheduled map job, max delay
 #define MAP_MAX_DATA             (100)
 
+// Critters grid cell side, in hexes
+#define MAP_CRITTERS_GRID_CELL   (16)
+#define MAP_CRITTERS_GRID_NONE   (-2) // Critter::GridCell, not on map; -1 on map, cell not assigned
+
 class Map;
 class Location;
 
@@ -29,12 +34,32 @@ public:
 private:
     Mutex      dataLocker;
     uchar*     hexFlags;
+    uint       hexBlockersVersion; // Changed on hex flags change of items and scenery, for path cache
     CrVec      mapCritters;
     ClVec      mapPlayers;
     PcVec      mapNpcs;
     ItemPtrVec hexItems;
+    UIntMap    hexItemsIndex; // Item id to position in hexItems
     Location*  mapLocation;
 
+    // Items per hex, key is (hy << 16) | hx
+    typedef map<uint, ItemPtrVec> HexItemsMap;
+    HexItemsMap hexItemsByHex;
+    ItemPtrVec* GetHexItemsNoLock( ushort hx, ushort hy );
+
+    // Items per proto, also used for type queries
+    typedef map<ushort, ItemPtrVec> PidItemsMap;
+    PidItemsMap hexItemsByPid;
+
+    // Critters spatial grid, for visibility and radius queries
+    vector<CrVec>  crittersGrid;
+    uint           crittersGridWidth;
+    multiset<uint> crittersGridVisRadius;
+    uint           crittersGridMultihex; // Max multihex of critters placed to grid
+
+    void EraseCritterGrid( Critter* cr );
+    void FindCrittersHex( ushort hx, ushort hy, uint radius, int find_type, CrVec& critters );
+
 public:
     struct MapData
     {
@@ -62,6 +87,7 @@ public:
     bool Generate();
     void Clear( bool full );
     void Process();
+    uint GetNextProcessTick();
     void Lock()   { dataLocker.Lock(); }
     void Unlock() { dataLocker.Unlock(); }
 
@@ -102,6 +128,11 @@ public:
     void EraseCritterEvents( Critter* cr );
     void KickPlayersToGlobalMap();
 
+    void SetCritterGrid( Critter* cr, uint vis_radius );
+    void SetCritterGridVisRadius( Critter* cr, uint vis_radius );
+    void GetCrittersGrid( ushort hx, ushort hy, uint radius, CrVec& critters, bool sync_lock );
+    uint GetCrittersGridVisRadius();
+
     bool AddItem( Item* item, ushort hx, ushort hy );
     void SetItem( Item* item, ushort hx, ushort hy );
     void EraseItem( uint item_id );
@@ -129,6 +160,7 @@ public:
     ushort GetHexFlags( ushort hx, ushort hy );
     void   SetHexFlag( ushort hx, ushort hy, uchar flag );
     void   UnsetHexFlag( ushort hx, ushort hy, uchar flag );
+    uint   GetHexBlockersVersion() { return hexBlockersVersion; }
 
     bool IsHexPassed( ushort hx, ushort hy );
     bool IsHexRaked( ushort hx, ushort hy );
@@ -221,12 +253,11 @@ public:
     ~Map();
 
     bool  IsNotValid;
-    short RefCounter;
-    void AddRef() { RefCounter++; }
+    long  RefCounter;
+    void AddRef() { InterlockedIncrement( &RefCounter ); }
     void Release()
     {
-        RefCounter--;
-        if( RefCounter <= 0 ) delete this;
+        if( InterlockedDecrement( &RefCounter ) <= 0 ) delete this;
     }
 };
 typedef map<uint, Map*> MapMap;
@@ -318,14 +349,17 @@ public:
 
 public:
     bool  IsNotValid;
-    short RefCounter;
-    void AddRef() { RefCounter++; }
+    long  RefCounter;
+    void AddRef() { InterlockedIncrement( &RefCounter ); }
     void Release()
     {
-        RefCounter--;
-        if( RefCounter <= 0 ) delete this;
+        if( InterlockedDecrement( &RefCounter ) <= 0 ) delete this;
+    }
+    Location() : RefCounter( 1 ), Proto( NULL ), IsNotValid( false )
+    {
+        memzero( (void*)&Data, sizeof(Data) );
+        Sync.SetType( SYNC_OBJECT_LOCATION );
     }
-    Location() : RefCounter( 1 ), Proto( NULL ), IsNotValid( false ) { memzero( (void*)&Data, sizeof(Data) ); }
 };
 typedef map<uint, Location*> LocMap;
 typedef vector<Location*>    LocVec;
@@ -14,6 +14,7 @@
 #include "Script.h"
 #include "ScriptFunctions.h"
 #include "Text.h"
+#include "Thread.h"
 #include "Timer.h"
 
 MapManager MapMngr;
@@ -122,8 +123,7 @@ void GlobalMapGroup::Clear()
 
 MapManager::MapManager() : lastMapId( 0 ), lastLocId( 0 ), runGarbager( true )
 {
-    MEMORY_PROCESS( MEMORY_STATIC, sizeof(MapManager) );
-    MEMORY_PROCESS( MEMORY_STATIC, (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) );     // Grid, see below
+    // Path search cells are allocated per thread, see FindPathSearch
 }
 
 bool MapManager::Init()
@@ -191,7 +191,95 @@ UIntPair EntranceParser( const char* str )
     return UIntPair( val1, val2 );
 }
 
-bool MapManager::LoadLocationsProtos()
+struct ProtoMapLoadQueue
+{
+    ProtoMap*           Maps;
+    map<ushort, string> Names;
+    UShortVec           Pids;
+    uint                Next;
+    Mutex               Locker;
+};
+
+static void LoadProtoMaps_Work( void* data )
+{
+    ProtoMapLoadQueue* queue = (ProtoMapLoadQueue*)data;
+    while( true )
+    {
+        queue->Locker.Lock();
+        uint index = queue->Next++;
+        queue->Locker.Unlock();
+        if( index >= queue->Pids.size() )
+            break;
+
+        ushort pid = queue->Pids[index];
+        queue->Maps[pid].Init( pid, queue->Names.find( pid )->second.c_str(), PATH_SERVER_MAPS );
+    }
+}
+
+void MapManager::LoadProtoMaps( IniParser& city_txt, uint threads )
+{
+    // Collect maps of all locations, first name of pid wins like in LoadLocationProto
+    ProtoMapLoadQueue queue;
+    queue.Maps = ProtoMaps;
+    queue.Next = 0;
+    char key[MAX_FOTEXT];
+    char res[MAX_FOTEXT];
+    for( int i = 1; i < MAX_PROTO_LOCATIONS; i++ )
+    {
+        const char* app = Str::FormatBuf( "Area %u", i );
+        if( !city_txt.IsCachedApp( app ) )
+            continue;
+
+        for( uint cur_map = 0; ; cur_map++ )
+        {
+            Str::Format( key, "map_%u", cur_map );
+            if( !city_txt.GetStr( app, key, "", res ) )
+                break;
+
+            char   map_name[MAX_FOPATH];
+            ushort map_pid = 0;
+            if( sscanf( res, "%s%hu", map_name, &map_pid ) != 2 || !map_name[0] || !map_pid || map_pid >= MAX_PROTO_MAPS )
+                break;
+
+            size_t len = Str::Length( map_name );
+            if( map_name[len - 1] == '*' )
+            {
+                if( len == 1 )
+                    break;
+                map_name[len - 1] = 0;
+            }
+
+            if( ProtoMaps[map_pid].IsInit() )
+                continue;
+            if( queue.Names.count( map_pid ) )
+                continue;
+            queue.Pids.push_back( map_pid );
+            queue.Names[map_pid] = map_name;
+        }
+    }
+
+    if( threads > queue.Pids.size() )
+        threads = (uint)queue.Pids.size();
+    vector<Thread*> workers;
+    for( uint i = 1; i < threads; i++ )
+    {
+        Thread* thread = new Thread();
+        if( !thread->Start( LoadProtoMaps_Work, Str::FormatBuf( "LoadProtoMaps%u", i ), &queue ) )
+        {
+            delete thread;
+            break;
+        }
+        workers.push_back( thread );
+    }
+    LoadProtoMaps_Work( &queue );
+    for( uint i = 0; i < workers.size(); i++ )
+    {
+        workers[i]->Wait();
+        delete workers[i];
+    }
+}
+
+bool MapManager::LoadLocationsProtos( uint threads /* = 1 */ )
 {
     WriteLog( "Load location and map prototypes...\n" );
 
@@ -205,6 +293,11 @@ bool MapManager::LoadLocationsProtos()
 
     city_txt.CacheApps();
 
+    // Maps are independent, load them in parallel
+    // Failed maps stay uninitialized and are loaded again below with usual errors
+    if( threads > 1 )
+        LoadProtoMaps( city_txt, threads );
+
     int  errors = 0;
     uint loaded = 0;
     char res[MAX_FOTEXT];
@@ -580,14 +673,14 @@ bool MapManager::GenerateWorld( const char* fname, int path_type )
     return true;
 }
 
-void MapManager::GetLocationAndMapIds( UIntSet& loc_ids, UIntSet& map_ids )
+void MapManager::GetLocationAndMapIds( CIdMask& loc_ids, CIdMask& map_ids )
 {
     SCOPE_LOCK( mapLocker );
 
     for( auto it = allLocations.begin(), end = allLocations.end(); it != end; ++it )
-        loc_ids.insert( (*it).second->GetId() );
+        loc_ids.SetBit( (*it).second->GetId() );
     for( auto it = allMaps.begin(), end = allMaps.end(); it != end; ++it )
-        map_ids.insert( (*it).second->GetId() );
+        map_ids.SetBit( (*it).second->GetId() );
 }
 
 bool MapManager::IsInitProtoLocation( ushort pid_loc )
@@ -1140,8 +1233,10 @@ void MapManager::GM_GlobalProcess( Critter* cr, GlobalMapGroup* group, int type
             {
                 cr->Data.WorldX = cur_wxi;
                 cr->Data.WorldY = cur_wyi;
+                cr->IsSaveChanged = true;
                 cr->Send_GlobalInfo( GM_INFO_GROUP_PARAM );
             }
+            CrMngr.SetGlobalGrid( cr );
         }
     }
 
@@ -1324,6 +1419,7 @@ void MapManager::GM_GroupStartMove( Critter* cr )
     SETFLAG( cr->Flags, CRITTER_FLAG_RULEGROUP );
 
     group->AddCrit( cr );
+    CrMngr.SetGlobalGrid( cr );
     cr->Send_GlobalInfo( GM_INFO_ALL );
     GM_GlobalProcess( cr, group, WORLDMAP_PROCESS_START_FAST );
 }
@@ -1365,6 +1461,7 @@ void MapManager::GM_AddCritToGroup( Critter* cr, uint rule_id )
     group->AddCrit( cr );
     cr->GroupMove = group;
     cr->Data.GlobalGroupUid = rule->Data.GlobalGroupUid;
+    CrMngr.SetGlobalGrid( cr );
 }
 
 void MapManager::GM_LeaveGroup( Critter* cr )
@@ -1771,20 +1868,39 @@ void MapManager::TraceBullet( TraceData& trace )
     }
 }
 
-int THREAD           MapGridOffsX = 0;
-int THREAD           MapGridOffsY = 0;
-static THREAD short* Grid = NULL;
-#define GRID( x, y )    Grid[( (FPATH_MAX_PATH + 1) + (y) - MapGridOffsY ) * (FPATH_MAX_PATH * 2 + 2) + ( (FPATH_MAX_PATH + 1) + (x) - MapGridOffsX )]
-int MapManager::FindPath( PathFindData& pfd )
+// Per thread A* search state, cells of previous searches invalidated by generation
+struct PathFindCell
 {
-    // Allocate temporary grid
-    if( !Grid )
-    {
-        Grid = new short[(FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2)];
-        if( !Grid )
-            return FPATH_ALLOC_FAIL;
-    }
+    ushort Generation;
+    short  Index;   // Steps from start plus one, zero - not visited, -1 - blocked, -2 - deferred critter
+    ushort Cost;    // Steps plus gag penalties
+    uchar  Penalty; // Cost of entering this hex above one step
+    bool   Closed;
+};
+struct PathFindNode
+{
+    uint   Priority;
+    ushort HexX, HexY;
+
+    bool   operator<( const PathFindNode& r ) const { return Priority > r.Priority; }
+};
+struct PathFindState
+{
+    PathFindCell*        Cells;
+    ushort               Generation;
+    vector<PathFindNode> Open;
+    UShortPairVec        Critters;
+};
+#define FPATH_GRID_SIZE      ( (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) )
+#define FPATH_GAG_COST       (10)   // Todo: if path finding not be reworked than migrate magic number to scripts
 
+int THREAD                   MapGridOffsX = 0;
+int THREAD                   MapGridOffsY = 0;
+static THREAD PathFindState* PathState = NULL;
+#define GRID_CELL( x, y )    PathState->Cells[( (FPATH_MAX_PATH + 1) + (y) - MapGridOffsY ) * (FPATH_MAX_PATH * 2 + 2) + ( (FPATH_MAX_PATH + 1) + (x) - MapGridOffsX )]
+#define GRID( x, y )         (GRID_CELL( x, y ).Generation == PathState->Generation ? GRID_CELL( x, y ).Index : 0)
+int MapManager::FindPath( PathFindData& pfd )
+{
     // Data
     uint   map_id = pfd.MapId;
     ushort from_hx = pfd.FromX;
@@ -1841,237 +1957,69 @@ int MapManager::FindPath( PathFindData& pfd )
             return FPATH_HEX_BUSY_RING;
     }
 
-    // Parse previous move params
-    /*UShortPairVec first_steps;
-       uchar first_dir=pfd.MoveParams&7;
-       if(first_dir<DIRS_COUNT)
-       {
-            ushort hx_=from_hx;
-            ushort hy_=from_hy;
-            MoveHexByDir(hx_,hy_,first_dir);
-            if(map->IsHexPassed(hx_,hy_))
-            {
-                    first_steps.push_back(PAIR(hx_,hy_));
-            }
-       }
-       for(int i=0;i<4;i++)
-       {
-
-       }*/
-
-    // Prepare
-    int numindex = 1;
-    memzero( Grid, (FPATH_MAX_PATH * 2 + 2) * (FPATH_MAX_PATH * 2 + 2) * sizeof(short) );
-    MapGridOffsX = from_hx;
-    MapGridOffsY = from_hy;
-    GRID( from_hx, from_hy ) = numindex;
-
-    UShortPairVec coords, cr_coords, gag_coords;
-    coords.reserve( 10000 );
-    cr_coords.reserve( 100 );
-    gag_coords.reserve( 100 );
-
-    // First point
-    coords.push_back( PAIR( from_hx, from_hy ) );
-
-    // Begin search
-    int    p = 0, p_togo = 1;
-    ushort cx, cy;
-    while( true )
-    {
-        for( int i = 0; i < p_togo; i++, p++ )
-        {
-            cx = coords[p].first;
-            cy = coords[p].second;
-            numindex = GRID( cx, cy );
-
-            if( CheckDist( cx, cy, to_hx, to_hy, cut ) )
-                goto label_FindOk;
-            if( ++numindex > FPATH_MAX_PATH )
-                return FPATH_TOOFAR;
-
-            short* sx, * sy;
-            GetHexOffsets( cx & 1, sx, sy );
-
-            for( int j = 0; j < dirs_count; j++ )
-            {
-                short nx = (short)cx + sx[j];
-                short ny = (short)cy + sy[j];
-                if( nx < 0 || ny < 0 || nx >= maxhx || ny >= maxhy )
-                    continue;
-
-                short& g = GRID( nx, ny );
-                if( g )
-                    continue;
-
-                if( !multihex )
-                {
-                    ushort flags = map->GetHexFlags( nx, ny );
-                    if( !FLAG( flags, HEX_FLAG_NOWAY ) )
-                    {
-                        coords.push_back( PAIR( nx, ny ) );
-                        g = numindex;
-                    }
-                    else if( check_gag_items && FLAG( flags, HEX_FLAG_GAG_ITEM << 8 ) )
-                    {
-                        gag_coords.push_back( PAIR( nx, ny ) );
-                        g = numindex | 0x4000;
-                    }
-                    else if( check_cr && FLAG( flags, HEX_FLAG_CRITTER << 8 ) )
-                    {
-                        cr_coords.push_back( PAIR( nx, ny ) );
-                        g = numindex | 0x8000;
-                    }
-                    else
-                    {
-                        g = -1;
-                    }
-                }
-                else
-                {
-                    /*
-                       // Multihex
-                       // Base hex
-                       int hx_=nx,hy_=ny;
-                       for(uint k=0;k<multihex;k++) MoveHexByDirUnsafe(hx_,hy_,j);
-                       if(hx_<0 || hy_<0 || hx_>=maxhx || hy_>=maxhy) continue;
-                       //if(!IsHexPassed(hx_,hy_)) return false;
-
-                       // Clock wise hexes
-                       bool is_square_corner=(!GameOpt.MapHexagonal && IS_DIR_CORNER(j));
-                       uint steps_count=(is_square_corner?multihex*2:multihex);
-                       int dir_=(GameOpt.MapHexagonal?((j+2)%6):((j+2)%8));
-                       if(is_square_corner) dir_=(dir_+1)%8;
-                       int hx__=hx_,hy__=hy_;
-                       for(uint k=0;k<steps_count;k++)
-                       {
-                            MoveHexByDirUnsafe(hx__,hy__,dir_);
-                            //if(!IsHexPassed(hx__,hy__)) return false;
-                       }
-
-                       // Counter clock wise hexes
-                       dir_=(GameOpt.MapHexagonal?((j+4)%6):((j+6)%8));
-                       if(is_square_corner) dir_=(dir_+7)%8;
-                       hx__=hx_,hy__=hy_;
-                       for(uint k=0;k<steps_count;k++)
-                       {
-                            MoveHexByDirUnsafe(hx__,hy__,dir_);
-                            //if(!IsHexPassed(hx__,hy__)) return false;
-                       }
-                     */
-
-                    if( map->IsMovePassed( nx, ny, j, multihex ) )
-                    {
-                        coords.push_back( PAIR( nx, ny ) );
-                        g = numindex;
-                    }
-                    else
-                    {
-                        g = -1;
-                    }
-                }
-            }
-        }
-
-        // Add gag hex after some distance
-        if( gag_coords.size() )
-        {
-            short       last_index = GRID( coords.back().first, coords.back().second );
-            UShortPair& xy = gag_coords.front();
-            short       gag_index = GRID( xy.first, xy.second ) ^ 0x4000;
-            if( gag_index + 10 < last_index )       // Todo: if path finding not be reworked than migrate magic number to scripts
-            {
-                GRID( xy.first, xy.second ) = gag_index;
-                coords.push_back( xy );
-                gag_coords.erase( gag_coords.begin() );
-            }
-        }
+    // Take path from cache or search new one
+    PathCacheKey cache_key;
+    memzero( &cache_key, sizeof(cache_key) );
+    cache_key.MapId = map_id;
+    cache_key.BlockersVersion = map->GetHexBlockersVersion();
+    cache_key.FromX = from_hx;
+    cache_key.FromY = from_hy;
+    cache_key.ToX = to_hx;
+    cache_key.ToY = to_hy;
+    cache_key.Multihex = multihex;
+    cache_key.Cut = cut;
+    cache_key.Flags = (check_cr ? 1 : 0) | (check_gag_items ? 2 : 0);
 
-        // Add gag and critters hexes
-        p_togo = (int)coords.size() - p;
-        if( !p_togo )
-        {
-            if( gag_coords.size() )
-            {
-                UShortPair& xy = gag_coords.front();
-                GRID( xy.first, xy.second ) ^= 0x4000;
-                coords.push_back( xy );
-                gag_coords.erase( gag_coords.begin() );
-                p_togo++;
-            }
-            else if( cr_coords.size() )
-            {
-                UShortPair& xy = cr_coords.front();
-                GRID( xy.first, xy.second ) ^= 0x8000;
-                coords.push_back( xy );
-                cr_coords.erase( cr_coords.begin() );
-                p_togo++;
-            }
-        }
-
-        if( !p_togo )
-            return FPATH_DEADLOCK;
-    }
-
-label_FindOk:
     if( ++pathNumCur >= FPATH_DATA_SIZE )
         pathNumCur = 1;
     PathStepVec& path = pathesPool[pathNumCur];
-    path.resize( numindex - 1 );
 
-    // Smooth data
-    static THREAD bool smooth_switcher = false;
-    if( !GameOpt.MapSmoothPath )
-        smooth_switcher = false;
-
-    int smooth_count = 0, smooth_iteration = 0;
-    if( GameOpt.MapSmoothPath && !GameOpt.MapHexagonal )
+    int result = -1;
+    pathCacheLocker.Lock();
+    auto it_cache = pathCache.find( cache_key );
+    if( it_cache != pathCache.end() )
     {
-        int x1 = cx, y1 = cy;
-        int x2 = from_hx, y2 = from_hy;
-        int dx = abs( x1 - x2 );
-        int dy = abs( y1 - y2 );
-        int d = MAX( dx, dy );
-        int h1 = abs( dx - dy );
-        int h2 = d - h1;
-        if( dy < dx )
-            std::swap( h1, h2 );
-        smooth_count = ( (h1 && h2) ? h1 / h2 + 1 : 3 );
-        if( smooth_count < 3 )
-            smooth_count = 3;
-
-        smooth_count = ( (h1 && h2) ? MAX( h1, h2 ) / MIN( h1, h2 ) + 1 : 0 );
-        if( h1 && h2 && smooth_count < 2 )
-            smooth_count = 2;
-        smooth_iteration = ( (h1 && h2) ? MIN( h1, h2 ) % MAX( h1, h2 ) : 0 );
+        result = FPATH_OK;
+        path = (*it_cache).second;
     }
+    pathCacheLocker.Unlock();
 
-    while( numindex > 1 )
+    // Critters are not part of cache key, cached path must be free of them
+    if( result == FPATH_OK )
     {
-        if( GameOpt.MapSmoothPath )
+        for( uint i = 0, j = (uint)path.size(); i < j && result == FPATH_OK; i++ )
         {
-            if( GameOpt.MapHexagonal )
+            PathStep& ps = path[i];
+            if( multihex )
             {
-                if( numindex & 1 )
-                    smooth_switcher = !smooth_switcher;
+                if( !map->IsMovePassed( ps.HexX, ps.HexY, ps.Dir, multihex ) )
+                    result = -1;
             }
             else
             {
-                smooth_switcher = (smooth_count < 2 || smooth_iteration % smooth_count);
+                ushort flags = map->GetHexFlags( ps.HexX, ps.HexY );
+                if( FLAG( flags, HEX_FLAG_NOWAY ) && !(check_gag_items && FLAG( flags, HEX_FLAG_GAG_ITEM << 8 ) ) )
+                    result = -1;
             }
         }
+    }
 
-        numindex--;
-        PathStep& ps = path[numindex - 1];
-        ps.HexX = cx;
-        ps.HexY = cy;
-        int dir = FindPathGrid( cx, cy, numindex, smooth_switcher );
-        if( dir == -1 )
-            return FPATH_ERROR;
-        ps.Dir = dir;
+    if( result == -1 )
+    {
+        result = FindPathSearch( map, pfd, path );
 
-        smooth_iteration++;
+        // Failures may be caused by critters, so only found pathes are cached
+        if( result == FPATH_OK )
+        {
+            pathCacheLocker.Lock();
+            if( pathCache.size() >= FPATH_CACHE_SIZE )
+                pathCache.clear();
+            pathCache[cache_key] = path;
+            pathCacheLocker.Unlock();
+        }
     }
+    if( result != FPATH_OK )
+        return result;
 
     // Check for closed door and critter
     if( check_cr || check_gag_items )
@@ -2182,6 +2130,216 @@ label_TraceOk:
     return FPATH_OK;
 }
 
+int MapManager::FindPathSearch( Map* map, PathFindData& pfd, PathStepVec& path )
+{
+    // Allocate search state once per thread
+    if( !PathState )
+    {
+        PathState = new PathFindState();
+        PathState->Cells = new PathFindCell[FPATH_GRID_SIZE];
+        MEMORY_PROCESS( MEMORY_STATIC, FPATH_GRID_SIZE * sizeof(PathFindCell) );
+        memzero( PathState->Cells, FPATH_GRID_SIZE * sizeof(PathFindCell) );
+        PathState->Generation = 0;
+        PathState->Open.reserve( 10000 );
+    }
+
+    // Data
+    ushort from_hx = pfd.FromX;
+    ushort from_hy = pfd.FromY;
+    ushort to_hx = pfd.ToX;
+    ushort to_hy = pfd.ToY;
+    uint   multihex = pfd.Multihex;
+    uint   cut = pfd.Cut;
+    bool   check_cr = pfd.CheckCrit;
+    bool   check_gag_items = pfd.CheckGagItems;
+    int    dirs_count = DIRS_COUNT;
+    ushort maxhx = map->GetMaxHexX();
+    ushort maxhy = map->GetMaxHexY();
+
+    // Prepare, full clear only on generation overflow
+    if( ++PathState->Generation == 0 )
+    {
+        memzero( PathState->Cells, FPATH_GRID_SIZE * sizeof(PathFindCell) );
+        PathState->Generation = 1;
+    }
+    vector<PathFindNode>& open = PathState->Open;
+    UShortPairVec&        cr_coords = PathState->Critters;
+    open.clear();
+    cr_coords.clear();
+
+    MapGridOffsX = from_hx;
+    MapGridOffsY = from_hy;
+    PathFindCell& first = GRID_CELL( from_hx, from_hy );
+    first.Generation = PathState->Generation;
+    first.Index = 1;
+    first.Cost = 0;
+    first.Closed = false;
+    PathFindNode first_node = { 0, from_hx, from_hy };
+    open.push_back( first_node );
+
+    // A* with hex distance heuristic, gag hexes cost more, critters hexes used only in deadlock
+    bool   too_far = false;
+    ushort cx = 0, cy = 0;
+    int    numindex = 0;
+    while( true )
+    {
+        if( open.empty() )
+        {
+            if( cr_coords.empty() )
+                return too_far ? FPATH_TOOFAR : FPATH_DEADLOCK;
+
+            UShortPair    xy = cr_coords.front();
+            cr_coords.erase( cr_coords.begin() );
+            PathFindCell& cell = GRID_CELL( xy.first, xy.second );
+            cell.Index = -cell.Index - 2;
+            PathFindNode  node = { cell.Cost, xy.first, xy.second };
+            open.push_back( node );
+        }
+
+        std::pop_heap( open.begin(), open.end() );
+        PathFindNode node = open.back();
+        open.pop_back();
+
+        cx = node.HexX;
+        cy = node.HexY;
+        PathFindCell& cell = GRID_CELL( cx, cy );
+        if( cell.Closed )
+            continue;
+        cell.Closed = true;
+        numindex = cell.Index;
+
+        if( CheckDist( cx, cy, to_hx, to_hy, cut ) )
+            break;
+        if( numindex >= FPATH_MAX_PATH )
+        {
+            too_far = true;
+            continue;
+        }
+
+        short* sx, * sy;
+        GetHexOffsets( cx & 1, sx, sy );
+
+        for( int j = 0; j < dirs_count; j++ )
+        {
+            short nx = (short)cx + sx[j];
+            short ny = (short)cy + sy[j];
+            if( nx < 0 || ny < 0 || nx >= maxhx || ny >= maxhy )
+                continue;
+
+            PathFindCell& n = GRID_CELL( nx, ny );
+            bool          visited = (n.Generation == PathState->Generation);
+            if( visited && (n.Closed || n.Index < 0) )
+                continue;
+
+            if( !visited )
+            {
+                n.Generation = PathState->Generation;
+                n.Closed = false;
+                n.Penalty = 0;
+
+                bool passed;
+                if( !multihex )
+                {
+                    ushort flags = map->GetHexFlags( nx, ny );
+                    passed = !FLAG( flags, HEX_FLAG_NOWAY );
+                    if( !passed && check_gag_items && FLAG( flags, HEX_FLAG_GAG_ITEM << 8 ) )
+                    {
+                        passed = true;
+                        n.Penalty = FPATH_GAG_COST;
+                    }
+                    else if( !passed && check_cr && FLAG( flags, HEX_FLAG_CRITTER << 8 ) )
+                    {
+                        cr_coords.push_back( PAIR( nx, ny ) );
+                        n.Index = -( numindex + 1 ) - 2;
+                        n.Cost = cell.Cost + 1;
+                        continue;
+                    }
+                }
+                else
+                {
+                    passed = map->IsMovePassed( nx, ny, j, multihex );
+                }
+
+                if( !passed )
+                {
+                    n.Index = -1;
+                    continue;
+                }
+            }
+
+            // Skip if already opened by cheaper way
+            uint cost = cell.Cost + 1 + n.Penalty;
+            if( visited && n.Cost <= cost )
+                continue;
+
+            n.Index = numindex + 1;
+            n.Cost = cost;
+            uint         dist = DistGame( nx, ny, to_hx, to_hy );
+            PathFindNode next = { cost + (dist > cut ? dist - cut : 0), (ushort)nx, (ushort)ny };
+            open.push_back( next );
+            std::push_heap( open.begin(), open.end() );
+        }
+    }
+
+    path.resize( numindex - 1 );
+
+    // Smooth data
+    static THREAD bool smooth_switcher = false;
+    if( !GameOpt.MapSmoothPath )
+        smooth_switcher = false;
+
+    int smooth_count = 0, smooth_iteration = 0;
+    if( GameOpt.MapSmoothPath && !GameOpt.MapHexagonal )
+    {
+        int x1 = cx, y1 = cy;
+        int x2 = from_hx, y2 = from_hy;
+        int dx = abs( x1 - x2 );
+        int dy = abs( y1 - y2 );
+        int d = MAX( dx, dy );
+        int h1 = abs( dx - dy );
+        int h2 = d - h1;
+        if( dy < dx )
+            std::swap( h1, h2 );
+        smooth_count = ( (h1 && h2) ? h1 / h2 + 1 : 3 );
+        if( smooth_count < 3 )
+            smooth_count = 3;
+
+        smooth_count = ( (h1 && h2) ? MAX( h1, h2 ) / MIN( h1, h2 ) + 1 : 0 );
+        if( h1 && h2 && smooth_count < 2 )
+            smooth_count = 2;
+        smooth_iteration = ( (h1 && h2) ? MIN( h1, h2 ) % MAX( h1, h2 ) : 0 );
+    }
+
+    while( numindex > 1 )
+    {
+        if( GameOpt.MapSmoothPath )
+        {
+            if( GameOpt.MapHexagonal )
+            {
+                if( numindex & 1 )
+                    smooth_switcher = !smooth_switcher;
+            }
+            else
+            {
+                smooth_switcher = (smooth_count < 2 || smooth_iteration % smooth_count);
+            }
+        }
+
+        numindex--;
+        PathStep& ps = path[numindex - 1];
+        ps.HexX = cx;
+        ps.HexY = cy;
+        int dir = FindPathGrid( cx, cy, numindex, smooth_switcher );
+        if( dir == -1 )
+            return FPATH_ERROR;
+        ps.Dir = dir;
+
+        smooth_iteration++;
+    }
+
+    return FPATH_OK;
+}
+
 int MapManager::FindPathGrid( ushort& hx, ushort& hy, int index, bool smooth_switcher )
 {
     // Hexagonal
@@ -2629,7 +2787,9 @@ bool MapManager::Transit( Critter* cr, Map* map, ushort hx, ushort hy, uchar dir
         map->UnsetFlagCritter( old_hx, old_hy, multihex, is_dead );
         cr->Data.HexX = hx;
         cr->Data.HexY = hy;
+        cr->IsSaveChanged = true;
         map->SetFlagCritter( hx, hy, multihex, is_dead );
+        map->SetCritterGrid( cr, cr->GridVisRadius );
         cr->SetBreakTime( 0 );
         cr->Send_ParamOther( OTHER_TELEPORT, (cr->GetHexX() << 16) | (cr->GetHexY() ) );
         cr->ClearVisible();
@@ -2746,6 +2906,7 @@ void MapManager::EraseCrFromMap( Critter* cr, Map* map, ushort hex_x, ushort hex
                 // cr_->EventHideCritter(cr);
             }
             cr->GroupMove = NULL;
+            CrMngr.SetGlobalGrid( cr );
         }
     }
     // Local map
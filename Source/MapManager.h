@@ -119,6 +119,22 @@ struct PathStep
 };
 typedef vector<PathStep> PathStepVec;
 
+// Path cache, found pathes valid while map static blockers not changed
+#define FPATH_CACHE_SIZE             (4096)
+struct PathCacheKey
+{
+    uint   MapId;
+    uint   BlockersVersion;
+    ushort FromX, FromY;
+    ushort ToX, ToY;
+    uint   Multihex;
+    uint   Cut;
+    uint   Flags;
+
+    bool   operator<( const PathCacheKey& r ) const { return memcmp( this, &r, sizeof(PathCacheKey) ) < 0; }
+};
+typedef map<PathCacheKey, PathStepVec> PathCacheMap;
+
 class MapManager
 {
 private:
@@ -135,14 +151,15 @@ public:
     void Finish();
     void Clear();
 
-    bool   LoadLocationsProtos();
+    bool   LoadLocationsProtos( uint threads = 1 );
     bool   LoadLocationProto( IniParser& city_txt, ProtoLocation& ploc, ushort pid );
+    void   LoadProtoMaps( IniParser& city_txt, uint threads );
     void   SaveAllLocationsAndMapsFile( void (*save_func)( void*, size_t ) );
     bool   LoadAllLocationsAndMapsFile( void* f );
     string GetLocationsMapsStatistics();
     void   RunInitScriptMaps();
     bool   GenerateWorld( const char* fname, int path_type );
-    void   GetLocationAndMapIds( UIntSet& loc_ids, UIntSet& map_ids );
+    void   GetLocationAndMapIds( CIdMask& loc_ids, CIdMask& map_ids );
 
     // Maps stuff
 public:
@@ -190,9 +207,11 @@ public:
 
     // Maps
 private:
-    MapMap      allMaps;
-    PathStepVec pathesPool[FPATH_DATA_SIZE];
-    uint        pathNumCur;
+    MapMap       allMaps;
+    PathStepVec  pathesPool[FPATH_DATA_SIZE];
+    uint         pathNumCur;
+    PathCacheMap pathCache;
+    Mutex        pathCacheLocker;
 
 public:
     bool         IsInitProtoMap( ushort pid_map );
@@ -205,6 +224,7 @@ public:
     bool         IsProtoMapNoLogOut( ushort pid_map );
     void         TraceBullet( TraceData& trace );
     int          FindPath( PathFindData& pfd );
+    int          FindPathSearch( Map* map, PathFindData& pfd, PathStepVec& path );
     int          FindPathGrid( ushort& hx, ushort& hy, int index, bool smooth_switcher );
     PathStepVec& GetPath( uint num ) { return pathesPool[num]; }
     void         PathSetMoveParams( PathStepVec& path, bool is_run );
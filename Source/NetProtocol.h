@@ -916,47 +916,46 @@
 #define NETMSG_LOADMAP                        MAKE_NETMSG_HEADER( NETUID_LOADMAP )
 #define NETMSG_LOADMAP_SIZE          \
     (sizeof(uint) + sizeof(ushort) + \
-     sizeof(int) + sizeof(uchar) + sizeof(uint) * 3)
+     sizeof(int) + sizeof(uchar) + sizeof(uint) )
 // ////////////////////////////////////////////////////////////////////////
 //
 // ushort num_pid
 // int map_time
 // uchar map_rain
-// uint ver_tiles
-// uint ver_walls
-// uint ver_scen
+// uint hash_regions
 // ////////////////////////////////////////////////////////////////////////
 
 #define NETMSG_MAP                            MAKE_NETMSG_HEADER( NETUID_MAP )
 // ////////////////////////////////////////////////////////////////////////
-// Map data
+// Map data, only regions changed since client cache (see MAP_REGION_HEXES)
 // uint msg_len
 // ushort pid_map
-// uchar send_info (see Sendmap info in FOdefines.h)
-// uint ver_tiles
-//	for TILESX*TILESY
-//		ushort roof
-//		ushort floor
-// uint count_walls
-//	for count_walls
-//		WallToSend
-// uint count_scen
-//	for count_scen
-//		ScenToSend (see ScenToSend in FOdefines.h)
+// ushort maxhx
+// ushort maxhy
+// uint hash_regions
+// ushort regions_count
+// ushort count_send
+//	for count_send
+//		ushort region
+//		uint hash
+//		uint count_tiles
+//			ProtoMap::Tile
+//		uint count_walls
+//			SceneryCl
+//		uint count_scen
+//			SceneryCl
 // ////////////////////////////////////////////////////////////////////////
 
 #define NETMSG_SEND_GIVE_MAP                  MAKE_NETMSG_HEADER( NETUID_SEND_GIVE_MAP )
-#define NETMSG_SEND_GIVE_MAP_SIZE                   \
-    (sizeof(uint) + sizeof(bool) + sizeof(ushort) + \
-     sizeof(uint) + sizeof(uint) * 3)
 // ////////////////////////////////////////////////////////////////////////
 // Request on map data, on map loading or for automap
+// uint msg_len
 // bool automap
 // ushort map_pid
 // uint loc_id
-// uint ver_tiles
-// uint ver_walls
-// uint ver_scen
+// ushort regions_count
+//	for regions_count
+//		uint hash
 // ////////////////////////////////////////////////////////////////////////
 
 #define NETMSG_SEND_LOAD_MAP_OK               MAKE_NETMSG_HEADER( NETUID_SEND_LOAD_MAP_OK )
@@ -37,6 +37,7 @@
 
 #ifdef FOCLASSIC_SERVER
 BINARY_SIGNATURE( MapSaveSignature, BINARY_TYPE_MAPSAVE, FOCLASSIC_VERSION );
+# define MAP_CACHE_HASHED       (0x48534149) // Follows signature, text and protos hashes are stored next
 #endif
 
 #define APP_HEADER              "Header"
@@ -377,6 +378,11 @@ void ProtoMap::Clear()
     MEMORY_PROCESS( MEMORY_PROTO_MAP, -(int)Tiles.capacity() * sizeof(MapEntire) );
 
     SAFEDELA( HexFlags );
+    HashRegions = 0;
+    RegionHashes.clear();
+    RegionTiles.clear();
+    RegionWalls.clear();
+    RegionScen.clear();
 
     for( auto it = CrittersVec.begin(), end = CrittersVec.end(); it != end; ++it )
         SAFEREL( *it );
@@ -1458,7 +1464,21 @@ void ProtoMap::SaveTextFormat( FileManager& fm )
 #endif
 
 #ifdef FOCLASSIC_SERVER
-bool ProtoMap::LoadCache( FileManager& fm )
+int ProtoMap::CacheMode = MAP_CACHE_DEFAULT;
+
+// Cache depends on item protos, hex flags and sceneries are built from them
+static uint GetCacheProtosHash()
+{
+    uint hash = 0;
+    for( int i = 0; i < ITEM_TYPE_MAX; i++ )
+    {
+        uint type_hash = ItemMngr.GetProtosHash( i );
+        Crypt.Crc32( (uchar*)&type_hash, sizeof(type_hash), hash );
+    }
+    return hash;
+}
+
+bool ProtoMap::LoadCache( FileManager& fm, const uint* text_hash )
 {
     uchar signature[sizeof(MapSaveSignature)];
     if( !fm.CopyMem( signature, sizeof(signature) ) )
@@ -1467,6 +1487,16 @@ bool ProtoMap::LoadCache( FileManager& fm )
     if( memcmp( MapSaveSignature, signature, sizeof(MapSaveSignature) ) != 0 )
         return false;
 
+    // Content hashes, outdated cache is not an error
+    if( fm.GetBEUInt() != MAP_CACHE_HASHED )
+        return false;
+    uint cached_text_hash = fm.GetBEUInt();
+    uint cached_protos_hash = fm.GetBEUInt();
+    if( text_hash && *text_hash != cached_text_hash )
+        return false;
+    if( cached_protos_hash != GetCacheProtosHash() )
+        return false;
+
     // Header
     if( !fm.CopyMem( &Header, sizeof(Header) ) )
         return false;
@@ -1512,6 +1542,7 @@ bool ProtoMap::LoadCache( FileManager& fm )
         if( mobj->ScriptName[0] && mobj->FuncName[0] )
             BindSceneryScript( mobj );
     }
+    SortSceneries();
 
     // Grids
     count = fm.GetBEUInt();
@@ -1541,11 +1572,6 @@ bool ProtoMap::LoadCache( FileManager& fm )
             return false;
     }
 
-    // Hashes
-    HashTiles = fm.GetBEUInt();
-    HashWalls = fm.GetBEUInt();
-    HashScen = fm.GetBEUInt();
-
     // Hex flags
     HexFlags = new uchar[Header.MaxHexX * Header.MaxHexY];
     if( !HexFlags )
@@ -1562,6 +1588,9 @@ bool ProtoMap::LoadCache( FileManager& fm )
             return false;
     }
 
+    // Regions are not stored, data is already ordered by them
+    BuildRegions();
+
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)SceneriesToSend.capacity() * sizeof(SceneryCl) );
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)WallsToSend.capacity() * sizeof(SceneryCl) );
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)mapEntires.capacity() * sizeof(MapEntire) );
@@ -1574,11 +1603,16 @@ bool ProtoMap::LoadCache( FileManager& fm )
     return true;
 }
 
-void ProtoMap::SaveCache( FileManager& fm )
+void ProtoMap::SaveCache( FileManager& fm, uint text_hash )
 {
     ushort version = BINARY_SIGNATURE_VERSION( MapSaveSignature );
     fm.SetData( (uchar*)MapSaveSignature, sizeof(MapSaveSignature) );
 
+    // Content hashes
+    fm.SetBEUInt( MAP_CACHE_HASHED );
+    fm.SetBEUInt( text_hash );
+    fm.SetBEUInt( GetCacheProtosHash() );
+
     // Header
     fm.SetData( &Header, sizeof(Header) );
 
@@ -1613,11 +1647,6 @@ void ProtoMap::SaveCache( FileManager& fm )
     fm.SetBEUInt( (uint)SceneriesToSend.size() );
     fm.SetData( &SceneriesToSend[0], (uint)SceneriesToSend.size() * sizeof(SceneryCl) );
 
-    // Hashes
-    fm.SetBEUInt( HashTiles );
-    fm.SetBEUInt( HashWalls );
-    fm.SetBEUInt( HashScen );
-
     // Hex flags
     fm.SetData( HexFlags, Header.MaxHexX * Header.MaxHexY );
 
@@ -1690,7 +1719,23 @@ bool ProtoMap::Refresh()
     #ifdef FOCLASSIC_SERVER
     // Cached binary
     FileManager cached;
-    cached.LoadFile( fname_bin.c_str(), pathType );
+    if( CacheMode == MAP_CACHE_DEFAULT || CacheMode == MAP_CACHE_ONLY )
+        cached.LoadFile( fname_bin.c_str(), pathType );
+
+    if( CacheMode == MAP_CACHE_ONLY )
+    {
+        if( !cached.IsLoaded() )
+        {
+            WriteLogF( _FUNC_, " - Map<%s>. Cached map file not found.\n", map_info );
+            return false;
+        }
+        if( !LoadCache( cached, NULL ) )
+        {
+            WriteLogF( _FUNC_, " - Map<%s>. Cached map file is invalid or outdated.\n", map_info );
+            return false;
+        }
+        return true;
+    }
 
     // Load text or binary
     FileManager fm;
@@ -1705,29 +1750,21 @@ bool ProtoMap::Refresh()
         }
     }
 
+    // Cache is keyed by content, not by modification time
+    uint text_hash = 0;
+    if( fm.IsLoaded() )
+        text_hash = Crypt.Crc32( fm.GetBuf(), fm.GetFsize() );
+
     // Process cache
     if( cached.IsLoaded() )
     {
-        bool load_cache = true;
-        if( fm.IsLoaded() )
-        {
-            uint64 last_write, last_write_cache;
-            fm.GetTime( NULL, NULL, &last_write );
-            cached.GetTime( NULL, NULL, &last_write_cache );
-            if( last_write > last_write_cache )
-                load_cache = false;
-        }
+        if( LoadCache( cached, fm.IsLoaded() ? &text_hash : NULL ) )
+            return true;
 
-        if( load_cache )
+        if( !fm.IsLoaded() )
         {
-            if( LoadCache( cached ) )
-                return true;
-
-            if( !fm.IsLoaded() )
-            {
-                WriteLogF( _FUNC_, " - Map<%s>. Can't read cached map file.\n", map_info );
-                return false;
-            }
+            WriteLogF( _FUNC_, " - Map<%s>. Can't read cached map file.\n", map_info );
+            return false;
         }
     }
     #endif // FOCLASSIC_SERVER
@@ -2118,16 +2155,8 @@ bool ProtoMap::Refresh()
         SAFEREL( *it );
     MapObjectPtrVec().swap( MObjects );
 
-    // Generate hashes
-    HashTiles = maxhx * maxhy;
-    if( Tiles.size() )
-        Crypt.Crc32( (uchar*)&Tiles[0], (uint)Tiles.size() * sizeof(Tile), HashTiles );
-    HashWalls = maxhx * maxhy;
-    if( WallsToSend.size() )
-        Crypt.Crc32( (uchar*)&WallsToSend[0], (uint)WallsToSend.size() * sizeof(SceneryCl), HashWalls );
-    HashScen = maxhx * maxhy;
-    if( SceneriesToSend.size() )
-        Crypt.Crc32( (uchar*)&SceneriesToSend[0], (uint)SceneriesToSend.size() * sizeof(SceneryCl), HashScen );
+    // Split to regions for transfer
+    BuildRegions();
 
     // Shrink the vector capacities to fit their contents and reduce memory use
     SceneryClVec( SceneriesToSend ).swap( SceneriesToSend );
@@ -2138,6 +2167,7 @@ bool ProtoMap::Refresh()
     MapObjectPtrVec( SceneryVec ).swap( SceneryVec );
     MapObjectPtrVec( GridsVec ).swap( GridsVec );
     TileVec( Tiles ).swap( Tiles );
+    SortSceneries();
 
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)SceneriesToSend.capacity() * sizeof(SceneryCl) );
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)WallsToSend.capacity() * sizeof(SceneryCl) );
@@ -2149,7 +2179,8 @@ bool ProtoMap::Refresh()
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)Header.MaxHexX * Header.MaxHexY );
     MEMORY_PROCESS( MEMORY_PROTO_MAP, (int)Tiles.capacity() * sizeof(Tile) );
 
-    SaveCache( fm );
+    if( CacheMode != MAP_CACHE_IGNORE )
+        SaveCache( fm, text_hash );
     #endif
 
     #ifdef FOCLASSIC_MAPPER
@@ -2444,13 +2475,97 @@ void ProtoMap::GetMapSceneriesHex( ushort hx, ushort hy, MapObjectPtrVec& mobjs
     }
 }
 
+static bool SceneryHexLess( const MapObject* mobj1, const MapObject* mobj2 )
+{
+    if( mobj1->MapY != mobj2->MapY )
+        return mobj1->MapY < mobj2->MapY;
+    return mobj1->MapX < mobj2->MapX;
+}
+
+struct RegionLess
+{
+    ushort MaxHexX, MaxHexY, RegionsX;
+    RegionLess( ushort maxhx, ushort maxhy ) : MaxHexX( maxhx ), MaxHexY( maxhy ), RegionsX( (maxhx + MAP_REGION_HEXES - 1) / MAP_REGION_HEXES ) {}
+    uint Region( ushort hx, ushort hy ) const                                   { return MIN( hy, MaxHexY - 1 ) / MAP_REGION_HEXES * RegionsX + MIN( hx, MaxHexX - 1 ) / MAP_REGION_HEXES; }
+    bool operator()( const ProtoMap::Tile& t1, const ProtoMap::Tile& t2 ) const { return Region( t1.HexX, t1.HexY ) < Region( t2.HexX, t2.HexY ); }
+    bool operator()( const SceneryCl& s1, const SceneryCl& s2 ) const           { return Region( s1.MapX, s1.MapY ) < Region( s2.MapX, s2.MapY ); }
+};
+
+void ProtoMap::BuildRegions()
+{
+    // Order of data inside one hex stays same
+    RegionLess less( Header.MaxHexX, Header.MaxHexY );
+    uint       regions_y = (Header.MaxHexY + MAP_REGION_HEXES - 1) / MAP_REGION_HEXES;
+    uint       count = less.RegionsX * regions_y;
+    std::stable_sort( Tiles.begin(), Tiles.end(), less );
+    std::stable_sort( WallsToSend.begin(), WallsToSend.end(), less );
+    std::stable_sort( SceneriesToSend.begin(), SceneriesToSend.end(), less );
+
+    RegionTiles.assign( count + 1, 0 );
+    RegionWalls.assign( count + 1, 0 );
+    RegionScen.assign( count + 1, 0 );
+    for( uint i = 0, j = (uint)Tiles.size(); i < j; i++ )
+        RegionTiles[less.Region( Tiles[i].HexX, Tiles[i].HexY ) + 1]++;
+    for( uint i = 0, j = (uint)WallsToSend.size(); i < j; i++ )
+        RegionWalls[less.Region( WallsToSend[i].MapX, WallsToSend[i].MapY ) + 1]++;
+    for( uint i = 0, j = (uint)SceneriesToSend.size(); i < j; i++ )
+        RegionScen[less.Region( SceneriesToSend[i].MapX, SceneriesToSend[i].MapY ) + 1]++;
+    for( uint r = 0; r < count; r++ )
+    {
+        RegionTiles[r + 1] += RegionTiles[r];
+        RegionWalls[r + 1] += RegionWalls[r];
+        RegionScen[r + 1] += RegionScen[r];
+    }
+
+    // Hashes, counts are included to distinguish moved data
+    RegionHashes.resize( count );
+    for( uint r = 0; r < count; r++ )
+    {
+        uint counts[3] = { RegionTiles[r + 1] - RegionTiles[r], RegionWalls[r + 1] - RegionWalls[r], RegionScen[r + 1] - RegionScen[r] };
+        uint hash = r + 1;
+        Crypt.Crc32( (uchar*)counts, sizeof(counts), hash );
+        if( counts[0] )
+            Crypt.Crc32( (uchar*)&Tiles[RegionTiles[r]], counts[0] * sizeof(Tile), hash );
+        if( counts[1] )
+            Crypt.Crc32( (uchar*)&WallsToSend[RegionWalls[r]], counts[1] * sizeof(SceneryCl), hash );
+        if( counts[2] )
+            Crypt.Crc32( (uchar*)&SceneriesToSend[RegionScen[r]], counts[2] * sizeof(SceneryCl), hash );
+        RegionHashes[r] = (hash ? hash : 1); // Zero is for absent region on client
+    }
+
+    HashRegions = Header.MaxHexX * Header.MaxHexY;
+    if( count )
+        Crypt.Crc32( (uchar*)&RegionHashes[0], count * sizeof(uint), HashRegions );
+}
+
+void ProtoMap::SortSceneries()
+{
+    // Order by rows for radius queries
+    std::stable_sort( SceneryVec.begin(), SceneryVec.end(), SceneryHexLess );
+}
+
 void ProtoMap::GetMapSceneriesHexEx( ushort hx, ushort hy, uint radius, ushort pid, MapObjectPtrVec& mobjs )
 {
-    for( auto it = SceneryVec.begin(), end = SceneryVec.end(); it != end; ++it )
+    // Hex distance not less than coordinates difference, so check rows of square around center
+    int       min_hx = MAX( (int)hx - (int)radius, 0 );
+    int       max_hx = MIN( (int)hx + (int)radius, Header.MaxHexX - 1 );
+    int       min_hy = MAX( (int)hy - (int)radius, 0 );
+    int       max_hy = MIN( (int)hy + (int)radius, Header.MaxHexY - 1 );
+
+    MapObject key;
+    for( int y = min_hy; y <= max_hy; y++ )
     {
-        MapObject* mobj = *it;
-        if( (!pid || mobj->ProtoId == pid) && DistGame( mobj->MapX, mobj->MapY, hx, hy ) <= radius )
-            mobjs.push_back( mobj );
+        key.MapX = min_hx;
+        key.MapY = y;
+        auto it = std::lower_bound( SceneryVec.begin(), SceneryVec.end(), &key, SceneryHexLess );
+        for( auto end = SceneryVec.end(); it != end; ++it )
+        {
+            MapObject* mobj = *it;
+            if( mobj->MapY != y || mobj->MapX > max_hx )
+                break;
+            if( (!pid || mobj->ProtoId == pid) && DistGame( mobj->MapX, mobj->MapY, hx, hy ) <= radius )
+                mobjs.push_back( mobj );
+        }
     }
 }
 
@@ -9,6 +9,12 @@
 #define MAPOBJ_SCRIPT_NAME       (25)
 #define MAPOBJ_CRITTER_PARAMS    (40)
 
+// Binary cache usage, server only
+#define MAP_CACHE_DEFAULT        (0) // Cache if content hash of text is same, otherwise text
+#define MAP_CACHE_ONLY           (1) // Cache only, text is not read
+#define MAP_CACHE_REBUILD        (2) // Text only, cache is rewritten
+#define MAP_CACHE_IGNORE         (3) // Text only, cache is not touched
+
 class ProtoMap;
 class MapObject // Available in fonline.h
 {
@@ -228,9 +234,11 @@ public:
     // To Client
     SceneryClVec    WallsToSend;
     SceneryClVec    SceneriesToSend;
-    uint            HashTiles;
-    uint            HashWalls;
-    uint            HashScen;
+    uint            HashRegions;   // Of all regions hashes
+    UIntVec         RegionHashes;
+    UIntVec         RegionTiles;   // Region data starts, data is ordered by regions, regions count + 1
+    UIntVec         RegionWalls;
+    UIntVec         RegionScen;
 
     MapObjectPtrVec CrittersVec;
     MapObjectPtrVec ItemsVec;
@@ -238,10 +246,14 @@ public:
     MapObjectPtrVec GridsVec;
     uchar*          HexFlags;
 
+    static int      CacheMode;
+
 private:
-    bool LoadCache( FileManager& fm );
-    void SaveCache( FileManager& fm );
+    bool LoadCache( FileManager& fm, const uint* text_hash );
+    void SaveCache( FileManager& fm, uint text_hash );
     void BindSceneryScript( MapObject* mobj );
+    void SortSceneries();
+    void BuildRegions();
     #endif
 
 public:
@@ -306,6 +318,7 @@ public:
     void       GetMapSceneriesHexEx( ushort hx, ushort hy, uint radius, ushort pid, MapObjectPtrVec& mobjs );
     void       GetMapSceneriesByPid( ushort pid, MapObjectPtrVec& mobjs );
     MapObject* GetMapGrid( ushort hx, ushort hy );
+    uint       GetRegionsCount() { return (uint)RegionHashes.size(); }
     #endif
 };
 typedef vector<ProtoMap>  ProtoMapVec;
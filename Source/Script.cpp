@@ -51,6 +51,7 @@ public:
     string             FuncName;
     string             FuncDecl;
     size_t             NativeFuncAddr;
+    bool               ThreadSafe;
 
     BindFunction( asIScriptFunction* script_func, size_t native_func_addr, const char* module_name,  const char* func_name, const char* func_decl )
     {
@@ -60,6 +61,7 @@ public:
         ModuleName = module_name;
         FuncName = func_name;
         FuncDecl = (func_decl ? func_decl : "");
+        ThreadSafe = (script_func && Script::IsModuleThreadSafe( script_func->GetModuleName() ) );
     }
 };
 typedef vector<BindFunction> BindFunctionVec;
@@ -90,9 +92,11 @@ bool            ConcurrentExecution = false;
 Mutex           ConcurrentExecutionLocker;
 #endif
 
+// Module user data mark for '#pragma threadsafe'
+int             ThreadSafeModuleMark = 0;
+
 #ifdef FOCLASSIC_SERVER
 Mutex ProfilerLocker;
-Mutex ProfilerCallStacksLocker;
 void* ProfilerFileHandle = NULL;
 
 enum EProfilerStage
@@ -106,21 +110,12 @@ enum EProfilerStage
 
 EProfilerStage ProfilerStage = ProfilerUninitialized;
 
-uint           ProfilerSampleInterval = 0;
+volatile uint  ProfilerSampleInterval = 0;
 uint           ScriptTimeoutTime = 0;
 uint           ProfilerTimeoutTime = 0;
 uint           ProfilerSaveInterval = 0;
 bool           ProfilerDynamicDisplay = false;
-
-// extern in AngelScript code
-void CheckProfiler()
-{
-    if( ProfilerSampleInterval )
-    {
-        ProfilerLocker.Unlock();
-        ProfilerLocker.Lock();
-    }
-}
+volatile long  ProfilerSampleSequence = 0;
 
 struct Call
 {
@@ -156,17 +151,67 @@ struct CallPath
     }
 };
 
+void DeleteCallPath( CallPath* path )
+{
+    for( auto it = path->Children.begin(), end = path->Children.end(); it != end; ++it )
+        DeleteCallPath( it->second );
+    delete path;
+}
+
 typedef map<int, CallPath*> IntCallPathMap;
 IntCallPathMap CallPaths;
 uint           TotalCallPaths = 0;
 
+struct FuncSamples
+{
+    uint Self;
+    uint Incl;
+    FuncSamples() : Self( 0 ), Incl( 0 ) {}
+};
+typedef map<int, FuncSamples> IntFuncSamplesMap;
+IntFuncSamplesMap FunctionSamples;
+
 typedef vector<Call>        CallStack;
 vector<CallStack*> Stacks;
 
+// Samples ring, filled by logic thread and drained by timeout thread
+#define PROFILER_RING_SIZE     (256)
+#define PROFILER_MAX_DEPTH     (64)
+
+struct ProfilerSample
+{
+    uint Depth;
+    Call Calls[PROFILER_MAX_DEPTH];
+};
+
+struct ProfilerRing
+{
+    volatile long  Head;
+    volatile long  Tail;
+    ProfilerSample Samples[PROFILER_RING_SIZE];
+    ProfilerRing() : Head( 0 ), Tail( 0 ) {}
+};
+typedef vector<ProfilerRing*> ProfilerRingVec;
+ProfilerRingVec      ProfilerRings;
+THREAD ProfilerRing* CurProfilerRing = NULL; // Owned by thread, freed in FinishThread
+
+// Called under ProfilerLocker
 void ProcessStack( CallStack* stack )
 {
-    SCOPE_LOCK( ProfilerCallStacksLocker );
     TotalCallPaths++;
+
+    FunctionSamples[stack->front().Id].Self++;
+    for( uint i = 0, j = (uint)stack->size(); i < j; i++ )
+    {
+        // Count recursive calls once
+        int  id = (*stack)[i].Id;
+        bool counted = false;
+        for( uint k = 0; k < i && !counted; k++ )
+            counted = ( (*stack)[k].Id == id );
+        if( !counted )
+            FunctionSamples[id].Incl++;
+    }
+
     int       top_id = stack->back().Id;
     CallPath* path;
 
@@ -411,12 +456,12 @@ void Script::Finish()
         return;
 
     EndLog();
-    #ifdef FOCLASSIC_SERVER
-    Profiler::Finish();
-    #endif
     RunTimeoutSuspend = 0;
     RunTimeoutMessage = 0;
     RunTimeoutThread.Wait();
+    #ifdef FOCLASSIC_SERVER
+    Profiler::Finish();
+    #endif
 
     BindedFunctions.clear();
     ScriptPreprocessor->SetPragmaCallback( NULL );
@@ -461,6 +506,18 @@ void Script::FinishThread()
     for( int i = 0; i < GLOBAL_CONTEXT_STACK_SIZE; i++ )
         FinishContext( GlobalCtx[i] );
 
+    #ifdef FOCLASSIC_SERVER
+    if( CurProfilerRing )
+    {
+        ProfilerLocker.Lock();
+        auto it_ring = std::find( ProfilerRings.begin(), ProfilerRings.end(), CurProfilerRing );
+        if( it_ring != ProfilerRings.end() )
+            ProfilerRings.erase( it_ring );
+        ProfilerLocker.Unlock();
+        SAFEDEL( CurProfilerRing );
+    }
+    #endif
+
     asThreadCleanup();
 }
 
@@ -774,7 +831,6 @@ void Script::Profiler::Init()
     }
     ProfilerStage = ProfilerInitialized;
 
-    ProfilerLocker.Lock();
     if( !ProfilerSaveInterval )
         return;
 
@@ -884,16 +940,29 @@ void Script::Profiler::SaveFunctionsData()
 
 void Script::Profiler::Finish()
 {
-    if( !ProfilerSampleInterval )
-        return;
-    if( ProfilerStage != ProfilerWorking )
+    ProfilerSampleInterval = 0;
+    if( ProfilerFileHandle )
     {
-        WriteLogF( _FUNC_, " - Internal profiler error.\n" );
-        return;
-    }
-    ProfilerLocker.Unlock();
-    if( ProfilerSaveInterval )
         FileClose( ProfilerFileHandle );
+        ProfilerFileHandle = NULL;
+    }
+
+    // Rings are still referenced by logic threads, only drop pending samples
+    SCOPE_LOCK( ProfilerLocker );
+    for( auto it = ProfilerRings.begin(), end = ProfilerRings.end(); it != end; ++it )
+        InterlockedExchange( &(*it)->Tail, (*it)->Head );
+}
+
+void Script::Profiler::Enable( uint sample_time )
+{
+    // Runtime sampling, saving to file is available only from start
+    ProfilerDynamicDisplay = true;
+    ProfilerSampleInterval = MAX( sample_time, 1 );
+}
+
+void Script::Profiler::Disable()
+{
+    ProfilerSampleInterval = 0;
 }
 
 // Helper
@@ -930,11 +999,82 @@ void TraverseCallPaths( asIScriptEngine* engine, CallPath* path, vector<OutputLi
         TraverseCallPaths( engine, it->second, lines, depth, max_depth, max_len );
 }
 
+string GetProfilerFuncName( asIScriptEngine* engine, int id )
+{
+    asIScriptFunction* func = engine->GetFunctionById( id );
+    if( !func )
+        return "???";
+    return Str::FormatBuf( "%s@%s", func->GetModuleName(), func->GetDeclaration() );
+}
+
+void TraverseCollapsedStacks( asIScriptEngine* engine, CallPath* path, const string& prefix, string& result )
+{
+    string frames = prefix;
+    if( !frames.empty() )
+        frames += ";";
+    frames += GetProfilerFuncName( engine, path->Id );
+
+    if( path->Excl )
+        result += frames + Str::FormatBuf( " %u\n", path->Excl );
+
+    for( auto it = path->Children.begin(), end = path->Children.end(); it != end; ++it )
+        TraverseCollapsedStacks( engine, it->second, frames, result );
+}
+
+string Script::Profiler::GetFlameGraph()
+{
+    SCOPE_LOCK( ProfilerLocker );
+
+    // Collapsed stacks format, root first
+    string result;
+    for( auto it = CallPaths.begin(), end = CallPaths.end(); it != end; ++it )
+        TraverseCollapsedStacks( GetEngine(), it->second, "", result );
+    return result;
+}
+
+bool Script::Profiler::SaveFlameGraph( string& fname )
+{
+    string data = GetFlameGraph();
+    if( data.empty() )
+        return false;
+
+    DateTime dt;
+    Timer::GetCurrentDateTime( dt );
+
+    char dump_file_path[MAX_FOPATH];
+    FileManager::GetFullPath( NULL, PATH_SERVER_PROFILER, dump_file_path );
+    FileManager::CreateDirectoryTree( dump_file_path );
+
+    char dump_file[MAX_FOPATH];
+    Str::Format( dump_file, "%sFOnlineServer_Profiler_%04u.%02u.%02u_%02u-%02u-%02u.folded",
+                 dump_file_path, dt.Year, dt.Month, dt.Day, dt.Hour, dt.Minute, dt.Second );
+
+    void* f = FileOpen( dump_file, true );
+    if( !f )
+        return false;
+    FileWrite( f, data.c_str(), (uint)data.length() );
+    FileClose( f );
+
+    fname = dump_file;
+    return true;
+}
+
+void Script::Profiler::Clear()
+{
+    SCOPE_LOCK( ProfilerLocker );
+
+    for( auto it = CallPaths.begin(), end = CallPaths.end(); it != end; ++it )
+        DeleteCallPath( it->second );
+    CallPaths.clear();
+    FunctionSamples.clear();
+    TotalCallPaths = 0;
+}
+
 string Script::Profiler::GetStatistics()
 {
     if( !ProfilerDynamicDisplay )
         return "Dynamic display is disabled.";
-    SCOPE_LOCK( ProfilerCallStacksLocker );
+    SCOPE_LOCK( ProfilerLocker );
     if( !TotalCallPaths )
         return "No calls recorded.";
     string             result;
@@ -956,6 +1096,24 @@ string Script::Profiler::GetStatistics()
                      lines[i].Incl, lines[i].Excl );
         result += buf;
     }
+
+    // Per function samples, sorted by self time
+    vector<pair<uint, int>> funcs;
+    funcs.reserve( FunctionSamples.size() );
+    for( auto it = FunctionSamples.begin(), end = FunctionSamples.end(); it != end; ++it )
+        funcs.push_back( PAIR( it->second.Self, it->first ) );
+    std::sort( funcs.begin(), funcs.end(), std::greater<pair<uint, int>>() );
+
+    result += "\n   Self %  Inclusive %  Function\n\n";
+    for( uint i = 0; i < funcs.size(); i++ )
+    {
+        FuncSamples& fs = FunctionSamples[funcs[i].second];
+        Str::Format( buf, "   %6.2f       %6.2f  %s\n",
+                     100.0f * (float)fs.Self / float(TotalCallPaths),
+                     100.0f * (float)fs.Incl / float(TotalCallPaths),
+                     GetProfilerFuncName( GetEngine(), funcs[i].second ).c_str() );
+        result += buf;
+    }
     return result;
 }
 
@@ -1039,16 +1197,20 @@ asIScriptContext* Script::CreateContext()
         return NULL;
     }
 
-    char* buf = new char[CONTEXT_BUFFER_SIZE];
-    if( !buf )
+    ContextData* data = new ContextData();
+    if( !data )
     {
-        WriteLogF( _FUNC_, " - Allocate memory for buffer fail.\n" );
+        WriteLogF( _FUNC_, " - Allocate memory for context data fail.\n" );
         ctx->Release();
         return NULL;
     }
 
-    Str::Copy( buf, CONTEXT_BUFFER_SIZE, "<error>" );
-    ctx->SetUserData( buf );
+    data->CallFunc = "<error>";
+    data->Info[0] = 0;
+    data->Name[0] = 0;
+    data->NameReady = false;
+    data->Profiled = false;
+    ctx->SetUserData( data );
     return ctx;
 }
 
@@ -1056,9 +1218,9 @@ void Script::FinishContext( asIScriptContext*& ctx )
 {
     if( ctx )
     {
-        char* buf = (char*)ctx->GetUserData();
-        if( buf )
-            delete[] buf;
+        ContextData* data = (ContextData*)ctx->GetUserData();
+        if( data )
+            delete data;
         ctx->Release();
         ctx = NULL;
     }
@@ -1070,19 +1232,38 @@ asIScriptContext* Script::GetGlobalContext()
     {
         WriteLogF( _FUNC_, " - Script context stack overflow! Context call stack:\n" );
         for( int i = GLOBAL_CONTEXT_STACK_SIZE - 1; i >= 0; i-- )
-            WriteLog( "  %d) %s.\n", i, GlobalCtx[i]->GetUserData() );
+            WriteLog( "  %d) %s.\n", i, GetContextName( GlobalCtx[i] ) );
         return NULL;
     }
     GlobalCtxIndex++;
     return GlobalCtx[GlobalCtxIndex - 1];
 }
 
+const char* Script::GetContextName( asIScriptContext* ctx )
+{
+    ContextData* data = (ContextData*)ctx->GetUserData();
+    if( !data )
+        return "<error>";
+
+    if( !data->NameReady )
+    {
+        Str::Copy( data->Name, data->CallFunc );
+        if( data->Info[0] )
+        {
+            Str::Append( data->Name, " : " );
+            Str::Append( data->Name, data->Info );
+        }
+        data->NameReady = true;
+    }
+    return data->Name;
+}
+
 void Script::PrintContextCallstack( asIScriptContext* ctx )
 {
     int                      line, column;
     const asIScriptFunction* func;
     int                      stack_size = ctx->GetCallstackSize();
-    WriteLog( "Context<%s>, state<%s>, call stack<%d>:\n", ctx->GetUserData(), ContextStatesStr[(int)ctx->GetState()], stack_size );
+    WriteLog( "Context<%s>, state<%s>, call stack<%d>:\n", GetContextName( ctx ), ContextStatesStr[(int)ctx->GetState()], stack_size );
 
     // Print current function
     if( ctx->GetState() == asEXECUTION_EXCEPTION )
@@ -1296,6 +1477,79 @@ void CollectGarbage( asDWORD flags )
     #endif
 }
 
+#ifdef FOCLASSIC_SERVER
+THREAD long CurProfilerSequence = 0;
+
+// Executed on each script line while profiler is active, takes sample once per interval
+void ProfilerLineCallback( asIScriptContext*, void* )
+{
+    long sequence = ProfilerSampleSequence;
+    if( sequence == CurProfilerSequence )
+        return;
+    CurProfilerSequence = sequence;
+
+    ProfilerRing* ring = CurProfilerRing;
+    if( !ring )
+    {
+        ring = new ProfilerRing();
+        SCOPE_LOCK( ProfilerLocker );
+        ProfilerRings.push_back( ring );
+        CurProfilerRing = ring;
+    }
+
+    // Ring is full, drop sample
+    long head = ring->Head;
+    if( head - ring->Tail >= PROFILER_RING_SIZE )
+        return;
+
+    // Fetch all nested contexts of current thread, innermost first
+    ProfilerSample& sample = ring->Samples[head % PROFILER_RING_SIZE];
+    sample.Depth = 0;
+    for( int i = (int)GlobalCtxIndex - 1; i >= 0 && sample.Depth < PROFILER_MAX_DEPTH; i-- )
+    {
+        asIScriptContext* gctx = GlobalCtx[i];
+        if( gctx->GetState() != asEXECUTION_ACTIVE )
+            continue;
+
+        for( uint j = 0, k = gctx->GetCallstackSize(); j < k && sample.Depth < PROFILER_MAX_DEPTH; j++ )
+        {
+            asIScriptFunction* func = gctx->GetFunction( j );
+            if( func )
+                sample.Calls[sample.Depth++] = Call( func->GetId(), gctx->GetLineNumber( j ) );
+            else
+                sample.Calls[sample.Depth++] = Call( 0, 0 );
+        }
+    }
+
+    if( sample.Depth )
+        InterlockedExchange( &ring->Head, head + 1 );
+}
+
+void ProfilerCollectSamples()
+{
+    SCOPE_LOCK( ProfilerLocker );
+
+    for( auto it = ProfilerRings.begin(), end = ProfilerRings.end(); it != end; ++it )
+    {
+        ProfilerRing* ring = *it;
+        long          tail = ring->Tail;
+        long          head = ring->Head;
+        for( ; tail != head; tail++ )
+        {
+            ProfilerSample& sample = ring->Samples[tail % PROFILER_RING_SIZE];
+            CallStack*      stack = new CallStack( sample.Calls, sample.Calls + sample.Depth );
+
+            ProcessStack( stack );
+            if( ProfilerSaveInterval && ProfilerFileHandle )
+                Stacks.push_back( stack );
+            else
+                delete stack;
+        }
+        InterlockedExchange( &ring->Tail, tail );
+    }
+}
+#endif
+
 void RunTimeout( void* data )
 {
     while( RunTimeoutSuspend )
@@ -1306,54 +1560,10 @@ void RunTimeout( void* data )
         if( ProfilerSampleInterval )
         {
             Thread::Sleep( ProfilerSampleInterval );
-            CallStack*                                     stack = NULL;
-
-            volatile MutexLocker<decltype(ProfilerLocker)> scope_lock__2( ProfilerLocker );
-            SCOPE_LOCK( ActiveGlobalCtxLocker );
-
-            for( auto it = ActiveContexts.begin(), end = ActiveContexts.end(); it != end; ++it )
-            {
-                ActiveContext& actx = *it;
-
-                // Fetch the call stacks
-                for( int i = GLOBAL_CONTEXT_STACK_SIZE - 1; i >= 0; i-- )
-                {
-                    asIScriptContext* ctx = actx.Contexts[i];
-                    if( ctx->GetState() == asEXECUTION_ACTIVE )
-                    {
-                        asIScriptFunction* func;
-                        int                line, column = 0;
-                        uint               stack_size = ctx->GetCallstackSize();
-
-                        // Add new entry
-                        if( !stack )
-                            stack = new CallStack();
-
-                        for( uint j = 0; j < stack_size; j++ )
-                        {
-                            func = ctx->GetFunction( j );
-                            if( func )
-                            {
-                                line = ctx->GetLineNumber( j );
-                                stack->push_back( Call( func->GetId(), line ) );
-                                // WriteLog("%d> %i) %s\n", i, j, func->GetName());
-                            }
-                            else
-                                stack->push_back( Call( 0, 0 ) );
-                        }
-                    }
-                }
-            }
 
-            if( stack )
-            {
-                if( ProfilerDynamicDisplay )
-                    ProcessStack( stack );
-                if( ProfilerSaveInterval )
-                    Stacks.push_back( stack );
-                else
-                    delete stack;
-            }
+            // Request samples from executing threads and collect previous ones
+            InterlockedIncrement( &ProfilerSampleSequence );
+            ProfilerCollectSamples();
 
             uint cur_tick = Timer::FastTick();
 
@@ -1605,6 +1815,7 @@ bool Script::LoadScript( const char* module_name, const char* source, bool skip_
                     if( result >= 0 )
                     {
                         ScriptPreprocessor->GetParsedPragmas() = pragmas;
+                        SetModuleThreadSafe( module, pragmas );
                         modules.push_back( module );
                         return true;
                     }
@@ -1700,6 +1911,8 @@ public:
         return false;
     }
 
+    SetModuleThreadSafe( module, ScriptPreprocessor->GetParsedPragmas() );
+
     // Check not allowed global variables
     if( WrongGlobalObjects.size() )
     {
@@ -1880,6 +2093,27 @@ bool Script::LoadScript( const char* module_name, const uchar* bytecode, uint le
 }
 #endif
 
+void Script::SetModuleThreadSafe( asIScriptModule* module, const StrVec& pragmas )
+{
+    // Pragmas stored as name/text pairs
+    bool thread_safe = false;
+    for( uint i = 0, j = (uint)pragmas.size() / 2; i < j; i++ )
+    {
+        if( pragmas[i * 2] == "threadsafe" )
+        {
+            thread_safe = true;
+            break;
+        }
+    }
+    module->SetUserData( thread_safe ? &ThreadSafeModuleMark : NULL );
+}
+
+bool Script::IsModuleThreadSafe( const char* module_name )
+{
+    asIScriptModule* module = Engine->GetModule( module_name, asGM_ONLY_IF_EXISTS );
+    return module && module->GetUserData() != NULL;
+}
+
 int Script::BindImportedFunctions()
 {
     EngineData*      edata = (EngineData*)Engine->GetUserData();
@@ -1937,6 +2171,44 @@ int Script::BindImportedFunctions()
         }
     }
 
+    // Thread-safe modules may import only from thread-safe modules
+    for( bool changed = true; changed;)
+    {
+        changed = false;
+        for( auto it = modules.begin(), end = modules.end(); it != end; ++it )
+        {
+            asIScriptModule* module = *it;
+            if( !module->GetUserData() )
+                continue;
+
+            for( asUINT i = 0, j = module->GetImportedFunctionCount(); i < j; i++ )
+            {
+                const char* import_module_name = module->GetImportedFunctionSourceModule( i );
+                if( !IsModuleThreadSafe( import_module_name ) )
+                {
+                    WriteLogF( _FUNC_, " - Module<%s> imports from not thread-safe module<%s>, thread-safe mark removed.\n", module->GetName(), import_module_name );
+                    module->SetUserData( NULL );
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    // Marks may be changed, update already binded functions
+    {
+        #ifdef SCRIPT_MULTITHREADING
+        SCOPE_LOCK( BindedFunctionsLocker );
+        #endif
+
+        for( int i = 2, j = (int)BindedFunctions.size(); i < j; i++ )
+        {
+            BindFunction& bf = BindedFunctions[i];
+            if( bf.IsScriptCall )
+                bf.ThreadSafe = IsModuleThreadSafe( bf.ModuleName.c_str() );
+        }
+    }
+
     WriteLog( "Import scripts functions... %s\n", !errors ? "OK" : "failed" );
 
     return errors;
@@ -1980,6 +2252,7 @@ int Script::Bind( const char* module_name, const char* func_name, const char* de
             BindedFunctions[1].IsScriptCall = true;
             BindedFunctions[1].ScriptFunc = script_func;
             BindedFunctions[1].NativeFuncAddr = 0;
+            BindedFunctions[1].ThreadSafe = (module->GetUserData() != NULL);
             return 1;
         }
 
@@ -2020,6 +2293,7 @@ int Script::Bind( const char* module_name, const char* func_name, const char* de
             BindedFunctions[1].IsScriptCall = false;
             BindedFunctions[1].ScriptFunc = NULL;
             BindedFunctions[1].NativeFuncAddr = func;
+            BindedFunctions[1].ThreadSafe = false;
             return 1;
         }
 
@@ -2071,6 +2345,7 @@ int Script::RebindFunctions()
             else
             {
                 bf.ScriptFunc = BindedFunctions[1].ScriptFunc;
+                bf.ThreadSafe = BindedFunctions[1].ThreadSafe;
             }
         }
     }
@@ -2218,6 +2493,7 @@ THREAD size_t            NativeArgs[256] = { 0 };
 THREAD size_t            NativeRetValue[2] = { 0 };   // EAX:EDX
 THREAD size_t            CurrentArg = 0;
 THREAD int               ExecutionRecursionCounter = 0;
+THREAD bool              ExecutionLocked = false;
 
 #ifdef SCRIPT_MULTITHREADING
 uint       SynchronizeThreadId = 0;
@@ -2229,7 +2505,7 @@ typedef vector<EndExecutionCallback> EndExecutionCallbackVec;
 THREAD EndExecutionCallbackVec* EndExecutionCallbacks;
 #endif
 
-void Script::BeginExecution()
+void Script::BeginExecution( bool thread_safe /* = false */ )
 {
     #ifdef SCRIPT_MULTITHREADING
     if( !LogicMT )
@@ -2240,19 +2516,31 @@ void Script::BeginExecution()
         GarbageLocker.EnterCode();
 
         SyncManager* sync_mngr = SyncManager::GetForCurThread();
-        if( !ConcurrentExecution )
+        if( !ConcurrentExecution && !thread_safe )
         {
             sync_mngr->Suspend();
             ConcurrentExecutionLocker.Lock();
             sync_mngr->PushPriority( 5 );
             sync_mngr->Resume();
+            ExecutionLocked = true;
         }
         else
         {
             sync_mngr->PushPriority( 5 );
         }
     }
+    else if( !ConcurrentExecution && !thread_safe && !ExecutionLocked )
+    {
+        // Not thread-safe call from thread-safe module, lock until top level execution ends
+        SyncManager* sync_mngr = SyncManager::GetForCurThread();
+        sync_mngr->Suspend();
+        ConcurrentExecutionLocker.Lock();
+        sync_mngr->Resume();
+        ExecutionLocked = true;
+    }
     ExecutionRecursionCounter++;
+    #else
+    (void)thread_safe;
     #endif
 }
 
@@ -2267,18 +2555,18 @@ void Script::EndExecution()
     {
         GarbageLocker.LeaveCode();
 
-        if( !ConcurrentExecution )
+        if( ExecutionLocked )
         {
             ConcurrentExecutionLocker.Unlock();
-
-            SyncManager* sync_mngr = SyncManager::GetForCurThread();
-            sync_mngr->PopPriority();
+            ExecutionLocked = false;
         }
-        else
-        {
-            SyncManager* sync_mngr = SyncManager::GetForCurThread();
-            sync_mngr->PopPriority();
 
+        SyncManager* sync_mngr = SyncManager::GetForCurThread();
+        sync_mngr->PopPriority();
+
+        // Close section left opened by script
+        if( SynchronizeThreadId == Thread::GetCurrentId() )
+        {
             SynchronizeThreadLocalLocker.Lock();
             bool sync_not_closed = (SynchronizeThreadId == Thread::GetCurrentId() );
             if( sync_not_closed )
@@ -2344,6 +2632,7 @@ bool Script::PrepareContext( int bind_id, const char* call_func, const char* ctx
     bool               is_script = bf.IsScriptCall;
     asIScriptFunction* script_func = bf.ScriptFunc;
     size_t             func_addr = bf.NativeFuncAddr;
+    bool               thread_safe = bf.ThreadSafe;
 
     #ifdef SCRIPT_MULTITHREADING
     if( LogicMT )
@@ -2359,16 +2648,32 @@ bool Script::PrepareContext( int bind_id, const char* call_func, const char* ctx
         if( !ctx )
             return false;
 
-        BeginExecution();
+        BeginExecution( thread_safe );
 
-        Str::Copy( (char*)ctx->GetUserData(), CONTEXT_BUFFER_SIZE, call_func );
-        Str::Append( (char*)ctx->GetUserData(), CONTEXT_BUFFER_SIZE, " : " );
-        Str::Append( (char*)ctx->GetUserData(), CONTEXT_BUFFER_SIZE, ctx_info );
+        // Call function name is static, info may be temporary, so keep only its copy
+        ContextData* data = (ContextData*)ctx->GetUserData();
+        data->CallFunc = call_func;
+        Str::Copy( data->Info, ctx_info );
+        data->NameReady = false;
 
+        #ifdef FOCLASSIC_SERVER
+        // Line callback only while sampling
+        bool profiled = (ProfilerSampleInterval != 0);
+        if( data->Profiled != profiled )
+        {
+            if( profiled )
+                ctx->SetLineCallback( asFUNCTION( ProfilerLineCallback ), NULL, asCALL_CDECL );
+            else
+                ctx->ClearLineCallback();
+            data->Profiled = profiled;
+        }
+        #endif
+
+        // Context never unprepared, so same function reuses previous setup
         int result = ctx->Prepare( script_func );
         if( result < 0 )
         {
-            WriteLogF( _FUNC_, " - Prepare error, context name<%s>, bind_id<%d>, func_id<%d>, error<%s>.\n", ctx->GetUserData(), bind_id, script_func->GetId(), GetASReturnCode( result ) );
+            WriteLogF( _FUNC_, " - Prepare error, context name<%s>, bind_id<%d>, func_id<%d>, error<%s>.\n", GetContextName( ctx ), bind_id, script_func->GetId(), GetASReturnCode( result ) );
             GlobalCtxIndex--;
             EndExecution();
             return false;
@@ -2630,12 +2935,12 @@ bool Script::RunPrepared()
         }
         else if( RunTimeoutMessage && delta >= RunTimeoutMessage )
         {
-            WriteLog( "Script work time<%u> in context<%s>.\n", delta, ctx->GetUserData() );
+            WriteLog( "Script work time<%u> in context<%s>.\n", delta, GetContextName( ctx ) );
         }
 
         if( result < 0 )
         {
-            WriteLogF( _FUNC_, " - Context<%s> execute error<%s>, state<%s>.\n", ctx->GetUserData(), GetASReturnCode( result ), ContextStatesStr[(int)state] );
+            WriteLogF( _FUNC_, " - Context<%s> execute error<%s>, state<%s>.\n", GetContextName( ctx ), GetASReturnCode( result ), ContextStatesStr[(int)state] );
             EndExecution();
             return false;
         }
@@ -2698,9 +3003,7 @@ void* Script::GetReturnedRawAddress()
 bool Script::SynchronizeThread()
 {
     #ifdef SCRIPT_MULTITHREADING
-    if( !ConcurrentExecution )
-        return true;
-
+    // Section taken in serialized execution too, thread-safe scripts run beside it
     SynchronizeThreadLocalLocker.Lock();     // Local lock
 
     if( !SynchronizeThreadId )               // Section is free
@@ -2724,7 +3027,11 @@ bool Script::SynchronizeThread()
 
         SyncManager* sync_mngr = SyncManager::GetForCurThread();
         sync_mngr->Suspend();                                // Allow other threads take objects
+        if( ExecutionLocked )
+            ConcurrentExecutionLocker.Unlock();              // Section owner may call not thread-safe script
         SynchronizeThreadLocker.Wait();                      // Sleep until synchronization section locked
+        if( ExecutionLocked )
+            ConcurrentExecutionLocker.Lock();
         sync_mngr->Resume();                                 // Relock busy objects
         return SynchronizeThread();                          // Try enter again
     }
@@ -2735,9 +3042,6 @@ bool Script::SynchronizeThread()
 bool Script::ResynchronizeThread()
 {
     #ifdef SCRIPT_MULTITHREADING
-    if( !ConcurrentExecution )
-        return true;
-
     SynchronizeThreadLocalLocker.Lock();     // Local lock
 
     if( SynchronizeThreadId == Thread::GetCurrentId() )
@@ -2808,7 +3112,7 @@ void Script::Log( const char* str )
     {
         int line, column;
         line = ctx->GetLineNumber( 0, &column );
-        LogA( Str::FormatBuf( "Script callback: %s : %s : %s : %d, %d : %s.\n", str, func->GetModuleName(), func->GetDeclaration( true ), line, column, ctx->GetUserData() ) );
+        LogA( Str::FormatBuf( "Script callback: %s : %s : %s : %d, %d : %s.\n", str, func->GetModuleName(), func->GetDeclaration( true ), line, column, GetContextName( ctx ) ) );
     }
     else
         LogA( Str::FormatBuf( "%s : %s\n", func->GetModuleName(), str ) );
@@ -2838,7 +3142,7 @@ void Script::LogError( const char* call_func, const char* error )
     }
     int line, column;
     line = ctx->GetLineNumber( 0, &column );
-    LogA( Str::FormatBuf( "%s : Script error: %s : %s : %s : %d, %d : %s.\n", call_func, error, func->GetModuleName(), func->GetDeclaration( true ), line, column, ctx->GetUserData() ) );
+    LogA( Str::FormatBuf( "%s : Script error: %s : %s : %s : %d, %d : %s.\n", call_func, error, func->GetModuleName(), func->GetDeclaration( true ), line, column, GetContextName( ctx ) ) );
 }
 
 void Script::SetLogDebugInfo( bool enabled )
@@ -2863,10 +3167,10 @@ void Script::CallbackException( asIScriptContext* ctx, void* param )
     asIScriptFunction* func = ctx->GetExceptionFunction();
     if( !func )
     {
-        LogA( Str::FormatBuf( "Script exception: %s : %s.\n", ctx->GetExceptionString(), ctx->GetUserData() ) );
+        LogA( Str::FormatBuf( "Script exception: %s : %s.\n", ctx->GetExceptionString(), GetContextName( ctx ) ) );
         return;
     }
-    LogA( Str::FormatBuf( "Script exception: %s : %s : %s : %d, %d : %s.\n", ctx->GetExceptionString(), func->GetModuleName(), func->GetDeclaration( true ), line, column, ctx->GetUserData() ) );
+    LogA( Str::FormatBuf( "Script exception: %s : %s : %s : %d, %d : %s.\n", ctx->GetExceptionString(), func->GetModuleName(), func->GetDeclaration( true ), line, column, GetContextName( ctx ) ) );
 }
 
 /************************************************************************/
@@ -13,6 +13,16 @@
 #define CONTEXT_BUFFER_SIZE          (512)
 
 typedef void ( * EndExecutionCallback )();
+
+// Context user data, name formatted only on demand
+struct ContextData
+{
+    const char* CallFunc;
+    char        Info[CONTEXT_BUFFER_SIZE];
+    char        Name[CONTEXT_BUFFER_SIZE];
+    bool        NameReady;
+    bool        Profiled;
+};
 typedef std::vector<asIScriptModule*> ScriptModuleVec;
 
 struct EngineData
@@ -49,7 +59,12 @@ namespace Script
         void   EndModules();
         void   SaveFunctionsData();
         void   Finish();
+        void   Enable( uint sample_time );
+        void   Disable();
+        void   Clear();
         string GetStatistics();
+        string GetFlameGraph();
+        bool   SaveFlameGraph( string& fname );
         bool   IsActive();
     }
     #endif
@@ -66,6 +81,7 @@ namespace Script
     void              FinishContext( asIScriptContext*& ctx );
     asIScriptContext* GetGlobalContext();
     void              PrintContextCallstack( asIScriptContext* ctx );
+    const char*       GetContextName( asIScriptContext* ctx );
 
     const char*      GetActiveModuleName();
     const char*      GetActiveFuncName();
@@ -83,6 +99,8 @@ namespace Script
     void CallPragmas( const StrVec& pragmas );
     bool LoadScript( const char* module_name, const char* source, bool skip_binary, const char* file_prefix = NULL );
     bool LoadScript( const char* module_name, const uchar* bytecode, uint len );
+    void SetModuleThreadSafe( asIScriptModule* module, const StrVec& pragmas );
+    bool IsModuleThreadSafe( const char* module_name );
 
     int    BindImportedFunctions();
     int    Bind( const char* module_name, const char* func_name, const char* decl, bool is_temp, bool disable_log = false );
@@ -98,7 +116,7 @@ namespace Script
     string        GetScriptFuncName( uint func_num );
 
     // Script execution
-    void BeginExecution();
+    void BeginExecution( bool thread_safe = false );
     void EndExecution();
     void AddEndExecutionCallback( EndExecutionCallback func );
 
@@ -562,6 +562,8 @@ void ScriptPragmaCallback::CallPragma( const string& name, const Preprocessor::P
         bindFuncPragma->Call( instance.Text );
     else if( name == "bindfield" && bindFieldPragma )
         bindFieldPragma->Call( instance.Text );
+    else if( name == "threadsafe" )
+        return;         // Module mark, processed in Script::LoadScript
     else
         WriteLog( "Unknown pragma instance, name<%s> text<%s>.\n", name.c_str(), instance.Text.c_str() );
 }
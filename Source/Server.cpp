@@ -7,6 +7,7 @@
 #include "ConstantsManager.h"
 #include "Critter.h"
 #include "CritterType.h"
+#include "Crypt.h"
 #include "FileSystem.h"
 #include "Ini.h"
 #include "ItemManager.h"
@@ -22,6 +23,7 @@
 #include "ScriptBind.h"
 #include "Server.h"
 #include "SinglePlayer.h"
+#include "TaskGraph.h"
 #include "Text.h"
 #include "Vars.h"
 
@@ -38,9 +40,12 @@ ClVec                       FOServer::LogClients;
 Thread                      FOServer::ListenThread;
 SOCKET                      FOServer::ListenSock = INVALID_SOCKET;
 #if defined (USE_LIBEVENT)
-event_base*                 FOServer::NetIOEventHandler = NULL;
-Thread                      FOServer::NetIOThread;
+event_base**                FOServer::NetIOEventHandlers = NULL;
+Thread*                     FOServer::NetIOThreads = NULL;
 uint                        FOServer::NetIOThreadsCount = 0;
+uint                        FOServer::NetIONextLoop = 0;
+SOCKET*                     FOServer::NetIOListenSocks = NULL;
+Thread*                     FOServer::NetIOListenThreads = NULL;
 #else // IOCP
 HANDLE                      FOServer::NetIOCompletionPort = NULL;
 Thread*                     FOServer::NetIOThreads = NULL;
@@ -55,12 +60,22 @@ PUCharVec                   FOServer::WorldSaveData;
 size_t                      FOServer::WorldSaveDataBufCount = 0;
 size_t                      FOServer::WorldSaveDataBufFreeSize = 0;
 void*                       FOServer::DumpFile = NULL;
+UIntVec                     FOServer::WorldSaveSections;
+FOServer::WorldSaveStream   FOServer::DumpStream;
 MutexEvent                  FOServer::DumpBeginEvent;
 MutexEvent                  FOServer::DumpEndEvent;
 uint                        FOServer::SaveWorldIndex = 0;
 uint                        FOServer::SaveWorldTime = 0;
 uint                        FOServer::SaveWorldNextTick = 0;
 UIntVec                     FOServer::SaveWorldDeleteIndexes;
+uint                        FOServer::SaveWorldRecordsCrc = 0;
+uint                        FOServer::SaveWorldVerifyStep = 0;
+uint                        FOServer::SaveWorldJournalMax = 0;
+uint                        FOServer::SaveWorldJournalCount = 0;
+uint                        FOServer::SaveWorldChangedCount = 0;
+uint                        FOServer::SaveWorldMissedCount = 0;
+bool                        FOServer::SaveWorldJournalReady = false;
+bool                        FOServer::SaveWorldDelta = false;
 Thread                      FOServer::DumpThread;
 Thread*                     FOServer::LogicThreads;
 uint                        FOServer::LogicThreadCount = 0;
@@ -70,7 +85,10 @@ LangPackVec                 FOServer::LangPacks;
 FOServer::HoloInfoMap       FOServer::HolodiskInfo;
 Mutex                       FOServer::HolodiskLocker;
 uint                        FOServer::LastHoloId = 0;
-FOServer::TimeEventVec      FOServer::TimeEvents;
+FOServer::TimeEventMap      FOServer::TimeEvents;
+FOServer::TimeEventQueue    FOServer::TimeEventsQueue;
+FOServer::TimeEventVec      FOServer::TimeEventsInProcess;
+FOServer::TimeEventsStatistics_ FOServer::TimeEventsStatistics;
 uint                        FOServer::TimeEventsLastNum = 0;
 Mutex                       FOServer::TimeEventsLocker;
 FOServer::AnyDataMap        FOServer::AnyData;
@@ -89,15 +107,22 @@ uint                        FOServer::VarsGarbageLastTick = 0;
 FOServer::ClientBannedVec   FOServer::Banned;
 Mutex                       FOServer::BannedLocker;
 FOServer::ClientDataVec     FOServer::ClientsData;
+StrUIntMap                  FOServer::ClientsDataByName;
+UIntMap                     FOServer::ClientsDataById;
 Mutex                       FOServer::ClientsDataLocker;
+Mutex                       FOServer::ClientsDbLocker;
+void*                       FOServer::ClientsDbFile = NULL;
+uint                        FOServer::ClientsDbSize = 0;
+uint                        FOServer::ClientsDbGarbage = 0;
 volatile uint               FOServer::LastClientId = 0;
 ScoreType                   FOServer::BestScores[SCORES_MAX];
 Mutex                       FOServer::BestScoresLocker;
 FOServer::SingleplayerSave_ FOServer::SingleplayerSave;
 MutexSynchronizer           FOServer::LogicThreadSync;
 
-BINARY_SIGNATURE( ClientSaveSignature, BINARY_TYPE_CLIENTSAVE, CLIENT_SAVE_LAST );
-BINARY_SIGNATURE( WorldSaveSignature,  BINARY_TYPE_WORLDSAVE,  WORLD_SAVE_LAST );
+BINARY_SIGNATURE( ClientSaveSignature,  BINARY_TYPE_CLIENTSAVE, CLIENT_SAVE_LAST );
+BINARY_SIGNATURE( WorldSaveSignature,   BINARY_TYPE_WORLDSAVE,  WORLD_SAVE_LAST );
+BINARY_SIGNATURE( WorldSaveSignatureV1, BINARY_TYPE_WORLDSAVE,  WORLD_SAVE_V1 ); // Not packed dumps compaction
 
 bool FOServer::ClientBanned::operator==( const char* name )
 {
@@ -136,6 +161,46 @@ bool FOServer::ClientData::operator==( const uint id )
     return ClientId == id;
 }
 
+FOServer::ClientData* FOServer::AddClientData( const ClientData& data )
+{
+    char key[UTF8_BUF_SIZE( MAX_NAME )];
+    Str::Copy( key, data.ClientName );
+    Str::LowerUTF8( key );
+
+    uint index = (uint)ClientsData.size();
+    ClientsData.push_back( data );
+    ClientsDataByName[key] = index;
+    ClientsDataById[data.ClientId] = index;
+    return &ClientsData[index];
+}
+
+void FOServer::EraseClientData( ClientData* data )
+{
+    char key[UTF8_BUF_SIZE( MAX_NAME )];
+    Str::Copy( key, data->ClientName );
+    Str::LowerUTF8( key );
+
+    ClientsDataByName.erase( key );
+    ClientsDataById.erase( data->ClientId );
+    data->Clear();
+}
+
+FOServer::ClientData* FOServer::GetClientData( const char* name )
+{
+    char key[UTF8_BUF_SIZE( MAX_NAME )];
+    Str::Copy( key, name );
+    Str::LowerUTF8( key );
+
+    auto it = ClientsDataByName.find( key );
+    return it != ClientsDataByName.end() ? &ClientsData[(*it).second] : NULL;
+}
+
+FOServer::ClientData* FOServer::GetClientData( uint id )
+{
+    auto it = ClientsDataById.find( id );
+    return it != ClientsDataById.end() ? &ClientsData[(*it).second] : NULL;
+}
+
 //
 
 FOServer::FOServer()
@@ -208,15 +273,35 @@ void FOServer::Finish()
     ListenThread.Wait();
 
     #if defined (USE_LIBEVENT)
+    // Additional listeners
+    if( NetIOListenSocks )
+    {
+        for( uint i = 1; i < NetIOThreadsCount; i++ )
+        {
+            shutdown( NetIOListenSocks[i], SD_BOTH );
+            closesocket( NetIOListenSocks[i] );
+            NetIOListenSocks[i] = INVALID_SOCKET;
+        }
+        for( uint i = 1; i < NetIOThreadsCount; i++ )
+            NetIOListenThreads[i].Wait();
+        SAFEDELA( NetIOListenSocks );
+        SAFEDELA( NetIOListenThreads );
+    }
+
     // Net IO events
-    event_base* eb = NetIOEventHandler;
-    NetIOEventHandler = NULL;
-    if( eb )
-        event_base_loopbreak( eb );
-    NetIOThread.Wait();
-    if( eb )
-        event_base_free( eb );
-    NetIOThreadsCount = 0;
+    if( NetIOEventHandlers )
+    {
+        event_base** ebs = NetIOEventHandlers;
+        NetIOEventHandlers = NULL;
+        for( uint i = 0; i < NetIOThreadsCount; i++ )
+            event_base_loopbreak( ebs[i] );
+        for( uint i = 0; i < NetIOThreadsCount; i++ )
+            NetIOThreads[i].Wait();
+        for( uint i = 0; i < NetIOThreadsCount; i++ )
+            event_base_free( ebs[i] );
+        delete[] ebs;
+        SAFEDELA( NetIOThreads );
+    }
     #else // IOCP
     for( uint i = 0; i < NetIOThreadsCount; i++ )
         PostQueuedCompletionStatus( NetIOCompletionPort, 0, 1, NULL );
@@ -228,6 +313,9 @@ void FOServer::Finish()
     NetIOCompletionPort = NULL;
     #endif
 
+    // Clients database
+    CloseClientsDb();
+
     // Managers
     AIMngr.Finish();
     MapMngr.Finish();
@@ -250,6 +338,25 @@ void FOServer::Finish()
     WriteLog( "Min cycle period: %u\n", Statistics.LoopMin );
     WriteLog( "Max cycle period: %u\n", Statistics.LoopMax );
     WriteLog( "Count of lags (>100ms): %u\n", Statistics.LagsCount );
+    WriteLog( "Jobs:\n" );
+    WriteLog( "Local: %u\n", Statistics.JobsLocal );
+    WriteLog( "Global: %u\n", Statistics.JobsGlobal );
+    WriteLog( "Stolen: %u\n", Statistics.JobsStolen );
+    WriteLog( "Steal fails: %u\n", Statistics.JobsStealFails );
+    WriteLog( "Sync contentions:\n" );
+    WriteLog( "Critters: %u, items: %u, maps: %u, locations: %u, vars: %u, other: %u\n",
+              Statistics.SyncContentions[SYNC_OBJECT_CRITTER], Statistics.SyncContentions[SYNC_OBJECT_ITEM], Statistics.SyncContentions[SYNC_OBJECT_MAP],
+              Statistics.SyncContentions[SYNC_OBJECT_LOCATION], Statistics.SyncContentions[SYNC_OBJECT_VAR], Statistics.SyncContentions[SYNC_OBJECT_OTHER] );
+    #if defined (USE_LIBEVENT)
+    WriteLog( "Network loops:\n" );
+    for( uint i = 0; i < NetIOThreadsCount; i++ )
+    {
+        Statistics_::NetIOLoop_& loop = Statistics.NetIOLoops[i];
+        WriteLog( "Loop %u: accepted %u, send %u, recv %u, callbacks %u, avg %u mcs, max %u mcs\n", i, loop.Accepted,
+                  (uint)loop.BytesSend, (uint)loop.BytesRecv, loop.Callbacks, (uint)(loop.CallbacksTime / (loop.Callbacks ? loop.Callbacks : 1) ), loop.CallbacksMax );
+    }
+    NetIOThreadsCount = 0;
+    #endif
 
     ActiveInProcess = false;
 }
@@ -405,14 +512,14 @@ void FOServer::RemoveClient( Client* cl )
         // Full delete
         if( cl->Data.ClientToDelete )
         {
-            SaveClientsLocker.Lock();
+            ClientsDataLocker.Lock();
             ClientData* data = GetClientData( id );
             if( data )
-                data->Clear();
-            SaveClientsLocker.Unlock();
+                EraseClientData( data );
+            ClientsDataLocker.Unlock();
 
             cl->FullClear();
-            DeleteClientFile( cl->Name );
+            DeleteClientRecord( cl->Name );
         }
 
         Job::DeferredRelease( cl );
@@ -423,33 +530,11 @@ void FOServer::RemoveClient( Client* cl )
     }
 }
 
-void FOServer::DeleteClientFile( const char* client_name )
+void FOServer::DeleteClientRecord( const char* client_name )
 {
-    // Make old name
-    char clients_path[MAX_FOPATH];
-    FileManager::GetFullPath( "", PATH_SERVER_CLIENTS, clients_path );
-    char old_client_fname[MAX_FOPATH];
-    Str::Format( old_client_fname, "%s%s.client", clients_path, client_name );
-
-    // Make new name
-    char new_client_fname[MAX_FOPATH];
-    for( uint i = 0; ; i++ )
-    {
-        if( !i )
-            Str::Format( new_client_fname, "%s%s.client_deleted", clients_path, client_name, i );
-        else
-            Str::Format( new_client_fname, "%s%s~%u.client_deleted", clients_path, client_name, i );
-        if( FileExist( new_client_fname ) )
-            continue;
-        break;
-    }
-
-    // Rename
-    if( !FileRename( old_client_fname, new_client_fname ) )
-    {
-        WriteLogF( _FUNC_, " - Fail to rename from<%s> to<%s>.\n", old_client_fname, new_client_fname );
-        FileClose( FileOpen( "cache_fail", true ) );
-    }
+    // Mark as deleted, data itself removed at next database compaction
+    if( !AppendClientsDbRecord( client_name, NULL, NULL, NULL, NULL ) )
+        WriteLogF( _FUNC_, " - Fail to delete client<%s>.\n", client_name );
 }
 
 void FOServer::AddSaveClient( Client* cl )
@@ -505,8 +590,6 @@ void FOServer::MainLoop()
     LogicThreads = new Thread[LogicThreadCount];
     for( uint i = 0; i < LogicThreadCount; i++ )
     {
-        Job::PushBack( JOB_THREAD_SYNCHRONIZE );
-
         char thread_name[MAX_FOTEXT];
         if( LogicThreadCount > 1 )
             Str::Format( thread_name, "Logic%u", i );
@@ -615,7 +698,7 @@ void FOServer::MainLoop()
         if( to_delete )
         {
             cr->FullClear();
-            DeleteClientFile( ( (Client*)cr )->Name );
+            DeleteClientRecord( ( (Client*)cr )->Name );
         }
     }
 
@@ -629,7 +712,11 @@ void FOServer::MainLoop()
     Job::SetDeferredReleaseCycle( 0xFFFFFFFF );
     Job::ProcessDeferredReleasing();
 
-    // Save
+    // Save, last dump is full to keep changes not found by checksums yet,
+    // previous dump finished first to not allow journal again
+    if( WorldSaveManager )
+        DumpEndEvent.Wait();
+    SaveWorldJournalReady = false;
     SaveWorld( NULL );
 
     // Last unlock
@@ -657,7 +744,11 @@ void FOServer::Logic_Work( void* data )
     if( !Script::InitThread() )
         return;
 
-    // Add sleep job for current thread
+    // Own jobs queue
+    Job::InitThread();
+
+    // Add sleep and synchronization jobs for current thread
+    Job::PushBack( Job( JOB_THREAD_SYNCHRONIZE, NULL, true ) );
     Job::PushBack( Job( JOB_THREAD_LOOP, NULL, true ) );
 
     // Get synchronize manager
@@ -747,6 +838,14 @@ void FOServer::Logic_Work( void* data )
 
             // Process logic
             ProcessCritter( cr );
+
+            // Sleep until something is due
+            uint next_tick = cr->GetNextProcessTick();
+            if( next_tick )
+            {
+                Job::Schedule( job, next_tick );
+                continue;
+            }
         }
         else if( job.Type == JOB_MAP )
         {
@@ -759,6 +858,14 @@ void FOServer::Logic_Work( void* data )
 
             // Process logic
             map->Process();
+
+            // Sleep until loops or turn based
+            uint next_tick = map->GetNextProcessTick();
+            if( next_tick )
+            {
+                Job::Schedule( job, next_tick );
+                continue;
+            }
         }
         else if( job.Type == JOB_TIME_EVENTS )
         {
@@ -888,8 +995,15 @@ void FOServer::Logic_Work( void* data )
             Statistics.LoopMin = loop_min / count;
             Statistics.LoopMax = loop_max / count;
             Statistics.LagsCount = lags / count;
+            Job::GetStatistics( Statistics.JobsLocal, Statistics.JobsGlobal, Statistics.JobsStolen, Statistics.JobsStealFails );
+            for( int i = 0; i < SYNC_OBJECT_TYPES_COUNT; i++ )
+                Statistics.SyncContentions[i] = (uint)SyncObject::ContentionCount[i];
             stats_locker.Unlock();
 
+            // Return due critters and maps to queue, take jobs from overloaded threads
+            Job::ProcessScheduled();
+            Job::BalanceThread();
+
             // Set real cycle count for deferred releasing
             Job::SetDeferredReleaseCycle( real_min_cycle );
 
@@ -933,21 +1047,43 @@ void FOServer::Logic_Work( void* data )
     }
 
     sync_mngr->UnlockAll();
+    Job::FinishThread();
     Script::FinishThread();
 }
 
-void FOServer::Net_Listen( void* )
+#if defined (USE_LIBEVENT)
+static bool SetReusePort( SOCKET sock )
+{
+    # ifdef SO_REUSEPORT
+    int optval = 1;
+    if( !setsockopt( sock, SOL_SOCKET, SO_REUSEPORT, (char*)&optval, sizeof(optval) ) )
+        return true;
+    WriteLogF( _FUNC_, " - Can't set SO_REUSEPORT to socket, error<%s>.\n", GetLastSocketError() );
+    # endif
+    return false;
+}
+#endif
+
+void FOServer::Net_Listen( void* data )
 {
+    // Listener index, non zero only for SO_REUSEPORT listeners
+    uint listener = (uint)(size_t)data;
+
     while( true )
     {
         // Blocked
+        #if defined (USE_LIBEVENT)
+        SOCKET      listen_sock = (listener ? NetIOListenSocks[listener] : ListenSock);
+        #else
+        SOCKET      listen_sock = ListenSock;
+        #endif
         sockaddr_in from;
         #ifdef FO_WINDOWS
         socklen_t   addrsize = sizeof(from);
-        SOCKET      sock = WSAAccept( ListenSock, (sockaddr*)&from, &addrsize, NULL, NULL );
+        SOCKET      sock = WSAAccept( listen_sock, (sockaddr*)&from, &addrsize, NULL, NULL );
         #else
         socklen_t   addrsize = sizeof(from);
-        SOCKET      sock = accept( ListenSock, (sockaddr*)&from, &addrsize );
+        SOCKET      sock = accept( listen_sock, (sockaddr*)&from, &addrsize );
         #endif
         if( sock == INVALID_SOCKET )
         {
@@ -1008,8 +1144,9 @@ void FOServer::Net_Listen( void* )
         cl->ZstrmInit = true;
 
         #if defined (USE_LIBEVENT)
-        // Net IO events handling
-        bufferevent* bev = bufferevent_socket_new( NetIOEventHandler, sock, BEV_OPT_THREADSAFE );   // BEV_OPT_DEFER_CALLBACKS
+        // Net IO events handling, each listener of SO_REUSEPORT feeds own loop, single listener distributes clients round-robin
+        uint         loop = (NetIOListenSocks ? listener : NetIONextLoop++ % NetIOThreadsCount);
+        bufferevent* bev = bufferevent_socket_new( NetIOEventHandlers[loop], sock, BEV_OPT_THREADSAFE );   // BEV_OPT_DEFER_CALLBACKS
         if( !bev )
         {
             WriteLogF( _FUNC_, " - Create new buffer event fail.\n" );
@@ -1065,7 +1202,9 @@ void FOServer::Net_Listen( void* )
         Client::NetIOArg* arg = new Client::NetIOArg();
         arg->PClient = cl;
         arg->BEV = bev;
+        arg->Loop = loop;
         cl->NetIOArgPtr = arg;
+        Statistics.NetIOLoops[loop].Accepted++;
         cl->AddRef();         // Released in Shutdown
         bufferevent_setcb( bev, NetIO_Input, NetIO_Output, NetIO_Event, cl->NetIOArgPtr );
 
@@ -1081,13 +1220,16 @@ void FOServer::Net_Listen( void* )
 
 #if defined (USE_LIBEVENT)
 
-void FOServer::NetIO_Loop( void* )
+void FOServer::NetIO_Loop( void* data )
 {
+    uint loop = (uint)(size_t)data;
+
     while( true )
     {
-        event_base* eb = NetIOEventHandler;
-        if( !eb )
+        event_base** ebs = NetIOEventHandlers;
+        if( !ebs )
             break;
+        event_base*  eb = ebs[loop];
 
         int result = event_base_loop( eb, 0 );
 
@@ -1120,12 +1262,30 @@ void CheckThreadName()
     }
 }
 
+// Callbacks processing time of network loop
+struct NetIOLoopTimer
+{
+    FOServer::Statistics_::NetIOLoop_& Stat;
+    double                             Begin;
+
+    NetIOLoopTimer( uint loop ): Stat( FOServer::Statistics.NetIOLoops[loop] ), Begin( Timer::AccurateTick() ) {}
+    ~NetIOLoopTimer()
+    {
+        uint time = (uint)( (Timer::AccurateTick() - Begin) * 1000.0 );
+        Stat.Callbacks++;
+        Stat.CallbacksTime += time;
+        if( time > Stat.CallbacksMax )
+            Stat.CallbacksMax = time;
+    }
+};
+
 void FOServer::NetIO_Event( bufferevent* bev, short what, void* arg )
 {
     CheckThreadName();
 
     Client::NetIOArg* arg_ = (Client::NetIOArg*)arg;
     SCOPE_LOCK( arg_->Locker );
+    NetIOLoopTimer    loop_timer( arg_->Loop );
     Client*           cl = arg_->PClient;
 
     # if !defined (LIBEVENT_TIMEOUTS_WORKAROUND)
@@ -1174,6 +1334,7 @@ void FOServer::NetIO_Input( bufferevent* bev, void* arg )
 
     Client::NetIOArg* arg_ = (Client::NetIOArg*)arg;
     SCOPE_LOCK( arg_->Locker );
+    NetIOLoopTimer    loop_timer( arg_->Loop );
     Client*           cl = arg_->PClient;
 
     if( cl->IsOffline() )
@@ -1216,6 +1377,7 @@ void FOServer::NetIO_Input( bufferevent* bev, void* arg )
         {
             cl->Bin.Unlock();
             Statistics.BytesRecv += read_len;
+            Statistics.NetIOLoops[arg_->Loop].BytesRecv += read_len;
         }
     }
 }
@@ -1226,8 +1388,14 @@ void FOServer::NetIO_Output( bufferevent* bev, void* arg )
 
     Client::NetIOArg* arg_ = (Client::NetIOArg*)arg;
     SCOPE_LOCK( arg_->Locker );
+    NetIOLoopTimer    loop_timer( arg_->Loop );
     Client*           cl = arg_->PClient;
 
+    // Previous data still not sent, all accumulated data flushed in write callback after drain
+    evbuffer* output = bufferevent_get_output( bev );
+    if( evbuffer_get_length( output ) )
+        return;
+
     cl->Bout.Lock();
     if( cl->Bout.IsEmpty() )   // Nothing to send
     {
@@ -1237,22 +1405,49 @@ void FOServer::NetIO_Output( bufferevent* bev, void* arg )
         return;
     }
 
-    // Compress
-    const uint         output_buffer_len = 100000; // 100kb
-    static THREAD char output_buffer[output_buffer_len];
-    uint               write_len = 0;
+    uint real = cl->Bout.GetEndPos() - cl->Bout.GetCurPos();
+    uint write_len = 0;
+
+    // Compress directly to socket output buffer
     if( !GameOpt.DisableZlibCompression && !cl->DisableZlib )
     {
-        uint to_compr = cl->Bout.GetEndPos();
-        if( to_compr > output_buffer_len )
-            to_compr = output_buffer_len;
-
         cl->Zstrm.next_in = (uchar*)cl->Bout.GetCurData();
-        cl->Zstrm.avail_in = to_compr;
-        cl->Zstrm.next_out = (uchar*)output_buffer;
-        cl->Zstrm.avail_out = output_buffer_len;
+        cl->Zstrm.avail_in = real;
 
-        if( deflate( &cl->Zstrm, Z_SYNC_FLUSH ) != Z_OK )
+        bool fail = false;
+        while( !fail )
+        {
+            evbuffer_iovec vec;
+            uint           reserve = (uint)deflateBound( &cl->Zstrm, cl->Zstrm.avail_in ) + 16;
+            if( evbuffer_reserve_space( output, reserve, &vec, 1 ) != 1 )
+            {
+                fail = true;
+                break;
+            }
+
+            cl->Zstrm.next_out = (uchar*)vec.iov_base;
+            cl->Zstrm.avail_out = (uint)vec.iov_len;
+            int result = deflate( &cl->Zstrm, Z_SYNC_FLUSH );
+            if( result != Z_OK && !(result == Z_BUF_ERROR && !cl->Zstrm.avail_in) )
+            {
+                fail = true;
+                break;
+            }
+
+            vec.iov_len = (uchar*)cl->Zstrm.next_out - (uchar*)vec.iov_base;
+            write_len += (uint)vec.iov_len;
+            if( evbuffer_commit_space( output, &vec, 1 ) )
+            {
+                fail = true;
+                break;
+            }
+
+            // Output space not exhausted means all input processed and flushed
+            if( cl->Zstrm.avail_out )
+                break;
+        }
+
+        if( fail )
         {
             WriteLogF( _FUNC_, " - Deflate fail.\n" );
             cl->Disconnect();
@@ -1261,40 +1456,26 @@ void FOServer::NetIO_Output( bufferevent* bev, void* arg )
             cl->Shutdown();
             return;
         }
-
-        uint compr = cl->Zstrm.next_out - (uchar*)output_buffer;
-        uint real = cl->Zstrm.next_in - (uchar*)cl->Bout.GetCurData();
-        write_len = compr;
-        cl->Bout.Cut( real );
-        Statistics.DataReal += real;
-        Statistics.DataCompressed += compr;
     }
     // Without compressing
     else
     {
-        uint len = cl->Bout.GetEndPos();
-        if( len > output_buffer_len )
-            len = output_buffer_len;
-        memcpy( output_buffer, cl->Bout.GetCurData(), len );
-        write_len = len;
-        cl->Bout.Cut( len );
-        Statistics.DataReal += len;
-        Statistics.DataCompressed += len;
+        if( evbuffer_add( output, cl->Bout.GetCurData(), real ) )
+        {
+            WriteLogF( _FUNC_, " - Send fail.\n" );
+            cl->Bout.Unlock();
+            cl->Shutdown();
+            return;
+        }
+        write_len = real;
     }
-    if( cl->Bout.IsEmpty() )
-        cl->Bout.Reset();
+    cl->Bout.Reset();
     cl->Bout.Unlock();
 
-    // Append to buffer
-    if( bufferevent_write( bev, output_buffer, write_len ) )
-    {
-        WriteLogF( _FUNC_, " - Send fail.\n" );
-        cl->Shutdown();
-    }
-    else
-    {
-        Statistics.BytesSend += write_len;
-    }
+    Statistics.DataReal += real;
+    Statistics.DataCompressed += write_len;
+    Statistics.BytesSend += write_len;
+    Statistics.NetIOLoops[arg_->Loop].BytesSend += write_len;
 }
 
 #else // IOCP
@@ -2186,7 +2367,7 @@ void FOServer::Process_Command( BufferManager& buf, void (*logcb)( const char* )
 
             CHECK_ALLOW_COMMAND;
 
-            SaveClientsLocker.Lock();
+            ClientsDataLocker.Lock();
 
             ClientData* cd = GetClientData( name );
             if( cd )
@@ -2194,7 +2375,7 @@ void FOServer::Process_Command( BufferManager& buf, void (*logcb)( const char* )
             else
                 logcb( "Client not found." );
 
-            SaveClientsLocker.Unlock();
+            ClientsDataLocker.Unlock();
             break;
         }
         case COMMAND_MOVECRIT:
@@ -3171,7 +3352,7 @@ void FOServer::Process_Command( BufferManager& buf, void (*logcb)( const char* )
             }
             else
             {
-                SCOPE_LOCK( SaveClientsLocker );
+                SCOPE_LOCK( ClientsDataLocker );
 
                 ClientData* data = GetClientData( cl_->GetId() );
                 if( data )
@@ -3248,6 +3429,45 @@ void FOServer::Process_Command( BufferManager& buf, void (*logcb)( const char* )
             ResynchronizeLogicThreads();
             break;
         }
+        case COMMAND_PROFILER:
+        {
+            char action[16];
+            uint sample_time;
+            buf.Pop( action, 16 );
+            buf >> sample_time;
+            action[15] = 0;
+
+            CHECK_ALLOW_COMMAND;
+
+            if( Str::CompareCase( action, "on" ) )
+            {
+                Script::Profiler::Enable( sample_time ? sample_time : 10 );
+                logcb( "Profiler enabled." );
+            }
+            else if( Str::CompareCase( action, "off" ) )
+            {
+                Script::Profiler::Disable();
+                logcb( "Profiler disabled." );
+            }
+            else if( Str::CompareCase( action, "dump" ) )
+            {
+                string fname;
+                if( Script::Profiler::SaveFlameGraph( fname ) )
+                    logcb( Str::FormatBuf( "Profiler stacks saved to '%s'.", fname.c_str() ) );
+                else
+                    logcb( "No samples to save." );
+            }
+            else if( Str::CompareCase( action, "clear" ) )
+            {
+                Script::Profiler::Clear();
+                logcb( "Profiler data cleared." );
+            }
+            else
+            {
+                logcb( "Wrong action. Valid is 'on', 'off', 'dump', 'clear'." );
+            }
+            break;
+        }
         default:
             logcb( "Unknown command." );
             break;
@@ -3414,6 +3634,64 @@ bool FOServer::Init()
     return Active;
 }
 
+bool FOServer::CompileMaps()
+{
+    // Maps are compiled in parallel by location prototypes loading
+    if( !InitReal() )
+    {
+        WriteLog( "Maps compilation fail.\n" );
+        return false;
+    }
+
+    WriteLog( "Validate compiled maps...\n" );
+
+    uint   maps = 0;
+    uint   errors = 0;
+    double text_time = 0.0;
+    double cache_time = 0.0;
+    for( ushort pid = 1; pid < MAX_PROTO_MAPS; pid++ )
+    {
+        ProtoMap& pmap = MapMngr.ProtoMaps[pid];
+        if( !pmap.IsInit() )
+            continue;
+
+        maps++;
+
+        // Text
+        ProtoMap pmap_text;
+        ProtoMap::CacheMode = MAP_CACHE_IGNORE;
+        double   tick = Timer::AccurateTick();
+        bool     text_ok = pmap_text.Init( pid, pmap.GetName(), PATH_SERVER_MAPS );
+        text_time += Timer::AccurateTick() - tick;
+
+        // Cache
+        ProtoMap pmap_cache;
+        ProtoMap::CacheMode = MAP_CACHE_ONLY;
+        tick = Timer::AccurateTick();
+        bool cache_ok = pmap_cache.Init( pid, pmap.GetName(), PATH_SERVER_MAPS );
+        cache_time += Timer::AccurateTick() - tick;
+
+        // Cache must give same map as text
+        if( !text_ok || !cache_ok ||
+            memcmp( &pmap_text.Header, &pmap_cache.Header, sizeof(pmap_text.Header) ) ||
+            pmap_text.HashRegions != pmap_cache.HashRegions || pmap_text.RegionHashes != pmap_cache.RegionHashes ||
+            pmap_text.CrittersVec.size() != pmap_cache.CrittersVec.size() || pmap_text.ItemsVec.size() != pmap_cache.ItemsVec.size() ||
+            pmap_text.SceneryVec.size() != pmap_cache.SceneryVec.size() || pmap_text.GridsVec.size() != pmap_cache.GridsVec.size() ||
+            memcmp( pmap_text.HexFlags, pmap_cache.HexFlags, pmap_text.Header.MaxHexX * pmap_text.Header.MaxHexY ) )
+        {
+            WriteLog( "Map<%u:%s> validation fail.\n", pid, pmap.GetName() );
+            errors++;
+        }
+
+        pmap_text.Clear();
+        pmap_cache.Clear();
+    }
+    ProtoMap::CacheMode = MAP_CACHE_DEFAULT;
+
+    WriteLog( "Validate compiled maps... maps<%u>, errors<%u>, text load<%.2f ms>, cache load<%.2f ms>.\n", maps, errors, text_time, cache_time );
+    return errors == 0;
+}
+
 bool FOServer::InitReal()
 {
     FileManager::InitDataFiles( DIR_SLASH_SD );
@@ -3468,9 +3746,7 @@ bool FOServer::InitReal()
     // Threading
     LogicThreadSetAffinity = ConfigFile->GetInt( "Server", "LogicThreadSetAffinity", 0 ) > 0;
     LogicThreadCount = ConfigFile->GetInt( "Server", "LogicThreadCount", 0 );
-    if( sample_time )
-        LogicThreadCount = 1;
-    else if( !LogicThreadCount )
+    if( !LogicThreadCount )
         LogicThreadCount = CpuCount;
     if( LogicThreadCount == 1 )
         Script::SetConcurrentExecution( false );
@@ -3489,49 +3765,101 @@ bool FOServer::InitReal()
     FileManager::CreateDirectoryTree( FileManager::GetFullPath( "", PATH_SERVER_BANS ) );
 
     ConstantsManager::Initialize( PATH_SERVER_DATA ); // Generate name of defines
-    if( !InitLangPacks( LangPacks ) )
-        return false;                                 // Language packs
-    if( !InitScriptSystem() )
-        return false;                                 // Script system
-    if( !ReloadExternalScripts( SCRIPT_BIND_MAPPER ) )
-    {}                                                // Mapper scripts
-    if( !ReloadExternalScripts( SCRIPT_BIND_CLIENT ) )
-        return false;                                 // Client scripts, after language packs initialization
-    if( !Singleplayer && !LoadClientsData() )
+
+    // Loading stages, independent ones run in parallel
+    struct InitStage_
+    {
+        static bool LangPacks( void* )   { return InitLangPacks( FOServer::LangPacks ); }
+        static bool ClientsData( void* ) { return LoadClientsData(); }
+        static bool Bans( void* )
+        {
+            LoadBans();
+            return true;
+        }
+        static bool Scripts( void* )
+        {
+            if( !InitScriptSystem() )
+                return false;                        // Script system
+            if( !ReloadExternalScripts( SCRIPT_BIND_MAPPER ) )
+            {}                                       // Mapper scripts
+            return ReloadExternalScripts( SCRIPT_BIND_CLIENT ); // Client scripts, after language packs initialization
+        }
+        static bool Managers( void* )
+        {
+            if( !AIMngr.Init() )
+                return false;                        // NpcAi manager
+            if( !ItemMngr.Init() )
+                return false;                        // Item manager
+            if( !CrMngr.Init() )
+                return false;                        // Critter manager
+            if( !MapMngr.Init() )
+                return false;                        // Map manager
+            return VarMngr.Init( FileManager::GetFullPath( "", PATH_SERVER_SCRIPTS ) ); // Var Manager (only before dialog manager!)
+        }
+        static bool Dialogs( void* threads )        { return DlgMngr.LoadDialogs( DIALOGS_LST_NAME, *(uint*)threads ); }
+        static bool DialogTexts( void* )            { return InitLangPacksDialogs( FOServer::LangPacks ); }
+        static bool Crafts( void* )                 { return InitCrafts( FOServer::LangPacks ); }
+        static bool CritterTypes( void* )           { return InitLangCrTypes( FOServer::LangPacks ); }
+        static bool ItemProtos( void* )             { return ItemMngr.LoadProtos(); }
+        static bool CritterProtos( void* )          { return CrMngr.LoadProtos(); }
+        static bool Locations( void* threads )      { return MapMngr.LoadLocationsProtos( *(uint*)threads ); }
+        static bool ProtoFunctions( void* )         { return ItemMngr.CheckProtoFunctions(); }
+    };
+
+    // Maps binary cache
+    bool compile_maps = CommandLine->IsOption( "CompileMaps" );
+    if( compile_maps )
+        ProtoMap::CacheMode = MAP_CACHE_REBUILD;
+    else if( ConfigFile->GetBool( "Server", "MapCacheOnly", false ) )
+        ProtoMap::CacheMode = MAP_CACHE_ONLY;
+    else
+        ProtoMap::CacheMode = MAP_CACHE_DEFAULT;
+
+    uint init_threads = ConfigFile->GetInt( "Server", "InitThreadCount", 0 );
+    if( !init_threads )
+        init_threads = CpuCount;
+
+    // Script engine is not thread safe, so all stages that compile or bind scripts are ordered
+    // Script system initializes contexts of current thread, so it runs here
+    TaskGraph init;
+    uint      lang_packs = init.AddTask( "LangPacks", InitStage_::LangPacks );
+    uint      scripts = init.AddTask( "Scripts", InitStage_::Scripts, NULL, true );
+    init.AddDependency( scripts, lang_packs );
+    if( !Singleplayer && !compile_maps ) // Maps compilation must not touch live server data
+    {
+        init.AddTask( "ClientsData", InitStage_::ClientsData );
+        init.AddTask( "Bans", InitStage_::Bans );
+    }
+    uint managers = init.AddTask( "Managers", InitStage_::Managers );
+    init.AddDependency( managers, scripts );
+    uint crtypes = init.AddTask( "CritterTypes", InitStage_::CritterTypes ); // Shares internal texts with client scripts
+    init.AddDependency( crtypes, scripts );
+    uint item_protos = init.AddTask( "ItemProtos", InitStage_::ItemProtos );
+    init.AddDependency( item_protos, managers );
+    uint crafts = init.AddTask( "Crafts", InitStage_::Crafts );
+    init.AddDependency( crafts, item_protos );
+    uint cr_protos = init.AddTask( "CritterProtos", InitStage_::CritterProtos );
+    init.AddDependency( cr_protos, managers );
+    init.AddDependency( cr_protos, crtypes );
+    uint dialogs = init.AddTask( "Dialogs", InitStage_::Dialogs, &init_threads );
+    init.AddDependency( dialogs, item_protos );
+    uint locations = init.AddTask( "Locations", InitStage_::Locations, &init_threads );
+    init.AddDependency( locations, item_protos );
+    init.AddDependency( locations, cr_protos );
+    uint proto_funcs = init.AddTask( "ProtoFunctions", InitStage_::ProtoFunctions );
+    init.AddDependency( proto_funcs, item_protos );
+    uint dlg_texts = init.AddTask( "DialogTexts", InitStage_::DialogTexts ); // Create FONPC.MSG, FODLG.MSG, changes default randomizer
+    for( uint i = 0; i < dlg_texts; i++ )
+        init.AddDependency( dlg_texts, i );
+
+    bool init_ok = init.Run( init_threads );
+    WriteLog( "Initialization stages, threads<%u>:\n%s", init_threads, init.GetTimingReport().c_str() );
+    if( !init_ok )
         return false;
-    if( !Singleplayer )
-        LoadBans();
 
-    // Managers
-    if( !AIMngr.Init() )
-        return false;                    // NpcAi manager
-    if( !ItemMngr.Init() )
-        return false;                    // Item manager
-    if( !CrMngr.Init() )
-        return false;                    // Critter manager
-    if( !MapMngr.Init() )
-        return false;                    // Map manager
-    if( !VarMngr.Init( FileManager::GetFullPath( "", PATH_SERVER_SCRIPTS ) ) )
-        return false;                    // Var Manager (only before dialog manager!)
-    if( !DlgMngr.LoadDialogs( DIALOGS_LST_NAME ) )
-        return false;                    // Dialog manager
-    if( !InitLangPacksDialogs( LangPacks ) )
-        return false;                    // Create FONPC.MSG, FODLG.MSG, need call after InitLangPacks and DlgMngr.LoadDialogs
-    if( !InitCrafts( LangPacks ) )
-        return false;                    // MrFixit
-    if( !InitLangCrTypes( LangPacks ) )
-        return false;                    // Critter types
-    // if(!MapMngr.LoadRelief()) return false; // Global map relief
-
-    // Prototypes
-    if( !ItemMngr.LoadProtos() )
-        return false;                          // Proto items
-    if( !CrMngr.LoadProtos() )
-        return false;                          // Proto critters
-    if( !MapMngr.LoadLocationsProtos() )
-        return false;                          // Proto locations and maps
-    if( !ItemMngr.CheckProtoFunctions() )
-        return false;                          // Check valid of proto functions
+    // Only prototypes are needed to compile maps, see CompileMaps
+    if( compile_maps )
+        return true;
 
     // Initialization script
     Script::PrepareContext( ServerFunctions.Init, _FUNC_, "Game" );
@@ -3575,6 +3903,23 @@ bool FOServer::InitReal()
     ListenSock = socket( AF_INET, SOCK_STREAM, 0 );
     #endif
 
+    NetIOThreadsCount = ConfigFile->GetInt( "Server", "NetWorkThread", 0 );
+    if( !NetIOThreadsCount )
+        NetIOThreadsCount = CpuCount;
+
+    #if defined (USE_LIBEVENT)
+    if( NetIOThreadsCount > NETIO_MAX_LOOPS )
+        NetIOThreadsCount = NETIO_MAX_LOOPS;
+
+    // Separate listener for each loop, kernel balance connections between them
+    bool reuse_port = false;
+    # ifdef SO_REUSEPORT
+    reuse_port = (!Singleplayer && NetIOThreadsCount > 1 && ConfigFile->GetInt( "Server", "NetReusePort", 0 ) != 0);
+    # endif
+    if( reuse_port && !SetReusePort( ListenSock ) )
+        reuse_port = false;
+    #endif
+
     ushort port;
     if( !Singleplayer )
     {
@@ -3617,10 +3962,6 @@ bool FOServer::InitReal()
         return false;
     }
 
-    NetIOThreadsCount = ConfigFile->GetInt( "Server", "NetWorkThread", 0 );
-    if( !NetIOThreadsCount )
-        NetIOThreadsCount = CpuCount;
-
     #if defined (USE_LIBEVENT)
     // Net IO events initialization
     struct ELCB
@@ -3642,25 +3983,82 @@ bool FOServer::InitReal()
     evthread_use_pthreads();
     # endif
 
-    event_config* event_cfg = event_config_new();
-    # ifdef FO_WINDOWS
-    event_config_set_flag( event_cfg, EVENT_BASE_FLAG_STARTUP_IOCP );
-    # endif
-    event_config_set_num_cpus_hint( event_cfg, NetIOThreadsCount );
-    NetIOEventHandler = event_base_new_with_config( event_cfg );
-    event_config_free( event_cfg );
-    if( !NetIOEventHandler )
+    // Event loop per thread
+    event_base** ebs = new event_base*[NetIOThreadsCount];
+    for( uint i = 0; i < NetIOThreadsCount; i++ )
     {
-        WriteLog( "Can't create Net IO events handler.\n" );
-        closesocket( ListenSock );
-        return false;
+        event_config* event_cfg = event_config_new();
+        # ifdef FO_WINDOWS
+        event_config_set_flag( event_cfg, EVENT_BASE_FLAG_STARTUP_IOCP );
+        # endif
+        event_config_set_num_cpus_hint( event_cfg, 1 );
+        ebs[i] = event_base_new_with_config( event_cfg );
+        event_config_free( event_cfg );
+        if( !ebs[i] )
+        {
+            WriteLog( "Can't create Net IO events handler.\n" );
+            for( uint j = 0; j < i; j++ )
+                event_base_free( ebs[j] );
+            delete[] ebs;
+            closesocket( ListenSock );
+            return false;
+        }
+    }
+    NetIOEventHandlers = ebs;
+
+    // Additional listeners on same port
+    if( reuse_port )
+    {
+        NetIOListenSocks = new SOCKET[NetIOThreadsCount];
+        NetIOListenThreads = new Thread[NetIOThreadsCount];
+        NetIOListenSocks[0] = ListenSock;
+        for( uint i = 1; i < NetIOThreadsCount; i++ )
+        {
+            SOCKET sock = socket( AF_INET, SOCK_STREAM, 0 );
+            if( sock == INVALID_SOCKET || !SetReusePort( sock ) || bind( sock, (sockaddr*)&sin, sizeof(sin) ) == SOCKET_ERROR ||
+                listen( sock, SOMAXCONN ) == SOCKET_ERROR )
+            {
+                WriteLog( "Can't create listener<%u> with SO_REUSEPORT, error<%s>.\n", i, GetLastSocketError() );
+                if( sock != INVALID_SOCKET )
+                    closesocket( sock );
+                for( uint j = 1; j < i; j++ )
+                    closesocket( NetIOListenSocks[j] );
+                SAFEDELA( NetIOListenSocks );
+                SAFEDELA( NetIOListenThreads );
+                break;
+            }
+            NetIOListenSocks[i] = sock;
+        }
+    }
+
+    NetIOThreads = new Thread[NetIOThreadsCount];
+    for( uint i = 0; i < NetIOThreadsCount; i++ )
+    {
+        char thread_name[MAX_FOTEXT];
+        if( NetIOThreadsCount > 1 )
+            Str::Format( thread_name, "NetLoop%u", i );
+        else
+            Str::Format( thread_name, "NetLoop" );
+        NetIOThreads[i].Start( NetIO_Loop, thread_name, (void*)(size_t)i );
     }
-    NetIOThread.Start( NetIO_Loop, "NetLoop" );
     WriteLog( "Network IO threads started, count<%u>.\n", NetIOThreadsCount );
 
     // Listen
     ListenThread.Start( Net_Listen, "NetListen" );
-    WriteLog( "Network listen thread started.\n" );
+    if( NetIOListenSocks )
+    {
+        for( uint i = 1; i < NetIOThreadsCount; i++ )
+        {
+            char thread_name[MAX_FOTEXT];
+            Str::Format( thread_name, "NetListen%u", i );
+            NetIOListenThreads[i].Start( Net_Listen, thread_name, (void*)(size_t)i );
+        }
+        WriteLog( "Network listen threads started with SO_REUSEPORT, count<%u>.\n", NetIOThreadsCount );
+    }
+    else
+    {
+        WriteLog( "Network listen thread started.\n" );
+    }
 
     # if defined (LIBEVENT_TIMEOUTS_WORKAROUND)
     Client::SendData = &NetIO_Output;
@@ -3750,6 +4148,7 @@ bool FOServer::InitReal()
         DumpThread.Start( Dump_Work, "WorldSaveManager" );
     }
     SaveWorldTime = ConfigFile->GetInt( "Server", "WorldSaveTime", 60 ) * 60 * 1000;
+    SaveWorldJournalMax = ConfigFile->GetInt( "Server", "WorldSaveJournal", 10 );
     SaveWorldNextTick = Timer::FastTick() + SaveWorldTime;
 
     Active = true;
@@ -4124,8 +4523,6 @@ bool FOServer::LoadClientsData()
     LastClientId = 0;
     ClientsData.reserve( 10000 );
 
-    bool success = false;
-    char client_name[MAX_FOPATH];
     char clients_path[MAX_FOPATH];
     FileManager::GetFullPath( "", PATH_SERVER_CLIENTS, clients_path );
 
@@ -4146,6 +4543,86 @@ bool FOServer::LoadClientsData()
         delete[] buf;
     }
 
+    // Import separate client files to database, once
+    char db_fname[MAX_FOPATH];
+    Str::Format( db_fname, "%s%s", clients_path, CLIENTS_DB_FNAME );
+    char db_bak_fname[MAX_FOPATH];
+    Str::Format( db_bak_fname, "%s%s.bak", clients_path, CLIENTS_DB_FNAME );
+    if( !FileExist( db_fname ) && FileExist( db_bak_fname ) )
+        FileRename( db_bak_fname, db_fname );  // Compaction interrupted
+    if( !FileExist( db_fname ) )
+    {
+        if( !LoadClientsFiles() )
+            return false;
+
+        WriteLog( "Import clients data...\n" );
+        char db_tmp_fname[MAX_FOPATH];
+        Str::Format( db_tmp_fname, "%s%s.tmp", clients_path, CLIENTS_DB_FNAME );
+        ClientsDbFile = FileOpen( db_tmp_fname, true, true );
+        if( !ClientsDbFile || !FileWrite( ClientsDbFile, ClientSaveSignature, sizeof(ClientSaveSignature) ) )
+        {
+            WriteLog( "Unable to create clients database<%s>.\n", db_tmp_fname );
+            CloseClientsDb();
+            return false;
+        }
+        ClientsDbSize = sizeof(ClientSaveSignature);
+        ClientsDbGarbage = 0;
+
+        uint imported = 0;
+        for( uint i = 0; i < ClientsData.size(); i++ )
+        {
+            ClientData& cd = ClientsData[i];
+            if( !cd.ClientId )
+                continue;
+            if( ImportClientFile( cd ) )
+                imported++;
+            else
+                EraseClientData( &cd );
+        }
+        CloseClientsDb();
+        if( !FileRename( db_tmp_fname, db_fname ) )
+        {
+            WriteLog( "Unable to rename<%s> to<%s>.\n", db_tmp_fname, db_fname );
+            return false;
+        }
+        WriteLog( "Import clients data... imported<%u>.\n", imported );
+
+        // Reindex from database
+        ClientsData.clear();
+        ClientsDataByName.clear();
+        ClientsDataById.clear();
+    }
+
+    if( !OpenClientsDb() )
+        return false;
+
+    // Refresh last id
+    last_id_file = FileOpen( last_id_fname, true );
+    if( last_id_file )
+    {
+        char last_id_str[128];
+        Str::Format( last_id_str, "%u", LastClientId );
+        FileWrite( last_id_file, last_id_str, Str::Length( last_id_str ) );
+        FileClose( last_id_file );
+    }
+
+    // Reserve memory for future clients data
+    if( ClientsData.size() > 10000 )
+        ClientsData.reserve( ClientsData.size() * 2 );
+
+    WriteLog( "Load clients data... loaded<%u>.\n", ClientsDataById.size() );
+    return true;
+}
+
+bool FOServer::LoadClientsFiles()
+{
+    WriteLog( "Scan client files...\n" );
+
+    bool success = false;
+    char client_name[MAX_FOPATH];
+    char clients_path[MAX_FOPATH];
+    FileManager::GetFullPath( "", PATH_SERVER_CLIENTS, clients_path );
+
     // Get cache for clients
     istrstream* cache_str = NULL;
     char*       cache_buf = NULL;
@@ -4184,9 +4661,8 @@ bool FOServer::LoadClientsData()
     }
 
     // Scan folder for names if no cache
-    FIND_DATA   file_find_data;
-    void*       file_find = NULL;
-    FileManager file_cache_write;
+    FIND_DATA file_find_data;
+    void*     file_find = NULL;
     if( !cache_str )
     {
         // Find file
@@ -4213,9 +4689,6 @@ bool FOServer::LoadClientsData()
         {
             if( file_find )
             {
-                file_cache_write.SetStr( client_name );
-                file_cache_write.SetStr( "\n" );
-
                 if( !FileFindNext( file_find, file_find_data ) )
                 {
                     success = true;
@@ -4351,7 +4824,7 @@ bool FOServer::LoadClientsData()
         Str::Copy( data.ClientName, name );
         memcpy( data.ClientPassHash, pass_hash, PASS_HASH_SIZE );
         data.ClientId = id;
-        ClientsData.push_back( data );
+        AddClientData( data );
 
         // Process ids
         if( id > LastClientId )
@@ -4371,28 +4844,357 @@ bool FOServer::LoadClientsData()
         return false;
     }
 
-    // Refresh last id
-    last_id_file = FileOpen( last_id_fname, true );
-    if( last_id_file )
+    WriteLog( "Scan client files... found<%u>.\n", ClientsData.size() );
+    return true;
+}
+
+bool FOServer::OpenClientsDb()
+{
+    char db_fname[MAX_FOPATH];
+    FileManager::GetFullPath( CLIENTS_DB_FNAME, PATH_SERVER_CLIENTS, db_fname );
+
+    void* f = FileOpen( db_fname, false );
+    if( !f )
     {
-        char last_id_str[128];
-        Str::Format( last_id_str, "%u", LastClientId );
-        FileWrite( last_id_file, last_id_str, Str::Length( last_id_str ) );
-        FileClose( last_id_file );
+        WriteLog( "Unable to open clients database<%s>.\n", db_fname );
+        return false;
     }
 
-    // Save cache
-    if( file_find )
-        file_cache_write.SaveOutBufToFile( cache_fname, -1 );
+    uint  size = FileGetSize( f );
+    uchar signature[sizeof(ClientSaveSignature)];
+    if( !FileRead( f, signature, sizeof(signature) ) || !BINARY_SIGNATURE_VALID( ClientSaveSignature, signature ) )
+    {
+        WriteLog( "Invalid signature of clients database<%s>.\n", db_fname );
+        FileClose( f );
+        return false;
+    }
 
-    // Reserve memory for future clients data
-    if( ClientsData.size() > 10000 )
-        ClientsData.reserve( ClientsData.size() * 2 );
+    // Index records, only headers are read
+    uint pos = sizeof(signature);
+    uint garbage = 0;
+    bool broken = false;
+    while( pos < size )
+    {
+        ClientsDbRecord rec;
+        if( size - pos < sizeof(rec) || !FileRead( f, &rec, sizeof(rec) ) ||
+            rec.Magic != CLIENTS_DB_RECORD_MAGIC || rec.Size > size - pos - sizeof(rec) )
+        {
+            broken = true;
+            break;
+        }
+        rec.Name[sizeof(rec.Name) - 1] = 0;
+
+        // Last record may be written partially
+        uint rec_size = sizeof(rec) + rec.Size;
+        if( pos + rec_size == size )
+        {
+            UCharVec payload( rec.Size );
+            uint     crc = rec.Crc;
+            rec.Crc = 0;
+            uint     crc_ = 0;
+            Crypt.Crc32( (uchar*)&rec, sizeof(rec), crc_ );
+            if( rec.Size && FileRead( f, &payload[0], rec.Size ) )
+                Crypt.Crc32( &payload[0], rec.Size, crc_ );
+            if( crc != crc_ )
+            {
+                broken = true;
+                break;
+            }
+        }
+        else if( !FileSetPointer( f, pos + rec_size, SEEK_SET ) )
+        {
+            broken = true;
+            break;
+        }
+
+        ClientData* cd = GetClientData( rec.Name );
+        if( cd )
+        {
+            garbage += cd->DbSize;
+            if( FLAG( rec.Flags, CLIENTS_DB_RECORD_DELETED ) )
+            {
+                EraseClientData( cd );
+                garbage += rec_size;
+            }
+        }
+        else if( FLAG( rec.Flags, CLIENTS_DB_RECORD_DELETED ) )
+        {
+            garbage += rec_size;
+        }
+        else if( !CRITTER_ID_IS_PLAYER( rec.Id ) || GetClientData( rec.Id ) )
+        {
+            WriteLog( "Wrong or already used id<%u> of client<%s>. Skipped.\n", rec.Id, rec.Name );
+            garbage += rec_size;
+        }
+        else
+        {
+            ClientData data;
+            data.Clear();
+            Str::Copy( data.ClientName, rec.Name );
+            data.ClientId = rec.Id;
+            cd = AddClientData( data );
+        }
+
+        if( cd && !FLAG( rec.Flags, CLIENTS_DB_RECORD_DELETED ) )
+        {
+            memcpy( cd->ClientPassHash, rec.PassHash, PASS_HASH_SIZE );
+            cd->DbOffset = pos;
+            cd->DbSize = rec_size;
+            if( rec.Id > LastClientId )
+                LastClientId = rec.Id;
+        }
+
+        pos += rec_size;
+    }
+    FileClose( f );
+
+    ClientsDbSize = pos;
+    ClientsDbGarbage = garbage;
+
+    // Cut off broken tail and obsolete records
+    if( broken )
+        WriteLog( "Clients database<%s> has broken record at offset<%u>, tail<%u> bytes dropped.\n", db_fname, pos, size - pos );
+    if( broken || ClientsDbGarbage > ClientsDbSize / 2 )
+    {
+        if( !CompactClientsDb() )
+            return false;
+    }
+
+    ClientsDbFile = FileOpenForAppend( db_fname, true );
+    if( !ClientsDbFile )
+    {
+        WriteLog( "Unable to open clients database<%s> for writing.\n", db_fname );
+        return false;
+    }
+    return true;
+}
+
+bool FOServer::CompactClientsDb()
+{
+    double tick = Timer::AccurateTick();
+
+    char db_fname[MAX_FOPATH];
+    FileManager::GetFullPath( CLIENTS_DB_FNAME, PATH_SERVER_CLIENTS, db_fname );
+    char db_tmp_fname[MAX_FOPATH];
+    Str::Format( db_tmp_fname, "%s.tmp", db_fname );
+
+    void* f = FileOpen( db_fname, false );
+    void* f_new = FileOpen( db_tmp_fname, true );
+    if( !f || !f_new )
+    {
+        WriteLog( "Unable to compact clients database<%s>.\n", db_fname );
+        if( f )
+            FileClose( f );
+        if( f_new )
+            FileClose( f_new );
+        return false;
+    }
+
+    // Copy actual records in offsets order to read old file sequentially
+    UIntVec order;
+    order.reserve( ClientsDataById.size() );
+    for( auto it = ClientsDataById.begin(), end = ClientsDataById.end(); it != end; ++it )
+        order.push_back( (*it).second );
+    struct OffsetLess
+    {
+        ClientDataVec* Data;
+        bool           operator()( uint l, uint r ) const { return ( *Data )[l].DbOffset < ( *Data )[r].DbOffset; }
+    };
+    OffsetLess less = { &ClientsData };
+    std::sort( order.begin(), order.end(), less );
+
+    // New offsets applied only after successful replace of file
+    bool     ok = FileWrite( f_new, ClientSaveSignature, sizeof(ClientSaveSignature) );
+    uint     pos = sizeof(ClientSaveSignature);
+    UIntVec  offsets( order.size() );
+    UCharVec buf;
+    for( uint i = 0; i < order.size() && ok; i++ )
+    {
+        ClientData& cd = ClientsData[order[i]];
+        if( cd.DbSize > (uint)MAX_INT - pos )
+        {
+            WriteLog( "Clients database<%s> actual records exceed size limit.\n", db_fname );
+            ok = false;
+            break;
+        }
+        buf.resize( cd.DbSize );
+        ok = FileSetPointer( f, cd.DbOffset, SEEK_SET ) && FileRead( f, &buf[0], cd.DbSize ) && FileWrite( f_new, &buf[0], cd.DbSize );
+        offsets[i] = pos;
+        pos += cd.DbSize;
+    }
+    FileClose( f );
+    FileClose( f_new );
+
+    char db_bak_fname[MAX_FOPATH];
+    Str::Format( db_bak_fname, "%s.bak", db_fname );
+    if( !ok || !FileRename( db_fname, db_bak_fname ) || !FileRename( db_tmp_fname, db_fname ) )
+    {
+        WriteLog( "Unable to compact clients database<%s>.\n", db_fname );
+        FileDelete( db_tmp_fname );
+        return false;
+    }
+    FileDelete( db_bak_fname );
 
-    WriteLog( "Load clients data.. loaded<%u>.\n", ClientsData.size() );
+    for( uint i = 0; i < order.size(); i++ )
+        ClientsData[order[i]].DbOffset = offsets[i];
+
+    WriteLog( "Clients database compacted from<%u> to<%u> bytes in %g ms.\n", ClientsDbSize, pos, Timer::AccurateTick() - tick );
+    ClientsDbSize = pos;
+    ClientsDbGarbage = 0;
     return true;
 }
 
+// Called under ClientsDbLocker
+bool FOServer::CompactClientsDbOnline()
+{
+    if( ClientsDbFile )
+        FileClose( ClientsDbFile );
+    ClientsDbFile = NULL;
+
+    bool ok;
+    {
+        SCOPE_LOCK( ClientsDataLocker );
+        ok = CompactClientsDb();
+    }
+
+    char db_fname[MAX_FOPATH];
+    FileManager::GetFullPath( CLIENTS_DB_FNAME, PATH_SERVER_CLIENTS, db_fname );
+    ClientsDbFile = FileOpenForAppend( db_fname, true );
+    if( !ClientsDbFile )
+    {
+        WriteLog( "Unable to open clients database<%s> for writing.\n", db_fname );
+        return false;
+    }
+    return ok;
+}
+
+void FOServer::CloseClientsDb()
+{
+    SCOPE_LOCK( ClientsDbLocker );
+
+    if( ClientsDbFile )
+        FileClose( ClientsDbFile );
+    ClientsDbFile = NULL;
+}
+
+bool FOServer::AppendClientsDbRecord( const char* name, const char* pass_hash, CritData* data, CritDataExt* data_ext, Critter::CrTimeEventVec* time_events )
+{
+    // Without data record marks client as deleted
+    ClientsDbRecord rec;
+    memzero( &rec, sizeof(rec) );
+    rec.Magic = CLIENTS_DB_RECORD_MAGIC;
+    Str::Copy( rec.Name, name );
+    if( data )
+    {
+        uint te_count = (uint)time_events->size();
+        rec.Size = sizeof(CritData) + sizeof(CritDataExt) + sizeof(te_count) + te_count * sizeof(Critter::CrTimeEvent);
+        rec.Id = data->Id;
+        memcpy( rec.PassHash, pass_hash, PASS_HASH_SIZE );
+    }
+    else
+    {
+        SETFLAG( rec.Flags, CLIENTS_DB_RECORD_DELETED );
+    }
+
+    // Whole record written by one call
+    UCharVec buf( sizeof(rec) + rec.Size );
+    memcpy( &buf[0], &rec, sizeof(rec) );
+    if( data )
+    {
+        uint   te_count = (uint)time_events->size();
+        uchar* ptr = &buf[sizeof(rec)];
+        memcpy( ptr, data, sizeof(CritData) );
+        ptr += sizeof(CritData);
+        memcpy( ptr, data_ext, sizeof(CritDataExt) );
+        ptr += sizeof(CritDataExt);
+        memcpy( ptr, &te_count, sizeof(te_count) );
+        ptr += sizeof(te_count);
+        if( te_count )
+            memcpy( ptr, &( *time_events )[0], te_count * sizeof(Critter::CrTimeEvent) );
+    }
+    rec.Crc = 0;
+    Crypt.Crc32( &buf[0], (uint)buf.size(), rec.Crc );
+    memcpy( &buf[0], &rec, sizeof(rec) );
+
+    SCOPE_LOCK( ClientsDbLocker );
+
+    // Offsets must fit to int, try to free space first
+    if( (uint)buf.size() > (uint)MAX_INT - ClientsDbSize && (!CompactClientsDbOnline() || (uint)buf.size() > (uint)MAX_INT - ClientsDbSize) )
+    {
+        WriteLogF( _FUNC_, " - Clients database size limit reached, client<%s> not written.\n", name );
+        return false;
+    }
+
+    if( !ClientsDbFile || !FileWrite( ClientsDbFile, &buf[0], (uint)buf.size() ) )
+    {
+        WriteLogF( _FUNC_, " - Unable to write client<%s> to database.\n", name );
+        return false;
+    }
+    uint offset = ClientsDbSize;
+    ClientsDbSize += (uint)buf.size();
+
+    // Point client to new record, in same critical section to keep order of records
+    {
+        SCOPE_LOCK( ClientsDataLocker );
+
+        ClientData* cd = GetClientData( name );
+        if( cd )
+        {
+            ClientsDbGarbage += cd->DbSize;
+            if( data )
+            {
+                cd->DbOffset = offset;
+                cd->DbSize = (uint)buf.size();
+            }
+        }
+    }
+
+    // Half of big file is obsolete
+    if( ClientsDbSize >= CLIENTS_DB_COMPACT_MIN_SIZE && ClientsDbGarbage > ClientsDbSize / 2 )
+        CompactClientsDbOnline();
+    return true;
+}
+
+bool FOServer::ImportClientFile( ClientData& cd )
+{
+    char fname[MAX_FOPATH];
+    FileManager::GetFullPath( cd.ClientName, PATH_SERVER_CLIENTS, fname );
+    Str::Append( fname, ".client" );
+    void* f = FileOpen( fname, false );
+    if( !f )
+    {
+        WriteLog( "Unable to open client save file<%s>.\n", fname );
+        return false;
+    }
+
+    // Header validated by LoadClientsFiles
+    uchar signature[sizeof(ClientSaveSignature)];
+    FileRead( f, signature, sizeof(signature) );
+    if( signature[0] == 'F' && signature[1] == 'O' && signature[2] == 0 )
+        FileSetPointer( f, 4, SEEK_SET );
+
+    char                    pass_hash[PASS_HASH_SIZE];
+    CritData                data;
+    CritDataExt             data_ext;
+    Critter::CrTimeEventVec time_events;
+    uint                    te_count = 0;
+    bool                    ok = FileRead( f, pass_hash, sizeof(pass_hash) ) && FileRead( f, &data, sizeof(data) ) &&
+                                 FileRead( f, &data_ext, sizeof(data_ext) ) && FileRead( f, &te_count, sizeof(te_count) );
+    if( ok && te_count )
+    {
+        time_events.resize( te_count );
+        ok = FileRead( f, &time_events[0], te_count * sizeof(Critter::CrTimeEvent) );
+    }
+    FileClose( f );
+
+    if( !ok )
+    {
+        WriteLog( "Client save file<%s> truncated.\n", fname );
+        return false;
+    }
+    return AppendClientsDbRecord( cd.ClientName, pass_hash, &data, &data_ext, &time_events );
+}
+
 bool FOServer::SaveClient( Client* cl, bool deferred )
 {
     if( Singleplayer )
@@ -4417,25 +5219,8 @@ bool FOServer::SaveClient( Client* cl, bool deferred )
     }
     else
     {
-        char fname[MAX_FOPATH];
-        FileManager::GetFullPath( cl->Name, PATH_SERVER_CLIENTS, fname );
-        Str::Append( fname, ".client" );
-        void* f = FileOpen( fname, true );
-        if( !f )
-        {
-            WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
+        if( !AppendClientsDbRecord( cl->Name, cl->PassHash, &cl->Data, data_ext, &cl->CrTimeEvents ) )
             return false;
-        }
-
-        FileWrite( f, ClientSaveSignature, sizeof(ClientSaveSignature) );
-        FileWrite( f, cl->PassHash, sizeof(cl->PassHash) );
-        FileWrite( f, &cl->Data, sizeof(cl->Data) );
-        FileWrite( f, data_ext, sizeof(CritDataExt) );
-        uint te_count = (uint)cl->CrTimeEvents.size();
-        FileWrite( f, &te_count, sizeof(te_count) );
-        if( te_count )
-            FileWrite( f, &cl->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
-        FileClose( f );
 
         cl->Data.Temp = 0;
     }
@@ -4454,84 +5239,75 @@ bool FOServer::LoadClient( Client* cl )
         return false;
     }
 
-    char fname[MAX_FOPATH];
-    FileManager::GetFullPath( cl->Name, PATH_SERVER_CLIENTS, fname );
-    Str::Append( fname, ".client" );
-    void* f = FileOpen( fname, false );
-    if( !f )
+    // Database may be compacted while running, offset is valid only under lock
+    ClientsDbLocker.Lock();
+
+    uint offset = 0, size = 0;
     {
-        WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
-        return false;
-    }
+        SCOPE_LOCK( ClientsDataLocker );
 
-    // Read data
-    uchar signature[sizeof(ClientSaveSignature)];
-    if( !FileRead( f, signature, sizeof(signature) ) )
+        ClientData* cd = GetClientData( cl->Name );
+        if( cd )
+        {
+            offset = cd->DbOffset;
+            size = cd->DbSize;
+        }
+    }
+    if( !size )
     {
-        WriteLog( "Unable to read signature of client save file<%s>.\n", fname );
-        FileClose( f );
+        ClientsDbLocker.Unlock();
+        WriteLogF( _FUNC_, " - Client<%s> not found in database.\n", cl->Name );
         return false;
     }
 
-    #ifndef OPTION_LEGACY_SAVEFILE
-    // ignore legacy clients
-    if( signature[0] == 'F' && signature[1] == 'O' && signature[2] == 0 )
+    // Read whole record
+    char fname[MAX_FOPATH];
+    FileManager::GetFullPath( CLIENTS_DB_FNAME, PATH_SERVER_CLIENTS, fname );
+    void* f = FileOpen( fname, false );
+    if( !f )
     {
-        WriteLog( "Client save file<%s> ignored.\n", fname );
-        FileClose( f );
+        ClientsDbLocker.Unlock();
+        WriteLogF( _FUNC_, " - Unable to open clients database<%s>.\n", fname );
         return false;
     }
-    #else
-    bool legacy = false;
-    // detect legacy clients
-    if( signature[0] == 'F' && signature[1] == 'O' && signature[2] == 0 )
+    UCharVec buf( size );
+    bool     read_ok = FileSetPointer( f, offset, SEEK_SET ) && FileRead( f, &buf[0], size );
+    FileClose( f );
+
+    ClientsDbLocker.Unlock();
+
+    ClientsDbRecord rec;
+    uint            crc = 0;
+    if( read_ok && size >= sizeof(rec) + sizeof(CritData) + sizeof(CritDataExt) + sizeof(uint) )
     {
-        if( signature[3] != 2 )        // v1 is broken
-        {
-            WriteLog( "Legacy client<%s> ignored (invalid version; expected 2, got %u)\n", fname, signature[3] );
-            return false;
-        }
-        FileSetPointer( f, 4, SEEK_SET );
-        legacy = true;
+        memcpy( &rec, &buf[0], sizeof(rec) );
+        memzero( &buf[offsetof( ClientsDbRecord, Crc )], sizeof(rec.Crc) );
+        Crypt.Crc32( &buf[0], size, crc );
     }
-    #endif
-
-    #ifndef OPTION_LEGACY_SAVEFILE
-    if( memcmp( ClientSaveSignature, signature, sizeof(ClientSaveSignature) ) != 0 )
-    #else
-    if( !legacy && memcmp( ClientSaveSignature, signature, sizeof(ClientSaveSignature) ) != 0 )
-    #endif
+    if( !read_ok || crc != rec.Crc || rec.Size != size - sizeof(rec) )
     {
-        if( !BINARY_SIGNATURE_VALID( ClientSaveSignature, signature ) )
-        {
-            FileClose( f );
-            return false;
-        }
+        WriteLogF( _FUNC_, " - Client<%s> record at offset<%u> is corrupted.\n", cl->Name, offset );
+        return false;
     }
 
-    if( !FileRead( f, cl->PassHash, sizeof(cl->PassHash) ) )
-        goto label_FileTruncated;
-    if( !FileRead( f, &cl->Data, sizeof(cl->Data) ) )
-        goto label_FileTruncated;
-    if( !FileRead( f, data_ext, sizeof(CritDataExt) ) )
-        goto label_FileTruncated;
+    uchar* ptr = &buf[sizeof(rec)];
+    memcpy( cl->PassHash, rec.PassHash, sizeof(cl->PassHash) );
+    memcpy( (void*)&cl->Data, ptr, sizeof(cl->Data) );
+    ptr += sizeof(cl->Data);
+    memcpy( data_ext, ptr, sizeof(CritDataExt) );
+    ptr += sizeof(CritDataExt);
     uint te_count;
-    if( !FileRead( f, &te_count, sizeof(te_count) ) )
-        goto label_FileTruncated;
-    if( te_count )
+    memcpy( &te_count, ptr, sizeof(te_count) );
+    ptr += sizeof(te_count);
+    if( rec.Size != sizeof(CritData) + sizeof(CritDataExt) + sizeof(te_count) + te_count * sizeof(Critter::CrTimeEvent) )
     {
-        cl->CrTimeEvents.resize( te_count );
-        if( !FileRead( f, &cl->CrTimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) ) )
-            goto label_FileTruncated;
+        WriteLogF( _FUNC_, " - Client<%s> record at offset<%u> is truncated.\n", cl->Name, offset );
+        return false;
     }
-    FileClose( f );
-
+    cl->CrTimeEvents.resize( te_count );
+    if( te_count )
+        memcpy( (void*)&cl->CrTimeEvents[0], ptr, te_count * sizeof(Critter::CrTimeEvent) );
     return true;
-
-label_FileTruncated:
-    WriteLogF( _FUNC_, " - Client save file<%s> truncated.\n", fname );
-    FileClose( f );
-    return false;
 }
 
 bool FOServer::NewWorld()
@@ -4549,6 +5325,7 @@ void FOServer::SaveWorld( const char* fname )
         return;                           // Disable autosaving in singleplayer mode
 
     double tick;
+    char   dump_fname[MAX_FOPATH];
     if( WorldSaveManager )
     {
         // Be sure what Dump_Work thread in wait state
@@ -4557,20 +5334,31 @@ void FOServer::SaveWorld( const char* fname )
         tick = Timer::AccurateTick();
         WorldSaveDataBufCount = 0;
         WorldSaveDataBufFreeSize = 0;
+        WorldSaveSections.clear();
         ClientsSaveDataCount = 0;
+
+        // Journal only changes if previous full dump made by this process,
+        // Dump_Work allows journal again after successful full dump
+        SaveWorldDelta = (!fname && SaveWorldJournalMax && SaveWorldJournalReady);
+        if( !SaveWorldDelta )
+            SaveWorldJournalReady = false;
     }
     else
     {
         // Save directly to file
         tick = Timer::AccurateTick();
-        char auto_fname[MAX_FOPATH];
-        Str::Format( auto_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex + 1 );
-        DumpFile = FileOpen( fname ? fname : auto_fname, true );
+        SaveWorldDelta = false;
+        if( fname )
+            Str::Copy( dump_fname, fname );
+        else
+            Str::Format( dump_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), SaveWorldIndex + 1 );
+        DumpFile = FileOpen( dump_fname, true );
         if( !DumpFile )
         {
-            WriteLog( "Can't create dump file<%s>.\n", fname ? fname : auto_fname );
+            WriteLog( "Can't create dump file<%s>.\n", dump_fname );
             return;
         }
+        BeginWorldSaveStream( DumpStream, DumpFile );
     }
 
     // ServerFunctions.SaveWorld
@@ -4585,24 +5373,27 @@ void FOServer::SaveWorld( const char* fname )
         delete_indexes->Release();
     }
 
-    AddWorldSaveData( (char*)WorldSaveSignature, sizeof(WorldSaveSignature) );
+    if( !SaveWorldDelta )
+    {
+        AddWorldSaveData( (char*)WorldSaveSignature, sizeof(WorldSaveSignature) );
+
+        // Npcs params saved relative to prototypes
+        AddWorldSaveSection();
+        CrMngr.SaveProtoParamsFile( AddWorldSaveData );
+    }
 
     // SaveGameInfoFile
+    AddWorldSaveSection();
     SaveGameInfoFile();
 
     // SaveAllLocationsAndMapsFile
     MapMngr.SaveAllLocationsAndMapsFile( AddWorldSaveData );
 
-    // SaveCrittersFile
-    CrMngr.SaveCrittersFile( AddWorldSaveData );
-
-    // SaveAllItemsFile
-    ItemMngr.SaveAllItemsFile( AddWorldSaveData );
-
-    // SaveVarsDataFile
-    VarMngr.SaveVarsDataFile( AddWorldSaveData );
+    // SaveCrittersFile, SaveAllItemsFile, SaveVarsDataFile
+    SaveWorldRecords( SaveWorldDelta );
 
     // SaveHoloInfoFile
+    AddWorldSaveSection();
     SaveHoloInfoFile();
 
     // SaveAnyDataFile
@@ -4645,14 +5436,225 @@ void FOServer::SaveWorld( const char* fname )
     }
     else
     {
+        // Corrupted dump not become newest
+        bool ok = EndWorldSaveSection( DumpStream );
         FileClose( DumpFile );
         DumpFile = NULL;
-        SaveWorldIndex++;
-        if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
-            SaveWorldIndex = 0;
+        if( ok )
+        {
+            SaveWorldIndex++;
+            if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
+                SaveWorldIndex = 0;
+        }
+        else
+        {
+            WriteLog( "Can't write dump file<%s>.\n", dump_fname );
+            FileDelete( dump_fname );
+        }
+    }
+
+    if( SaveWorldDelta )
+        WriteLog( "World saved in %g ms, changed records %u, found by checksum %u.\n", Timer::AccurateTick() - tick, SaveWorldChangedCount, SaveWorldMissedCount );
+    else
+        WriteLog( "World saved in %g ms.\n", Timer::AccurateTick() - tick );
+}
+
+void FOServer::SaveWorldRecords( bool delta )
+{
+    // Removed records needed only for journal, but collected always
+    UIntVec removed_npcs, removed_items, removed_vars;
+    CrMngr.GetRemovedNpcIds( removed_npcs );
+    ItemMngr.GetRemovedItemIds( removed_items );
+    VarMngr.GetRemovedVarKeys( removed_vars );
+
+    if( !WorldSaveManager || !SaveWorldJournalMax )
+    {
+        AddWorldSaveSection();
+        CrMngr.SaveCrittersFile( AddWorldSaveData );
+        AddWorldSaveSection();
+        ItemMngr.SaveAllItemsFile( AddWorldSaveData );
+        AddWorldSaveSection();
+        VarMngr.SaveVarsDataFile( AddWorldSaveData );
+        return;
+    }
+
+    // Full dump writes all records and remembers their checksums,
+    // delta writes changed records and keys of removed ones
+    SaveWorldChangedCount = 0;
+    SaveWorldMissedCount = 0;
+    uint verify = SaveWorldVerifyStep++ % SaveWorldJournalMax;
+    uint index = 0;
+
+    // Npcs
+    CrVec  changed_crits;
+    CrMap& critters = CrMngr.GetCrittersNoLock();
+    for( auto it = critters.begin(), end = critters.end(); it != end; ++it )
+    {
+        Critter* cr = (*it).second;
+        if( !cr->IsNpc() )
+            continue;
+        if( delta && !cr->IsSaveChanged && index++ % SaveWorldJournalMax == verify )
+        {
+            SaveWorldRecordsCrc = 0;
+            CrMngr.SaveCritter( cr, AddWorldSaveCrc );
+            if( SaveWorldRecordsCrc != cr->SaveCrc )
+            {
+                cr->IsSaveChanged = true;
+                SaveWorldMissedCount++;
+            }
+        }
+        if( !delta || cr->IsSaveChanged )
+            changed_crits.push_back( cr );
+    }
+
+    uint count = (uint)changed_crits.size();
+    AddWorldSaveSection();
+    AddWorldSaveData( &count, sizeof(count) );
+    for( auto it = changed_crits.begin(), end = changed_crits.end(); it != end; ++it )
+    {
+        Critter* cr = *it;
+        SaveWorldRecordsCrc = 0;
+        CrMngr.SaveCritter( cr, AddWorldSaveDataCrc );
+        cr->SaveCrc = SaveWorldRecordsCrc;
+        cr->IsSaveChanged = false;
+    }
+    if( delta )
+    {
+        SaveWorldChangedCount += count;
+        count = (uint)removed_npcs.size();
+        AddWorldSaveData( &count, sizeof(count) );
+        if( count )
+            AddWorldSaveData( &removed_npcs[0], count * sizeof(uint) );
+    }
+
+    // Items
+    ItemPtrVec items;
+    ItemPtrVec changed_items;
+    ItemMngr.GetGameItems( items );
+    for( auto it = items.begin(), end = items.end(); it != end; ++it )
+    {
+        Item* item = *it;
+        if( delta && !item->IsSaveChanged && index++ % SaveWorldJournalMax == verify )
+        {
+            SaveWorldRecordsCrc = 0;
+            ItemMngr.SaveItem( item, AddWorldSaveCrc );
+            if( SaveWorldRecordsCrc != item->SaveCrc )
+            {
+                item->IsSaveChanged = true;
+                SaveWorldMissedCount++;
+            }
+        }
+        if( !delta || item->IsSaveChanged )
+            changed_items.push_back( item );
+    }
+
+    count = (uint)changed_items.size();
+    AddWorldSaveSection();
+    AddWorldSaveData( &count, sizeof(count) );
+    for( auto it = changed_items.begin(), end = changed_items.end(); it != end; ++it )
+    {
+        Item* item = *it;
+        SaveWorldRecordsCrc = 0;
+        ItemMngr.SaveItem( item, AddWorldSaveDataCrc );
+        item->SaveCrc = SaveWorldRecordsCrc;
+        item->IsSaveChanged = false;
+    }
+    if( delta )
+    {
+        SaveWorldChangedCount += count;
+        count = (uint)removed_items.size();
+        AddWorldSaveData( &count, sizeof(count) );
+        if( count )
+            AddWorldSaveData( &removed_items[0], count * sizeof(uint) );
+    }
+
+    // Vars
+    VarsVec     changed_vars;
+    TempVarVec& tvars = VarMngr.GetTemplateVars();
+    for( auto it = tvars.begin(), end = tvars.end(); it != end; ++it )
+    {
+        TemplateVar* tvar = *it;
+        if( !tvar )
+            continue;
+        for( uint i = 0, j = tvar->Vars.GetCapacity(); i < j; i++ )
+        {
+            GameVar* var = tvar->Vars.GetByIndex( i );
+            if( !var )
+                continue;
+            if( delta && !var->IsSaveChanged && index++ % SaveWorldJournalMax == verify )
+            {
+                SaveWorldRecordsCrc = 0;
+                VarMngr.SaveVar( var, AddWorldSaveCrc );
+                if( SaveWorldRecordsCrc != var->SaveCrc )
+                {
+                    var->IsSaveChanged = true;
+                    SaveWorldMissedCount++;
+                }
+            }
+            if( !delta || var->IsSaveChanged )
+                changed_vars.push_back( var );
+        }
     }
 
-    WriteLog( "World saved in %g ms.\n", Timer::AccurateTick() - tick );
+    count = (uint)changed_vars.size();
+    AddWorldSaveSection();
+    AddWorldSaveData( &count, sizeof(count) );
+    for( auto it = changed_vars.begin(), end = changed_vars.end(); it != end; ++it )
+    {
+        GameVar* var = *it;
+        SaveWorldRecordsCrc = 0;
+        VarMngr.SaveVar( var, AddWorldSaveDataCrc );
+        var->SaveCrc = SaveWorldRecordsCrc;
+        var->IsSaveChanged = false;
+    }
+    if( delta )
+    {
+        SaveWorldChangedCount += count;
+
+        // Removed key may be taken by rekeyed or recreated var, which is written above
+        set<WorldSaveVarKey> written;
+        if( !removed_vars.empty() )
+        {
+            for( auto it = changed_vars.begin(), end = changed_vars.end(); it != end; ++it )
+            {
+                GameVar*        var = *it;
+                WorldSaveVarKey key = { var->VarTemplate->TempId, var->MasterId, var->SlaveId };
+                written.insert( key );
+            }
+        }
+
+        vector<WorldSaveVarKey> removed_keys;
+        for( uint i = 0; i + 2 < (uint)removed_vars.size(); i += 3 )
+        {
+            WorldSaveVarKey key = { (ushort)removed_vars[i], removed_vars[i + 1], removed_vars[i + 2] };
+            if( !written.count( key ) )
+            {
+                written.insert( key );
+                removed_keys.push_back( key );
+            }
+        }
+
+        count = (uint)removed_keys.size();
+        AddWorldSaveData( &count, sizeof(count) );
+        for( auto it = removed_keys.begin(), end = removed_keys.end(); it != end; ++it )
+        {
+            WorldSaveVarKey& key = *it;
+            AddWorldSaveData( &key.TempId, sizeof(key.TempId) );
+            AddWorldSaveData( &key.MasterId, sizeof(key.MasterId) );
+            AddWorldSaveData( &key.SlaveId, sizeof(key.SlaveId) );
+        }
+    }
+}
+
+void FOServer::AddWorldSaveCrc( void* data, size_t size )
+{
+    Crypt.Crc32( (uchar*)data, (uint)size, SaveWorldRecordsCrc );
+}
+
+void FOServer::AddWorldSaveDataCrc( void* data, size_t size )
+{
+    Crypt.Crc32( (uchar*)data, (uint)size, SaveWorldRecordsCrc );
+    AddWorldSaveData( data, size );
 }
 
 bool FOServer::LoadWorld( const char* fname )
@@ -4669,6 +5671,30 @@ bool FOServer::LoadWorld( const char* fname )
             f = FileOpen( auto_fname, false );
             if( f )
             {
+                // Merge changes saved after last full dump
+                char journal_fname[MAX_FOPATH];
+                Str::Format( journal_fname, "%sworld%04d.fod", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), i );
+                if( FileExist( journal_fname ) )
+                {
+                    FileClose( f );
+                    int next_index = (i < WORLD_SAVE_MAX_INDEX ? i + 1 : 1);
+                    if( CompactWorldSave( i, next_index ) )
+                    {
+                        i = next_index;
+                        Str::Format( auto_fname, "%sworld%04d.fo", FileManager::GetFullPath( NULL, PATH_SERVER_SAVE ), i );
+                    }
+                    else
+                    {
+                        WriteLog( "World journal<%s> not applied.\n", journal_fname );
+                    }
+                    f = FileOpen( auto_fname, false );
+                    if( !f )
+                    {
+                        WriteLog( "Load world<%s>... not found\n", auto_fname );
+                        return false;
+                    }
+                }
+
                 WriteLog( "Load world<%s>...\n", auto_fname );
                 fname = Str::Duplicate( auto_fname );
                 SaveWorldIndex = i;
@@ -4761,6 +5787,35 @@ bool FOServer::LoadWorld( const char* fname )
     #endif
     version = BINARY_SIGNATURE_VERSION( signature );
 
+    // Packed sections unpacked in parallel, then loaded from memory
+    UCharVec raw;
+    #ifdef OPTION_LEGACY_SAVEFILE
+    if( !legacy && version >= WORLD_SAVE_V2 )
+    #else
+    if( version >= WORLD_SAVE_V2 )
+    #endif
+    {
+        double   tick = Timer::AccurateTick();
+        UCharVec data( FileGetSize( f ) - sizeof(signature) );
+        UIntVec  offsets;
+        bool     read_ok = (data.empty() || FileRead( f, &data[0], (uint)data.size() ) );
+        FileClose( f );
+        if( !read_ok || !UnpackWorldSaveSections( data, 0, raw, offsets ) )
+        {
+            WriteLog( "World dump file corrupted.\n" );
+            return false;
+        }
+        WriteLog( "World dump file unpacked in %g ms, size<%u>.\n", Timer::AccurateTick() - tick, (uint)raw.size() );
+
+        f = FileOpenMemory( raw.empty() ? NULL : &raw[0], (uint)raw.size() );
+        if( !CrMngr.LoadProtoParamsFile( f ) )
+        {
+            WriteLog( "Unable to load prototypes of world dump file.\n" );
+            FileClose( f );
+            return false;
+        }
+    }
+
     // Main data
     if( !LoadGameInfoFile( f ) )
         return false;
@@ -4869,13 +5924,19 @@ void FOServer::UnloadWorld()
 
     // Time events
     for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        delete *it;
+        delete it->second;
     TimeEvents.clear();
+    TimeEventsQueue.clear();
+    TimeEventsInProcess.clear();
     TimeEventsLastNum = 0;
+    memzero( &TimeEventsStatistics, sizeof(TimeEventsStatistics) );
 
     // Script functions
     Script::ResizeCache( 0 );
 
+    // Delta saves, next dump is full
+    SaveWorldJournalReady = false;
+
     // Singleplayer header
     SingleplayerSave.Valid = false;
 }
@@ -4884,7 +5945,7 @@ void FOServer::AddWorldSaveData( void* data, size_t size )
 {
     if( !WorldSaveManager )
     {
-        FileWrite( DumpFile, data, size );
+        WriteWorldSaveStream( DumpStream, data, size );
         return;
     }
 
@@ -4893,22 +5954,182 @@ void FOServer::AddWorldSaveData( void* data, size_t size )
         WorldSaveDataBufCount++;
         WorldSaveDataBufFreeSize = WORLD_SAVE_DATA_BUFFER_SIZE;
 
-        if( WorldSaveDataBufCount >= WorldSaveData.size() )
-        {
-            MEMORY_PROCESS( MEMORY_SAVE_DATA, WORLD_SAVE_DATA_BUFFER_SIZE );
-            WorldSaveData.push_back( new uchar[WORLD_SAVE_DATA_BUFFER_SIZE] );
-        }
+        if( WorldSaveDataBufCount >= WorldSaveData.size() )
+        {
+            MEMORY_PROCESS( MEMORY_SAVE_DATA, WORLD_SAVE_DATA_BUFFER_SIZE );
+            WorldSaveData.push_back( new uchar[WORLD_SAVE_DATA_BUFFER_SIZE] );
+        }
+    }
+
+    size_t flush = (size <= WorldSaveDataBufFreeSize ? size : WorldSaveDataBufFreeSize);
+    if( flush )
+    {
+        uchar* ptr = WorldSaveData[WorldSaveDataBufCount - 1];
+        memcpy( &ptr[WORLD_SAVE_DATA_BUFFER_SIZE - WorldSaveDataBufFreeSize], data, flush );
+        WorldSaveDataBufFreeSize -= flush;
+        if( !WorldSaveDataBufFreeSize )
+            AddWorldSaveData( ( (uchar*)data ) + flush, size - flush );
+    }
+}
+
+void FOServer::AddWorldSaveSection()
+{
+    // Journal entries are not packed
+    if( SaveWorldDelta )
+        return;
+
+    if( !WorldSaveManager )
+        BeginWorldSaveSection( DumpStream );
+    else
+        WorldSaveSections.push_back( (uint)(WorldSaveDataBufCount * WORLD_SAVE_DATA_BUFFER_SIZE - WorldSaveDataBufFreeSize) );
+}
+
+void FOServer::BeginWorldSaveStream( WorldSaveStream& stream, void* f )
+{
+    stream.File = f;
+    stream.Section = false;
+    stream.Ok = (f != NULL);
+    stream.Offset = 0;
+    stream.SectionOffset = 0;
+    stream.SectionSize = 0;
+    stream.Buf.resize( WORLD_SAVE_STREAM_BUFFER_SIZE );
+}
+
+void FOServer::WriteWorldSaveStream( WorldSaveStream& stream, const void* data, size_t size )
+{
+    if( !stream.Ok || !size )
+        return;
+
+    if( !stream.Section )
+    {
+        stream.Ok = FileWrite( stream.File, data, (uint)size );
+        stream.Offset += (uint)size;
+        return;
+    }
+
+    stream.Zip.next_in = (Bytef*)data;
+    stream.Zip.avail_in = (uInt)size;
+    stream.SectionSize += (uint)size;
+    DeflateWorldSaveStream( stream, Z_NO_FLUSH );
+}
+
+void FOServer::DeflateWorldSaveStream( WorldSaveStream& stream, int flush )
+{
+    do
+    {
+        stream.Zip.next_out = &stream.Buf[0];
+        stream.Zip.avail_out = (uInt)stream.Buf.size();
+        if( deflate( &stream.Zip, flush ) == Z_STREAM_ERROR )
+        {
+            stream.Ok = false;
+            return;
+        }
+
+        uint packed = (uint)stream.Buf.size() - stream.Zip.avail_out;
+        if( packed )
+        {
+            stream.Ok = FileWrite( stream.File, &stream.Buf[0], packed );
+            stream.Offset += packed;
+        }
+    }
+    while( stream.Ok && !stream.Zip.avail_out );
+}
+
+void FOServer::BeginWorldSaveSection( WorldSaveStream& stream )
+{
+    if( !EndWorldSaveSection( stream ) )
+        return;
+
+    // Sizes filled at section end
+    uint sizes[2] = { 0, 0 };
+    stream.SectionOffset = stream.Offset;
+    WriteWorldSaveStream( stream, sizes, sizeof(sizes) );
+
+    memzero( &stream.Zip, sizeof(stream.Zip) );
+    if( stream.Ok && deflateInit( &stream.Zip, Z_BEST_SPEED ) == Z_OK )
+    {
+        stream.Section = true;
+        stream.SectionSize = 0;
+    }
+    else
+    {
+        stream.Ok = false;
+    }
+}
+
+bool FOServer::EndWorldSaveSection( WorldSaveStream& stream )
+{
+    if( !stream.Section )
+        return stream.Ok;
+
+    stream.Zip.next_in = NULL;
+    stream.Zip.avail_in = 0;
+    if( stream.Ok )
+        DeflateWorldSaveStream( stream, Z_FINISH );
+    deflateEnd( &stream.Zip );
+    stream.Section = false;
+
+    uint sizes[2] = { stream.SectionSize, stream.Offset - stream.SectionOffset - (uint)sizeof(sizes) };
+    if( stream.Ok )
+        stream.Ok = FileSetPointer( stream.File, stream.SectionOffset, SEEK_SET ) &&
+                    FileWrite( stream.File, sizes, sizeof(sizes) ) &&
+                    FileSetPointer( stream.File, 0, SEEK_END );
+    return stream.Ok;
+}
+
+bool FOServer::UnpackWorldSaveSections( UCharVec& data, uint pos, UCharVec& raw, UIntVec& offsets )
+{
+    WorldSaveSection sections[WORLD_SAVE_SECTIONS];
+    uint             raw_size = 0;
+    offsets.clear();
+    for( uint i = 0; i < WORLD_SAVE_SECTIONS; i++ )
+    {
+        WorldSaveSection& section = sections[i];
+        if( !ReadWorldSaveData( data, pos, sizeof(section.RawSize), &section.RawSize ) ||
+            !ReadWorldSaveData( data, pos, sizeof(section.Size), &section.Size ) ||
+            section.Size > data.size() - pos || section.RawSize > MAX_UINT - raw_size )
+            return false;
+        section.Data = (section.Size ? &data[pos] : NULL);
+        section.Ok = false;
+        pos += section.Size;
+        offsets.push_back( raw_size );
+        raw_size += section.RawSize;
+    }
+    if( pos != data.size() )
+        return false;
+
+    raw.resize( raw_size );
+    for( uint i = 0; i < WORLD_SAVE_SECTIONS; i++ )
+        sections[i].Raw = (sections[i].RawSize ? &raw[offsets[i]] : NULL);
+
+    // Independent zlib streams, unpack all at once
+    Thread threads[WORLD_SAVE_SECTIONS];
+    for( uint i = 1; i < WORLD_SAVE_SECTIONS; i++ )
+        if( !threads[i].Start( UnpackWorldSaveSection_Work, "WorldUnpack", &sections[i] ) )
+            UnpackWorldSaveSection_Work( &sections[i] );
+    UnpackWorldSaveSection_Work( &sections[0] );
+
+    bool ok = true;
+    for( uint i = 0; i < WORLD_SAVE_SECTIONS; i++ )
+    {
+        threads[i].Wait();
+        if( !sections[i].Ok )
+            ok = false;
     }
+    return ok;
+}
 
-    size_t flush = (size <= WorldSaveDataBufFreeSize ? size : WorldSaveDataBufFreeSize);
-    if( flush )
+void FOServer::UnpackWorldSaveSection_Work( void* data )
+{
+    WorldSaveSection* section = (WorldSaveSection*)data;
+    if( !section->RawSize )
     {
-        uchar* ptr = WorldSaveData[WorldSaveDataBufCount - 1];
-        memcpy( &ptr[WORLD_SAVE_DATA_BUFFER_SIZE - WorldSaveDataBufFreeSize], data, flush );
-        WorldSaveDataBufFreeSize -= flush;
-        if( !WorldSaveDataBufFreeSize )
-            AddWorldSaveData( ( (uchar*)data ) + flush, size - flush );
+        section->Ok = true;
+        return;
     }
+
+    uLongf size = section->RawSize;
+    section->Ok = (uncompress( section->Raw, &size, section->Data, section->Size ) == Z_OK && size == section->RawSize);
 }
 
 void FOServer::AddClientSaveData( Client* cl )
@@ -4942,56 +6163,122 @@ void FOServer::Dump_Work( void* data )
         // Paths
         char save_path[MAX_FOPATH];
         FileManager::GetFullPath( NULL, PATH_SERVER_SAVE, save_path );
-        char clients_path[MAX_FOPATH];
-        FileManager::GetFullPath( NULL, PATH_SERVER_CLIENTS, clients_path );
 
         // Save world data
-        void* fworld = FileOpen( Str::Format( fname, "%sworld%04d.fo", save_path, SaveWorldIndex + 1 ), true );
-        if( fworld )
+        if( SaveWorldDelta )
         {
+            // Append entry to journal of last full dump
+            uint base_index = (SaveWorldIndex ? SaveWorldIndex : WORLD_SAVE_MAX_INDEX);
+            uint magic = WORLD_SAVE_JOURNAL_MAGIC;
+            uint size = 0;
+            uint crc = 0;
             for( uint i = 0; i < WorldSaveDataBufCount; i++ )
             {
-                uchar* ptr = WorldSaveData[i];
                 size_t flush = WORLD_SAVE_DATA_BUFFER_SIZE;
                 if( i == WorldSaveDataBufCount - 1 )
                     flush -= WorldSaveDataBufFreeSize;
-                FileWrite( fworld, ptr, flush );
-                Thread::Sleep( 1 );
+                Crypt.Crc32( WorldSaveData[i], (uint)flush, crc );
+                size += (uint)flush;
+            }
+
+            void* fjournal = FileOpenForAppend( Str::Format( fname, "%sworld%04d.fod", save_path, base_index ) );
+            bool  ok = false;
+            if( fjournal )
+            {
+                ok = FileWrite( fjournal, &magic, sizeof(magic) ) && FileWrite( fjournal, &size, sizeof(size) );
+                for( uint i = 0; i < WorldSaveDataBufCount && ok; i++ )
+                {
+                    size_t flush = WORLD_SAVE_DATA_BUFFER_SIZE;
+                    if( i == WorldSaveDataBufCount - 1 )
+                        flush -= WorldSaveDataBufFreeSize;
+                    ok = FileWrite( fjournal, WorldSaveData[i], (uint)flush );
+                }
+                ok = ok && FileWrite( fjournal, &crc, sizeof(crc) );
+                FileClose( fjournal );
+                if( ok )
+                    SaveWorldJournalCount++;
+                else
+                    WriteLogF( _FUNC_, " - Can't write world journal file<%s>.\n", fname );
+            }
+            else
+            {
+                WriteLogF( _FUNC_, " - Can't open world journal file<%s>.\n", fname );
+            }
+
+            // Changes of this entry already unmarked in records, so next dump must be full,
+            // partially written entry is skipped on load with all next ones
+            if( !ok )
+                SaveWorldJournalReady = false;
+
+            // Merge journal into next full dump
+            if( ok && SaveWorldJournalCount >= SaveWorldJournalMax )
+            {
+                uint next_index = SaveWorldIndex + 1;
+                if( next_index > WORLD_SAVE_MAX_INDEX )
+                    next_index = 1;
+                if( CompactWorldSave( base_index, next_index ) )
+                {
+                    SaveWorldIndex = (next_index >= WORLD_SAVE_MAX_INDEX ? 0 : next_index);
+                    SaveWorldJournalCount = 0;
+                }
             }
-            FileClose( fworld );
-            SaveWorldIndex++;
-            if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
-                SaveWorldIndex = 0;
         }
         else
         {
-            WriteLogF( _FUNC_, " - Can't create world dump file<%s>.\n", fname );
+            void* fworld = FileOpen( Str::Format( fname, "%sworld%04d.fo", save_path, SaveWorldIndex + 1 ), true );
+            bool  ok = false;
+            if( fworld )
+            {
+                // Sections packed while written
+                WorldSaveStream stream;
+                size_t          total = WorldSaveDataBufCount * WORLD_SAVE_DATA_BUFFER_SIZE - WorldSaveDataBufFreeSize;
+                size_t          pos = 0;
+                BeginWorldSaveStream( stream, fworld );
+                for( uint i = 0; i <= WorldSaveSections.size(); i++ )
+                {
+                    size_t end = (i < WorldSaveSections.size() ? WorldSaveSections[i] : total);
+                    while( pos < end )
+                    {
+                        size_t offset = pos % WORLD_SAVE_DATA_BUFFER_SIZE;
+                        size_t flush = MIN( WORLD_SAVE_DATA_BUFFER_SIZE - offset, end - pos );
+                        WriteWorldSaveStream( stream, WorldSaveData[pos / WORLD_SAVE_DATA_BUFFER_SIZE] + offset, flush );
+                        pos += flush;
+                    }
+                    if( i < WorldSaveSections.size() )
+                        BeginWorldSaveSection( stream );
+                }
+                ok = EndWorldSaveSection( stream );
+                FileClose( fworld );
+                if( !ok )
+                {
+                    WriteLogF( _FUNC_, " - Can't write world dump file<%s>.\n", fname );
+                    FileDelete( fname );
+                }
+            }
+            if( ok )
+            {
+                SaveWorldIndex++;
+                if( SaveWorldIndex >= WORLD_SAVE_MAX_INDEX )
+                    SaveWorldIndex = 0;
+
+                // Journal from previous server sessions
+                FileDelete( Str::Format( fname, "%sworld%04d.fod", save_path, SaveWorldIndex ? SaveWorldIndex : WORLD_SAVE_MAX_INDEX ) );
+                SaveWorldJournalCount = 0;
+            }
+            else if( !fworld )
+            {
+                WriteLogF( _FUNC_, " - Can't create world dump file<%s>.\n", fname );
+            }
+
+            // Next saves are appended to this dump only if it is written
+            SaveWorldJournalReady = ok;
         }
 
         // Save clients data
         for( uint i = 0; i < ClientsSaveDataCount; i++ )
         {
             ClientSaveData& csd = ClientsSaveData[i];
-
-            char            fname[MAX_FOPATH];
-            Str::Format( fname, "%s%s.client", clients_path, csd.Name );
-            void*           fc = FileOpen( fname, true );
-            if( !fc )
-            {
-                WriteLogF( _FUNC_, " - Unable to open client save file<%s>.\n", fname );
-                continue;
-            }
-
-            FileWrite( fc, ClientSaveSignature, sizeof(ClientSaveSignature) );
-            FileWrite( fc, csd.PasswordHash, sizeof(csd.PasswordHash) );
-            FileWrite( fc, &csd.Data, sizeof(csd.Data) );
-            FileWrite( fc, &csd.DataExt, sizeof(csd.DataExt) );
-            uint te_count = (uint)csd.TimeEvents.size();
-            FileWrite( fc, &te_count, sizeof(te_count) );
-            if( te_count )
-                FileWrite( fc, &csd.TimeEvents[0], te_count * sizeof(Critter::CrTimeEvent) );
-            FileClose( fc );
-            Thread::Sleep( 1 );
+            AppendClientsDbRecord( csd.Name, csd.PasswordHash, &csd.Data, &csd.DataExt, &csd.TimeEvents );
         }
 
         // Clear old dump files
@@ -5003,6 +6290,8 @@ void FOServer::Dump_Work( void* data )
                 FileClose( fold );
                 FileDelete( fname );
             }
+            if( FileExist( Str::Format( fname, "%sworld%04d.fod", save_path, *it ) ) )
+                FileDelete( fname );
         }
 
         // Notify about end of processing
@@ -5010,6 +6299,326 @@ void FOServer::Dump_Work( void* data )
     }
 }
 
+bool FOServer::ReadWorldSaveData( UCharVec& data, uint& pos, uint size, void* out /* = NULL */ )
+{
+    if( size > data.size() || pos > data.size() - size )
+        return false;
+    if( out && size )
+        memcpy( out, &data[pos], size );
+    pos += size;
+    return true;
+}
+
+bool FOServer::ReadWorldSaveHead( UCharVec& data, uint& pos, UCharVec& head )
+{
+    // Same layout as SaveGameInfoFile and MapManager::SaveAllLocationsAndMapsFile
+    uint begin = pos;
+    uint sp = 0;
+    if( !ReadWorldSaveData( data, pos, sizeof(sp), &sp ) )
+        return false;
+    if( sp )
+    {
+        uint te_count = 0, pic_size = 0;
+        if( !ReadWorldSaveData( data, pos, sizeof(SingleplayerSave.CrData.Name) + sizeof(CritData) + sizeof(CritDataExt) ) ||
+            !ReadWorldSaveData( data, pos, sizeof(te_count), &te_count ) ||
+            !ReadWorldSaveData( data, pos, te_count * sizeof(Critter::CrTimeEvent) ) ||
+            !ReadWorldSaveData( data, pos, sizeof(pic_size), &pic_size ) ||
+            !ReadWorldSaveData( data, pos, pic_size ) )
+            return false;
+    }
+    uint time_size = sizeof(GameOpt.YearStart) + sizeof(GameOpt.Year) + sizeof(GameOpt.Month) + sizeof(GameOpt.Day) +
+                     sizeof(GameOpt.Hour) + sizeof(GameOpt.Minute) + sizeof(GameOpt.Second) + sizeof(GameOpt.TimeMultiplier);
+    if( !ReadWorldSaveData( data, pos, time_size + sizeof(BestScores) ) )
+        return false;
+
+    uint loc_count = 0;
+    if( !ReadWorldSaveData( data, pos, sizeof(loc_count), &loc_count ) )
+        return false;
+    for( uint i = 0; i < loc_count; i++ )
+    {
+        uint map_count = 0;
+        if( !ReadWorldSaveData( data, pos, sizeof(Location::LocData) ) ||
+            !ReadWorldSaveData( data, pos, sizeof(map_count), &map_count ) ||
+            !ReadWorldSaveData( data, pos, map_count * sizeof(Map::MapData) ) )
+            return false;
+    }
+
+    head.assign( data.begin() + begin, data.begin() + pos );
+    return true;
+}
+
+bool FOServer::ReadWorldSaveRecords( UCharVec& data, uint& pos, uint end, WorldSaveImage& image, bool delta )
+{
+    // Npcs, same layout as CritterManager::SaveCritter
+    uint count = 0;
+    if( !ReadWorldSaveData( data, pos, sizeof(count), &count ) )
+        return false;
+    for( uint i = 0; i < count; i++ )
+    {
+        uint     begin = pos;
+        CritData cr_data;
+        uint     te_count = 0;
+        if( !ReadWorldSaveData( data, pos, sizeof(cr_data), &cr_data ) ||
+            !ReadWorldSaveData( data, pos, cr_data.IsDataExt ? sizeof(CritDataExt) : 0 ) ||
+            !ReadWorldSaveData( data, pos, sizeof(te_count), &te_count ) ||
+            !ReadWorldSaveData( data, pos, te_count * sizeof(Critter::CrTimeEvent) ) )
+            return false;
+        image.Npcs[cr_data.Id].assign( data.begin() + begin, data.begin() + pos );
+    }
+    if( delta )
+    {
+        if( !ReadWorldSaveData( data, pos, sizeof(count), &count ) )
+            return false;
+        for( uint i = 0; i < count; i++ )
+        {
+            uint id = 0;
+            if( !ReadWorldSaveData( data, pos, sizeof(id), &id ) )
+                return false;
+            image.Npcs.erase( id );
+        }
+    }
+
+    // Items, same layout as ItemManager::SaveItem
+    if( !ReadWorldSaveData( data, pos, sizeof(count), &count ) )
+        return false;
+    for( uint i = 0; i < count; i++ )
+    {
+        uint  begin = pos;
+        uint  id = 0;
+        uchar lex_len = 0;
+        if( !ReadWorldSaveData( data, pos, sizeof(id), &id ) ||
+            !ReadWorldSaveData( data, pos, sizeof(ushort) + sizeof(uchar) + sizeof(Item::AccBuffer) + sizeof(Item::ItemData) ) ||
+            !ReadWorldSaveData( data, pos, sizeof(lex_len), &lex_len ) ||
+            !ReadWorldSaveData( data, pos, lex_len ) )
+            return false;
+        image.Items[id].assign( data.begin() + begin, data.begin() + pos );
+    }
+    if( delta )
+    {
+        if( !ReadWorldSaveData( data, pos, sizeof(count), &count ) )
+            return false;
+        for( uint i = 0; i < count; i++ )
+        {
+            uint id = 0;
+            if( !ReadWorldSaveData( data, pos, sizeof(id), &id ) )
+                return false;
+            image.Items.erase( id );
+        }
+    }
+
+    // Vars, same layout as VarManager::SaveVar
+    if( !ReadWorldSaveData( data, pos, sizeof(count), &count ) )
+        return false;
+    for( uint i = 0; i < count; i++ )
+    {
+        uint            begin = pos;
+        WorldSaveVarKey key;
+        if( !ReadWorldSaveData( data, pos, sizeof(key.TempId), &key.TempId ) ||
+            !ReadWorldSaveData( data, pos, sizeof(key.MasterId), &key.MasterId ) ||
+            !ReadWorldSaveData( data, pos, sizeof(key.SlaveId), &key.SlaveId ) ||
+            !ReadWorldSaveData( data, pos, sizeof(int) ) )
+            return false;
+        image.Vars[key].assign( data.begin() + begin, data.begin() + pos );
+    }
+    if( delta )
+    {
+        if( !ReadWorldSaveData( data, pos, sizeof(count), &count ) )
+            return false;
+        for( uint i = 0; i < count; i++ )
+        {
+            WorldSaveVarKey key;
+            if( !ReadWorldSaveData( data, pos, sizeof(key.TempId), &key.TempId ) ||
+                !ReadWorldSaveData( data, pos, sizeof(key.MasterId), &key.MasterId ) ||
+                !ReadWorldSaveData( data, pos, sizeof(key.SlaveId), &key.SlaveId ) )
+                return false;
+            image.Vars.erase( key );
+        }
+    }
+
+    // Rest of data saved as is
+    if( pos > end )
+        return false;
+    image.Tail.assign( data.begin() + pos, data.begin() + end );
+    pos = end;
+    return true;
+}
+
+bool FOServer::ReadWorldSaveImage( const char* fname, WorldSaveImage& image )
+{
+    void* f = FileOpen( fname, false );
+    if( !f )
+        return false;
+    UCharVec data( FileGetSize( f ) );
+    bool     read_ok = (data.empty() || FileRead( f, &data[0], (uint)data.size() ) );
+    FileClose( f );
+    if( !read_ok )
+        return false;
+
+    // Journals written only for not legacy dumps
+    uint pos = 0;
+    if( data.size() < sizeof(WorldSaveSignature) || !BINARY_SIGNATURE_VALID( WorldSaveSignature, (&data[0]) ) )
+        return false;
+    image.Version = BINARY_SIGNATURE_VERSION( (&data[0]) );
+    if( image.Version < WORLD_SAVE_V1 || image.Version > WORLD_SAVE_LAST )
+        return false;
+    pos += sizeof(WorldSaveSignature);
+    if( image.Version < WORLD_SAVE_V2 )
+        return ReadWorldSaveHead( data, pos, image.Head ) && ReadWorldSaveRecords( data, pos, (uint)data.size(), image, false );
+
+    // Prototypes section kept as is, rest has not packed layout
+    UCharVec raw;
+    UIntVec  offsets;
+    if( !UnpackWorldSaveSections( data, pos, raw, offsets ) )
+        return false;
+    image.Protos.assign( raw.begin(), raw.begin() + offsets[1] );
+    pos = offsets[1];
+    return ReadWorldSaveHead( raw, pos, image.Head ) && ReadWorldSaveRecords( raw, pos, (uint)raw.size(), image, false );
+}
+
+bool FOServer::ApplyWorldSaveJournal( const char* fname, WorldSaveImage& image, uint& entries )
+{
+    entries = 0;
+    void* f = FileOpen( fname, false );
+    if( !f )
+        return false;
+    UCharVec data( FileGetSize( f ) );
+    bool     read_ok = (data.empty() || FileRead( f, &data[0], (uint)data.size() ) );
+    FileClose( f );
+    if( !read_ok )
+        return false;
+
+    uint pos = 0;
+    while( pos < data.size() )
+    {
+        // Entry written partially at crash is ignored with all next
+        uint magic = 0, size = 0, crc = 0, entry_crc = 0;
+        if( !ReadWorldSaveData( data, pos, sizeof(magic), &magic ) || magic != WORLD_SAVE_JOURNAL_MAGIC ||
+            !ReadWorldSaveData( data, pos, sizeof(size), &size ) || size > data.size() - pos ||
+            data.size() - pos - size < sizeof(entry_crc) )
+        {
+            WriteLogF( _FUNC_, " - Journal<%s> truncated after entry %u.\n", fname, entries );
+            break;
+        }
+        uint end = pos + size;
+        memcpy( &entry_crc, &data[end], sizeof(entry_crc) );
+        if( size )
+            Crypt.Crc32( &data[pos], size, crc );
+        if( crc != entry_crc )
+        {
+            WriteLogF( _FUNC_, " - Journal<%s> entry %u has invalid checksum.\n", fname, entries + 1 );
+            break;
+        }
+
+        if( !ReadWorldSaveHead( data, pos, image.Head ) || !ReadWorldSaveRecords( data, pos, end, image, true ) )
+        {
+            WriteLogF( _FUNC_, " - Journal<%s> entry %u is corrupted.\n", fname, entries + 1 );
+            return false;
+        }
+        pos = end + sizeof(entry_crc);
+        entries++;
+    }
+    return true;
+}
+
+bool FOServer::WriteWorldSaveImage( const char* fname, WorldSaveImage& image )
+{
+    void* f = FileOpen( fname, true );
+    if( !f )
+        return false;
+
+    // Version of base dump kept, journal records have its layout
+    bool            packed = (image.Version >= WORLD_SAVE_V2);
+    WorldSaveStream stream;
+    BeginWorldSaveStream( stream, f );
+    WriteWorldSaveStream( stream, packed ? WorldSaveSignature : WorldSaveSignatureV1, sizeof(WorldSaveSignature) );
+    if( packed )
+    {
+        BeginWorldSaveSection( stream );
+        if( !image.Protos.empty() )
+            WriteWorldSaveStream( stream, &image.Protos[0], image.Protos.size() );
+        BeginWorldSaveSection( stream );
+    }
+    if( !image.Head.empty() )
+        WriteWorldSaveStream( stream, &image.Head[0], image.Head.size() );
+
+    uint count = (uint)image.Npcs.size();
+    if( packed )
+        BeginWorldSaveSection( stream );
+    WriteWorldSaveStream( stream, &count, sizeof(count) );
+    for( auto it = image.Npcs.begin(), end = image.Npcs.end(); it != end && stream.Ok; ++it )
+        WriteWorldSaveStream( stream, &(*it).second[0], (*it).second.size() );
+
+    count = (uint)image.Items.size();
+    if( packed )
+        BeginWorldSaveSection( stream );
+    WriteWorldSaveStream( stream, &count, sizeof(count) );
+    for( auto it = image.Items.begin(), end = image.Items.end(); it != end && stream.Ok; ++it )
+        WriteWorldSaveStream( stream, &(*it).second[0], (*it).second.size() );
+
+    count = (uint)image.Vars.size();
+    if( packed )
+        BeginWorldSaveSection( stream );
+    WriteWorldSaveStream( stream, &count, sizeof(count) );
+    for( auto it = image.Vars.begin(), end = image.Vars.end(); it != end && stream.Ok; ++it )
+        WriteWorldSaveStream( stream, &(*it).second[0], (*it).second.size() );
+
+    if( packed )
+        BeginWorldSaveSection( stream );
+    if( !image.Tail.empty() )
+        WriteWorldSaveStream( stream, &image.Tail[0], image.Tail.size() );
+    bool ok = EndWorldSaveSection( stream );
+    FileClose( f );
+    return ok;
+}
+
+bool FOServer::CompactWorldSave( uint base_index, uint out_index )
+{
+    double tick = Timer::AccurateTick();
+
+    char save_path[MAX_FOPATH];
+    FileManager::GetFullPath( NULL, PATH_SERVER_SAVE, save_path );
+    char base_fname[MAX_FOPATH];
+    Str::Format( base_fname, "%sworld%04d.fo", save_path, base_index );
+    char journal_fname[MAX_FOPATH];
+    Str::Format( journal_fname, "%sworld%04d.fod", save_path, base_index );
+    char out_fname[MAX_FOPATH];
+    Str::Format( out_fname, "%sworld%04d.fo", save_path, out_index );
+    char tmp_fname[MAX_FOPATH];
+    Str::Format( tmp_fname, "%sworld%04d.tmp", save_path, out_index );
+
+    WorldSaveImage image;
+    uint           entries = 0;
+    if( !ReadWorldSaveImage( base_fname, image ) )
+    {
+        WriteLogF( _FUNC_, " - Unable to read world dump file<%s>.\n", base_fname );
+        return false;
+    }
+    if( !ApplyWorldSaveJournal( journal_fname, image, entries ) )
+    {
+        WriteLogF( _FUNC_, " - Unable to apply world journal file<%s>.\n", journal_fname );
+        return false;
+    }
+
+    // Write aside to not spoil last dump on failure
+    if( !WriteWorldSaveImage( tmp_fname, image ) )
+    {
+        WriteLogF( _FUNC_, " - Unable to write world dump file<%s>.\n", tmp_fname );
+        FileDelete( tmp_fname );
+        return false;
+    }
+    FileDelete( out_fname );
+    if( !FileRename( tmp_fname, out_fname ) )
+    {
+        WriteLogF( _FUNC_, " - Unable to rename<%s> to<%s>.\n", tmp_fname, out_fname );
+        return false;
+    }
+    Str::Format( journal_fname, "%sworld%04d.fod", save_path, out_index );
+    FileDelete( journal_fname );
+
+    WriteLog( "World journal<%u> merged into<%s>, entries %u, in %g ms.\n", base_index, out_fname, entries, Timer::AccurateTick() - tick );
+    return true;
+}
+
 /************************************************************************/
 /* Scores                                                               */
 /************************************************************************/
@@ -5093,27 +6702,27 @@ void FOServer::VarsGarbarger( bool force )
     }
 
     // Get client and npc ids
-    UIntSet ids_clients;
+    CIdMask ids_clients;
     if( !Singleplayer )
     {
         for( auto it = ClientsData.begin(), end = ClientsData.end(); it != end; ++it )
-            ids_clients.insert( (*it).ClientId );
+            ids_clients.SetBit( (*it).ClientId );
     }
     else
     {
-        ids_clients.insert( 1 );
+        ids_clients.SetBit( 1 );
     }
 
     // Get npc ids
-    UIntSet ids_npcs;
+    CIdMask ids_npcs;
     CrMngr.GetNpcIds( ids_npcs );
 
     // Get location and map ids
-    UIntSet ids_locs, ids_maps;
+    CIdMask ids_locs, ids_maps;
     MapMngr.GetLocationAndMapIds( ids_locs, ids_maps );
 
     // Get item ids
-    UIntSet ids_items;
+    CIdMask ids_items;
     ItemMngr.GetItemIds( ids_items );
 
     VarMngr.ClearUnusedVars( ids_npcs, ids_clients, ids_locs, ids_maps, ids_items );
@@ -5128,12 +6737,12 @@ void FOServer::SaveTimeEventsFile()
 {
     uint count = 0;
     for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        if( (*it)->IsSaved )
+        if( it->second->IsSaved )
             count++;
     AddWorldSaveData( &count, sizeof(count) );
     for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
     {
-        TimeEvent* te = *it;
+        TimeEvent* te = it->second;
         if( !te->IsSaved )
             continue;
         AddWorldSaveData( &te->Num, sizeof(te->Num) );
@@ -5214,10 +6823,12 @@ bool FOServer::LoadTimeEventsFile( void* f )
         te->IsSaved = true;
         te->InProcess = 0;
         te->EraseMe = false;
+        te->InQueue = false;
         if( values_size )
             te->Values = values;
 
-        TimeEvents.push_back( te );
+        TimeEvents.insert( PAIR( num, te ) );
+        AddTimeEvent( te );
         if( num > TimeEventsLastNum )
             TimeEventsLastNum = num;
     }
@@ -5230,16 +6841,29 @@ void FOServer::AddTimeEvent( TimeEvent* te )
 {
     // Invoked in locked scope
 
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    if( te->InQueue )
+        TimeEventsQueue.erase( te->QueueIt );
+    te->QueueIt = TimeEventsQueue.insert( PAIR( te->FullSecond, te ) );
+    te->InQueue = true;
+}
+
+void FOServer::EraseTimeEventFromQueue( TimeEvent* te )
+{
+    // Invoked in locked scope
+
+    if( te->InQueue )
     {
-        TimeEvent* te_ = *it;
-        if( te->FullSecond < te_->FullSecond )
-        {
-            TimeEvents.insert( it, te );
-            return;
-        }
+        TimeEventsQueue.erase( te->QueueIt );
+        te->InQueue = false;
     }
-    TimeEvents.push_back( te );
+}
+
+FOServer::TimeEvent* FOServer::FindTimeEvent( uint num )
+{
+    // Invoked in locked scope
+
+    auto it = TimeEvents.find( num );
+    return it != TimeEvents.end() ? it->second : NULL;
 }
 
 uint FOServer::CreateTimeEvent( uint begin_second, const char* script_name, int values, uint val1, ScriptArray* val2, bool save )
@@ -5272,6 +6896,7 @@ uint FOServer::CreateTimeEvent( uint begin_second, const char* script_name, int
     te->IsSaved = save;
     te->InProcess = 0;
     te->EraseMe = false;
+    te->InQueue = false;
     te->Rate = 0;
 
     if( values == 1 )
@@ -5290,6 +6915,7 @@ uint FOServer::CreateTimeEvent( uint begin_second, const char* script_name, int
         }
     }
 
+    TimeEvents.insert( PAIR( te->Num, te ) );
     AddTimeEvent( te );
     TimeEventsLastNum++;
     return TimeEventsLastNum;
@@ -5300,16 +6926,18 @@ void FOServer::TimeEventEndScriptCallback()
     SCOPE_LOCK( TimeEventsLocker );
 
     uint tid = Thread::GetCurrentId();
-    for( auto it = TimeEvents.begin(); it != TimeEvents.end();)
+    for( auto it = TimeEventsInProcess.begin(); it != TimeEventsInProcess.end();)
     {
         TimeEvent* te = *it;
         if( te->InProcess == tid )
         {
             te->InProcess = 0;
+            it = TimeEventsInProcess.erase( it );
 
             if( te->EraseMe )
             {
-                it = TimeEvents.erase( it );
+                EraseTimeEventFromQueue( te );
+                TimeEvents.erase( te->Num );
                 delete te;
             }
         }
@@ -5328,15 +6956,7 @@ bool FOServer::GetTimeEvent( uint num, uint& duration, ScriptArray* values )
     // Find event
     while( true )
     {
-        for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        {
-            TimeEvent* te_ = *it;
-            if( te_->Num == num )
-            {
-                te = te_;
-                break;
-            }
-        }
+        te = FindTimeEvent( num );
 
         // Event not found or erased
         if( !te || te->EraseMe )
@@ -5365,8 +6985,11 @@ bool FOServer::GetTimeEvent( uint num, uint& duration, ScriptArray* values )
     duration = (te->FullSecond > GameOpt.FullSecond ? te->FullSecond - GameOpt.FullSecond : 0);
 
     // Lock for current thread
-    if( LogicMT )
+    if( LogicMT && te->InProcess != tid )
+    {
         te->InProcess = tid;
+        TimeEventsInProcess.push_back( te );
+    }
 
     // Add end of script execution callback to unlock event if SetTimeEvent not be called
     if( LogicMT )
@@ -5386,15 +7009,7 @@ bool FOServer::SetTimeEvent( uint num, uint duration, ScriptArray* values )
     // Find event
     while( true )
     {
-        for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
-        {
-            TimeEvent* te_ = *it;
-            if( te_->Num == num )
-            {
-                te = te_;
-                break;
-            }
-        }
+        te = FindTimeEvent( num );
 
         // Event not found or erased
         if( !te || te->EraseMe )
@@ -5421,8 +7036,16 @@ bool FOServer::SetTimeEvent( uint num, uint duration, ScriptArray* values )
     if( values )
         Script::AssignScriptArrayInVector( te->Values, values );
     te->FullSecond = GameOpt.FullSecond + duration;
+    if( te->InQueue )
+        AddTimeEvent( te );
 
     // Unlock from current thread
+    if( te->InProcess == tid )
+    {
+        auto it = std::find( TimeEventsInProcess.begin(), TimeEventsInProcess.end(), te );
+        if( it != TimeEventsInProcess.end() )
+            TimeEventsInProcess.erase( it );
+    }
     te->InProcess = 0;
 
     TimeEventsLocker.Unlock();
@@ -5433,48 +7056,76 @@ bool FOServer::EraseTimeEvent( uint num )
 {
     SCOPE_LOCK( TimeEventsLocker );
 
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    TimeEvent* te = FindTimeEvent( num );
+    if( !te )
+        return false;
+
+    if( te->InProcess )
     {
-        TimeEvent* te = *it;
-        if( te->Num == num )
-        {
-            if( te->InProcess )
-            {
-                te->EraseMe = true;
-            }
-            else
-            {
-                delete te;
-                TimeEvents.erase( it );
-            }
-            return true;
-        }
+        te->EraseMe = true;
     }
-
-    return false;
+    else
+    {
+        EraseTimeEventFromQueue( te );
+        TimeEvents.erase( num );
+        delete te;
+    }
+    return true;
 }
 
 void FOServer::ProcessTimeEvents()
 {
-    TimeEventsLocker.Lock();
+    uint start_tick = Timer::FastTick();
+    uint tid = Thread::GetCurrentId();
 
-    TimeEvent* cur_event = NULL;
-    for( auto it = TimeEvents.begin(), end = TimeEvents.end(); it != end; ++it )
+    // Process all due events, limited by time
+    while( true )
     {
-        TimeEvent* te = *it;
-        if( !te->InProcess && te->FullSecond <= GameOpt.FullSecond )
+        TimeEventsLocker.Lock();
+
+        TimeEvent* cur_event = NULL;
+        for( auto it = TimeEventsQueue.begin(), end = TimeEventsQueue.end(); it != end && it->first <= GameOpt.FullSecond; ++it )
         {
-            te->InProcess = Thread::GetCurrentId();
-            cur_event = te;
-            break;
+            TimeEvent* te = it->second;
+            if( !te->InProcess )
+            {
+                te->InProcess = tid;
+                EraseTimeEventFromQueue( te );
+                cur_event = te;
+                break;
+            }
         }
-    }
 
-    TimeEventsLocker.Unlock();
+        if( !cur_event || Timer::FastTick() - start_tick >= TIME_EVENTS_MAX_PROCESS_TIME )
+        {
+            // Due events left to next cycle
+            uint backlog = 0;
+            for( auto it = TimeEventsQueue.begin(), end = TimeEventsQueue.end(); it != end && it->first <= GameOpt.FullSecond; ++it )
+                backlog++;
+            TimeEventsStatistics.Backlog = backlog;
 
-    if( !cur_event )
-        return;
+            if( cur_event )
+            {
+                cur_event->InProcess = 0;
+                AddTimeEvent( cur_event );
+            }
+            TimeEventsLocker.Unlock();
+            return;
+        }
+
+        uint lateness = GameOpt.FullSecond - cur_event->FullSecond;
+        TimeEventsStatistics.Processed++;
+        TimeEventsStatistics.LatenessSum += lateness;
+        TimeEventsStatistics.LatenessMax = MAX( TimeEventsStatistics.LatenessMax, lateness );
+
+        TimeEventsLocker.Unlock();
+
+        RunTimeEvent( cur_event );
+    }
+}
 
+void FOServer::RunTimeEvent( TimeEvent* cur_event )
+{
     uint wait_time = 0;
     if( Script::PrepareContext( cur_event->BindId, _FUNC_, Str::FormatBuf( "Time event<%u>, name<%s>", cur_event->Num, cur_event->FuncName.c_str() ) ) )
     {
@@ -5530,10 +7181,7 @@ void FOServer::ProcessTimeEvents()
         wait_time = GameOpt.TimeMultiplier * 600;
     }
 
-    TimeEventsLocker.Lock();
-
-    auto it = std::find( TimeEvents.begin(), TimeEvents.end(), cur_event );
-    TimeEvents.erase( it );
+    SCOPE_LOCK( TimeEventsLocker );
 
     if( wait_time && !cur_event->EraseMe )
     {
@@ -5544,10 +7192,9 @@ void FOServer::ProcessTimeEvents()
     }
     else
     {
+        TimeEvents.erase( cur_event->Num );
         delete cur_event;
     }
-
-    TimeEventsLocker.Unlock();
 }
 
 uint FOServer::GetTimeEventsCount()
@@ -5569,10 +7216,14 @@ string FOServer::GetTimeEventsStatistics()
     DateTime st = Timer::GetGameTime( GameOpt.FullSecond );
     Str::Format( str, "Game time: %02u.%02u.%04u %02u:%02u:%02u\n", st.Day, st.Month, st.Year, st.Hour, st.Minute, st.Second );
     result += str;
+    TimeEventsStatistics_& stats = TimeEventsStatistics;
+    Str::Format( str, "Processed: %u, backlog: %u, lateness average: %u, max: %u (game seconds)\n", stats.Processed, stats.Backlog,
+                 (uint)(stats.Processed ? stats.LatenessSum / stats.Processed : 0), stats.LatenessMax );
+    result += str;
     result += "Number    Date       Time     Rate Saved Function                            Values\n";
-    for( uint i = 0, j = (uint)TimeEvents.size(); i < j; i++ )
+    for( auto it = TimeEventsQueue.begin(), end = TimeEventsQueue.end(); it != end; ++it )
     {
-        TimeEvent* te = TimeEvents[i];
+        TimeEvent* te = it->second;
         st = Timer::GetGameTime( te->FullSecond );
         Str::Format( str, "%09u %02u.%02u.%04u %02u:%02u:%02u %04u %-5s %-35s", te->Num, st.Day, st.Month, st.Year, st.Hour, st.Minute, st.Second, te->Rate, te->IsSaved ? "true" : "false", te->FuncName.c_str() );
         result += str;
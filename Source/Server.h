@@ -26,6 +26,9 @@
 // #define new new(_NORMAL_BLOCK, __FILE__, __LINE__)
 // #endif
 
+// Network IO event loops limit
+#define NETIO_MAX_LOOPS                      (32)
+
 // Check buffer for error
 #define CHECK_IN_BUFF_ERROR( client )        CHECK_IN_BUFF_ERROR_EX( client, 0 )
 #define CHECK_IN_BUFF_ERROR_EX( client, ext )                                           \
@@ -82,7 +85,7 @@ public:
 
     static void Send_Raw( Client* cl, uint data, bool fast = true );
 
-    static void Send_MapData( Client* cl, ProtoMap* pmap, uchar send_info );
+    static void Send_MapData( Client* cl, ProtoMap* pmap, const UIntVec& region_hashes );
     static void Send_MsgData( Client* cl, uint lang, ushort num_msg, FOMsg& data_msg );
     static void Send_ProtoItemData( Client* cl, uchar type, ProtoItemVec& data, uint data_hash );
 
@@ -129,36 +132,54 @@ public:
 
     // Time events
     #define TIME_EVENTS_PER_CYCLE            (10)
+    #define TIME_EVENTS_MAX_PROCESS_TIME     (20) // Ms, one job
+    struct TimeEvent;
+    typedef multimap<uint, TimeEvent*> TimeEventQueue;
     struct TimeEvent
     {
-        uint    Num;
-        uint    FullSecond;
-        string  FuncName;
-        int     BindId;
-        uint    Rate;
-        UIntVec Values;
-        bool    SignedValues;
-        bool    IsSaved;
-        uint    InProcess;
-        bool    EraseMe;
+        uint                     Num;
+        uint                     FullSecond;
+        string                   FuncName;
+        int                      BindId;
+        uint                     Rate;
+        UIntVec                  Values;
+        bool                     SignedValues;
+        bool                     IsSaved;
+        uint                     InProcess;
+        bool                     EraseMe;
+        bool                     InQueue;
+        TimeEventQueue::iterator QueueIt;
     };
-    typedef vector<TimeEvent*> TimeEventVec;
-    static TimeEventVec TimeEvents;
-    static TimeEventVec TimeEventsInProcess;
-    static uint         TimeEventsLastNum;
-    static Mutex        TimeEventsLocker;
-
-    static void   SaveTimeEventsFile();
-    static bool   LoadTimeEventsFile( void* f );
-    static void   AddTimeEvent( TimeEvent* te );
-    static uint   CreateTimeEvent( uint begin_second, const char* script_name, int values, uint val1, ScriptArray* val2, bool save );
-    static void   TimeEventEndScriptCallback();
-    static bool   GetTimeEvent( uint num, uint& duration, ScriptArray* values );
-    static bool   SetTimeEvent( uint num, uint duration, ScriptArray* values );
-    static bool   EraseTimeEvent( uint num );
-    static void   ProcessTimeEvents();
-    static uint   GetTimeEventsCount();
-    static string GetTimeEventsStatistics();
+    typedef vector<TimeEvent*>    TimeEventVec;
+    typedef map<uint, TimeEvent*> TimeEventMap;
+    static TimeEventMap   TimeEvents;          // By number
+    static TimeEventQueue TimeEventsQueue;     // By full second
+    static TimeEventVec   TimeEventsInProcess; // Locked by GetTimeEvent
+    static uint           TimeEventsLastNum;
+    static Mutex          TimeEventsLocker;
+
+    struct TimeEventsStatistics_
+    {
+        uint   Processed;
+        uint64 LatenessSum;
+        uint   LatenessMax;
+        uint   Backlog;
+    } static TimeEventsStatistics;
+
+    static void       SaveTimeEventsFile();
+    static bool       LoadTimeEventsFile( void* f );
+    static void       AddTimeEvent( TimeEvent* te );
+    static void       EraseTimeEventFromQueue( TimeEvent* te );
+    static TimeEvent* FindTimeEvent( uint num );
+    static uint       CreateTimeEvent( uint begin_second, const char* script_name, int values, uint val1, ScriptArray* val2, bool save );
+    static void       TimeEventEndScriptCallback();
+    static bool       GetTimeEvent( uint num, uint& duration, ScriptArray* values );
+    static bool       SetTimeEvent( uint num, uint duration, ScriptArray* values );
+    static bool       EraseTimeEvent( uint num );
+    static void       ProcessTimeEvents();
+    static void       RunTimeEvent( TimeEvent* cur_event );
+    static uint       GetTimeEventsCount();
+    static string     GetTimeEventsStatistics();
 
     static void SaveScriptFunctionsFile();
     static bool LoadScriptFunctionsFile( void* f );
@@ -252,7 +273,7 @@ public:
 
     static void DisconnectClient( Client* cl );
     static void RemoveClient( Client* cl );
-    static void DeleteClientFile( const char* client_name );
+    static void DeleteClientRecord( const char* client_name );
     static void AddSaveClient( Client* cl );
     static void EraseSaveClient( uint crid );
     static void Process( ClientPtr& cl );
@@ -277,6 +298,7 @@ public:
     // Init/Finish
     static bool Init();
     static bool InitReal();
+    static bool CompileMaps();
     static void Finish();
     static bool Starting() { return Active && ActiveInProcess; }
     static bool Started()  { return Active && !ActiveInProcess; }
@@ -301,11 +323,14 @@ public:
     static void Net_Listen( void* );
 
     #if defined (USE_LIBEVENT)
-    static event_base* NetIOEventHandler;
-    static Thread      NetIOThread;
-    static uint        NetIOThreadsCount;
-
-    static void NetIO_Loop( void* );
+    static event_base** NetIOEventHandlers;
+    static Thread*      NetIOThreads;
+    static uint         NetIOThreadsCount;
+    static uint         NetIONextLoop;
+    static SOCKET*      NetIOListenSocks;     // SO_REUSEPORT listeners of loops, except first loop that use ListenSock
+    static Thread*      NetIOListenThreads;
+
+    static void NetIO_Loop( void* data );
     static void NetIO_Event( bufferevent* bev, short what, void* arg );
     static void NetIO_Input( bufferevent* bev, void* arg );
     static void NetIO_Output( bufferevent* bev, void* arg );
@@ -356,6 +381,84 @@ public:
     static MutexEvent DumpBeginEvent, DumpEndEvent;
     static Thread     DumpThread;
 
+    // Since WORLD_SAVE_V2 dump after signature consists of zlib packed sections,
+    // each prefixed with unpacked and packed sizes; concatenated sections have WORLD_SAVE_V1 layout,
+    // except prototypes params in first section
+    #define WORLD_SAVE_SECTIONS            (6)           // Prototypes, game info with maps, npcs, items, vars, rest
+    #define WORLD_SAVE_STREAM_BUFFER_SIZE  (256 * 1024)
+    struct WorldSaveStream
+    {
+        void*    File;
+        z_stream Zip;
+        bool     Section;       // Packed section in progress
+        bool     Ok;
+        uint     Offset;        // Bytes written to file
+        uint     SectionOffset; // Position of section sizes
+        uint     SectionSize;   // Unpacked size of section
+        UCharVec Buf;
+    };
+    struct WorldSaveSection
+    {
+        const uchar* Data;
+        uint         Size;
+        uchar*       Raw;
+        uint         RawSize;
+        bool         Ok;
+    };
+    static UIntVec         WorldSaveSections; // Sections begin in collected data
+    static WorldSaveStream DumpStream;
+
+    static void AddWorldSaveSection();
+    static void BeginWorldSaveStream( WorldSaveStream& stream, void* f );
+    static void WriteWorldSaveStream( WorldSaveStream& stream, const void* data, size_t size );
+    static void DeflateWorldSaveStream( WorldSaveStream& stream, int flush );
+    static void BeginWorldSaveSection( WorldSaveStream& stream );
+    static bool EndWorldSaveSection( WorldSaveStream& stream );
+    static bool UnpackWorldSaveSections( UCharVec& data, uint pos, UCharVec& raw, UIntVec& offsets );
+    static void UnpackWorldSaveSection_Work( void* data );
+
+    // Delta saves
+    // Between full dumps only changed npcs, items and vars are appended to worldXXXX.fod journal,
+    // Dump_Work merges journal with its base into next worldXXXX.fo
+    // Records changed through setters marked by IsSaveChanged, direct data changes found by checksums,
+    // which verified for part of records per save, every record once per journal cycle
+    #define WORLD_SAVE_JOURNAL_MAGIC       (0x4A444F46)  // FODJ
+    struct WorldSaveVarKey
+    {
+        ushort TempId;
+        uint   MasterId;
+        uint   SlaveId;
+
+        bool   operator<( const WorldSaveVarKey& r ) const { return TempId != r.TempId ? TempId < r.TempId : (MasterId != r.MasterId ? MasterId < r.MasterId : SlaveId < r.SlaveId); }
+    };
+    typedef map<uint, UCharVec>            WorldSaveBlobMap;
+    typedef map<WorldSaveVarKey, UCharVec> WorldSaveVarBlobMap;
+    struct WorldSaveImage
+    {
+        ushort              Version;
+        UCharVec            Protos; // Prototypes params, since WORLD_SAVE_V2
+        UCharVec            Head;   // Game info, locations and maps
+        WorldSaveBlobMap    Npcs;
+        WorldSaveBlobMap    Items;
+        WorldSaveVarBlobMap Vars;
+        UCharVec            Tail;   // Holodisks, any data, time events, script functions, version
+    };
+
+    static uint SaveWorldRecordsCrc, SaveWorldVerifyStep;
+    static uint SaveWorldJournalMax, SaveWorldJournalCount, SaveWorldChangedCount, SaveWorldMissedCount;
+    static bool SaveWorldJournalReady, SaveWorldDelta;
+
+    static void SaveWorldRecords( bool delta );
+    static void AddWorldSaveCrc( void* data, size_t size );
+    static void AddWorldSaveDataCrc( void* data, size_t size );
+    static bool ReadWorldSaveData( UCharVec& data, uint& pos, uint size, void* out = NULL );
+    static bool ReadWorldSaveHead( UCharVec& data, uint& pos, UCharVec& head );
+    static bool ReadWorldSaveRecords( UCharVec& data, uint& pos, uint end, WorldSaveImage& image, bool delta );
+    static bool ReadWorldSaveImage( const char* fname, WorldSaveImage& image );
+    static bool ApplyWorldSaveJournal( const char* fname, WorldSaveImage& image, uint& entries );
+    static bool WriteWorldSaveImage( const char* fname, WorldSaveImage& image );
+    static bool CompactWorldSave( uint base_index, uint out_index );
+
     static bool SaveClient( Client* cl, bool deferred );
     static bool LoadClient( Client* cl );
     static bool NewWorld();
@@ -415,6 +518,8 @@ public:
         uint SaveIndex;
         uint UID[5];
         uint UIDEndTick;
+        uint DbOffset;  // Last record in clients database
+        uint DbSize;
         ClientData();
         bool operator==( const char* name );
         bool operator==( const uint id );
@@ -422,20 +527,47 @@ public:
     };
     typedef vector<ClientData> ClientDataVec;
     static ClientDataVec ClientsData;
+    static StrUIntMap    ClientsDataByName; // Lower case name -> ClientsData index
+    static UIntMap       ClientsDataById;
     static Mutex         ClientsDataLocker;
     static volatile uint LastClientId;
 
     static bool        LoadClientsData();
-    static ClientData* GetClientData( const char* name )
+    static bool        LoadClientsFiles();
+    static ClientData* AddClientData( const ClientData& data );
+    static void        EraseClientData( ClientData* data );
+    static ClientData* GetClientData( const char* name );
+    static ClientData* GetClientData( uint id );
+
+    // Clients database
+    // Append only file with client records, newest record of client is actual,
+    // ClientsData keeps record offsets, file compacted on load and while running if has too many obsolete records
+    // Offsets are passed to file functions as int, so file size is limited by MAX_INT
+    #define CLIENTS_DB_FNAME               "clients.db"
+    #define CLIENTS_DB_RECORD_MAGIC        (0x52434F46) // FOCR
+    #define CLIENTS_DB_RECORD_DELETED      (0x01)
+    #define CLIENTS_DB_COMPACT_MIN_SIZE    (0x4000000)  // 64 Mb, smaller files are compacted only on load
+    struct ClientsDbRecord
     {
-        auto it = std::find( ClientsData.begin(), ClientsData.end(), name );
-        return it != ClientsData.end() ? &(*it) : NULL;
-    }
-    static ClientData* GetClientData( uint id )
-    {
-        auto it = std::find( ClientsData.begin(), ClientsData.end(), id );
-        return it != ClientsData.end() ? &(*it) : NULL;
-    }
+        uint Magic;
+        uint Size;  // Payload size
+        uint Crc;   // Record crc, calculated with zero Crc
+        uint Flags;
+        uint Id;
+        char Name[UTF8_BUF_SIZE( MAX_NAME )];
+        char PassHash[PASS_HASH_SIZE];
+        // Payload: CritData, CritDataExt, time events count, time events
+    };
+    static Mutex ClientsDbLocker;
+    static void* ClientsDbFile;
+    static uint  ClientsDbSize, ClientsDbGarbage;
+
+    static bool OpenClientsDb();
+    static bool CompactClientsDb();
+    static bool CompactClientsDbOnline();
+    static void CloseClientsDb();
+    static bool AppendClientsDbRecord( const char* name, const char* pass_hash, CritData* data, CritDataExt* data_ext, Critter::CrTimeEventVec* time_events );
+    static bool ImportClientFile( ClientData& cd );
 
     // Statistics
     struct Statistics_
@@ -457,6 +589,22 @@ public:
         uint  LoopMin;
         uint  LoopMax;
         uint  LagsCount;
+
+        uint  JobsLocal;
+        uint  JobsGlobal;
+        uint  JobsStolen;
+        uint  JobsStealFails;
+        uint  SyncContentions[SYNC_OBJECT_TYPES_COUNT];
+
+        struct NetIOLoop_
+        {
+            int64 BytesSend;
+            int64 BytesRecv;
+            uint  Accepted;
+            uint  Callbacks;
+            int64 CallbacksTime;   // Microseconds
+            uint  CallbacksMax;    // Microseconds
+        } NetIOLoops[NETIO_MAX_LOOPS];
     } static Statistics;
 
     static uint   PlayersInGame() { return CrMngr.PlayersInGame(); }
@@ -422,9 +422,11 @@ bool FOServer::Act_Move( Critter* cr, ushort hx, ushort hy, uint move_params )
     cr->Data.HexX = hx;
     cr->Data.HexY = hy;
     map->SetFlagCritter( hx, hy, multihex, is_dead );
+    map->SetCritterGrid( cr, cr->GridVisRadius );
 
     // Set dir
     cr->Data.Dir = dir;
+    cr->IsSaveChanged = true;
 
     if( is_run )
     {
@@ -1319,6 +1321,7 @@ void FOServer::KnockoutCritter( Critter* cr, uint anim2begin, uint anim2idle, ui
         cr->Data.HexX = x2;
         cr->Data.HexY = y2;
         map->SetFlagCritter( x2, y2, multihex, is_dead );
+        map->SetCritterGrid( cr, cr->GridVisRadius );
     }
 
     cr->ToKnockout( anim2begin, anim2idle, anim2end, lost_ap, knock_hx, knock_hy );
@@ -1573,18 +1576,9 @@ void FOServer::Process_UserRegister( Client* cl )
     // Check for exist
     if( !Singleplayer )
     {
-        SaveClientsLocker.Lock();
+        ClientsDataLocker.Lock();
         bool exist = (GetClientData( cl->Name ) != NULL);
-        SaveClientsLocker.Unlock();
-
-        if( !exist )
-        {
-            // Avoid created files rewriting
-            char fname[MAX_FOPATH];
-            FileManager::GetFullPath( cl->Name, PATH_SERVER_CLIENTS, fname );
-            Str::Append( fname, ".client" );
-            exist = FileExist( fname );
-        }
+        ClientsDataLocker.Unlock();
 
         if( exist )
         {
@@ -1701,21 +1695,6 @@ void FOServer::Process_UserRegister( Client* cl )
         FileClose( last_id_file );
     }
 
-    // Add name in clients names cache file
-    char  cache_fname[MAX_FOPATH];
-    FileManager::GetFullPath( "clients_list.txt", PATH_SERVER_CLIENTS, cache_fname );
-    void* cache_file = FileOpenForAppend( cache_fname );
-    if( cache_file )
-    {
-        FileWrite( cache_file, cl->Name, Str::Length( cl->Name ) );
-        FileWrite( cache_file, ".client\n", 8 );
-        FileClose( cache_file );
-    }
-    else
-    {
-        FileClose( FileOpen( "cache_fail", true ) );
-    }
-
     // Load world
     if( Singleplayer )
     {
@@ -1756,7 +1735,6 @@ void FOServer::Process_UserRegister( Client* cl )
         Script::SetArgBool( true );
         Script::RunPrepared();
     }
-    SaveClient( cl, false );
 
     if( !Singleplayer )
     {
@@ -1766,8 +1744,10 @@ void FOServer::Process_UserRegister( Client* cl )
         memcpy( data.ClientPassHash, cl->PassHash, PASS_HASH_SIZE );
         data.ClientId = cl->GetId();
 
-        SCOPE_LOCK( ClientsDataLocker );
-        ClientsData.push_back( data );
+        ClientsDataLocker.Lock();
+        AddClientData( data );
+        ClientsDataLocker.Unlock();
+        SaveClient( cl, false );
     }
     else
     {
@@ -2638,19 +2618,29 @@ void FOServer::Process_ParseToGame( Client* cl )
 
 void FOServer::Process_GiveMap( Client* cl )
 {
-    bool   automap;
-    ushort map_pid;
-    uint   loc_id;
-    uint   hash_tiles;
-    uint   hash_walls;
-    uint   hash_scen;
+    uint    msg_len;
+    bool    automap;
+    ushort  map_pid;
+    uint    loc_id;
+    ushort  regions_count;
+    UIntVec region_hashes;
 
+    cl->Bin >> msg_len;
     cl->Bin >> automap;
     cl->Bin >> map_pid;
     cl->Bin >> loc_id;
-    cl->Bin >> hash_tiles;
-    cl->Bin >> hash_walls;
-    cl->Bin >> hash_scen;
+    cl->Bin >> regions_count;
+    if( msg_len != sizeof(uint) + sizeof(msg_len) + sizeof(automap) + sizeof(map_pid) + sizeof(loc_id) + sizeof(regions_count) + regions_count * sizeof(uint) )
+    {
+        WriteLogF( _FUNC_, " - Invalid message length, client<%s>.\n", cl->GetInfo() );
+        cl->Disconnect();
+        return;
+    }
+    if( regions_count )
+    {
+        region_hashes.resize( regions_count );
+        cl->Bin.Pop( (char*)&region_hashes[0], regions_count * sizeof(uint) );
+    }
     CHECK_IN_BUFF_ERROR( cl );
 
     if( !Singleplayer )
@@ -2693,15 +2683,7 @@ void FOServer::Process_GiveMap( Client* cl )
         }
     }
 
-    uchar send_info = 0;
-    if( pmap->HashTiles != hash_tiles )
-        SETFLAG( send_info, SENDMAP_TILES );
-    if( pmap->HashWalls != hash_walls )
-        SETFLAG( send_info, SENDMAP_WALLS );
-    if( pmap->HashScen != hash_scen )
-        SETFLAG( send_info, SENDMAP_SCENERY );
-
-    Send_MapData( cl, pmap, send_info );
+    Send_MapData( cl, pmap, region_hashes );
 
     if( !automap )
     {
@@ -2730,20 +2712,30 @@ void FOServer::Send_Raw( Client* cl, uint data, bool fast /* = true */ )
     }
 }
 
-void FOServer::Send_MapData( Client* cl, ProtoMap* pmap, uchar send_info )
+void FOServer::Send_MapData( Client* cl, ProtoMap* pmap, const UIntVec& region_hashes )
 {
     uint   msg = NETMSG_MAP;
     ushort map_pid = pmap->GetPid();
     ushort maxhx = pmap->Header.MaxHexX;
     ushort maxhy = pmap->Header.MaxHexY;
-    uint   msg_len = sizeof(msg) + sizeof(msg_len) + sizeof(map_pid) + sizeof(maxhx) + sizeof(maxhy) + sizeof(send_info);
+    ushort regions_count = (ushort)pmap->GetRegionsCount();
+    uint   msg_len = sizeof(msg) + sizeof(msg_len) + sizeof(map_pid) + sizeof(maxhx) + sizeof(maxhy) +
+                     sizeof(pmap->HashRegions) + sizeof(regions_count) + sizeof(ushort);
 
-    if( FLAG( send_info, SENDMAP_TILES ) )
-        msg_len += sizeof(uint) + (uint)pmap->Tiles.size() * sizeof(ProtoMap::Tile);
-    if( FLAG( send_info, SENDMAP_WALLS ) )
-        msg_len += sizeof(uint) + (uint)pmap->WallsToSend.size() * sizeof(SceneryCl);
-    if( FLAG( send_info, SENDMAP_SCENERY ) )
-        msg_len += sizeof(uint) + (uint)pmap->SceneriesToSend.size() * sizeof(SceneryCl);
+    // Collect regions which client does not have, all if client knows nothing about this map layout
+    bool      send_all = (region_hashes.size() != regions_count);
+    UShortVec regions;
+    for( ushort r = 0; r < regions_count; r++ )
+    {
+        if( !send_all && region_hashes[r] == pmap->RegionHashes[r] )
+            continue;
+
+        regions.push_back( r );
+        msg_len += sizeof(ushort) + sizeof(uint) * 4;
+        msg_len += (pmap->RegionTiles[r + 1] - pmap->RegionTiles[r]) * sizeof(ProtoMap::Tile);
+        msg_len += (pmap->RegionWalls[r + 1] - pmap->RegionWalls[r]) * sizeof(SceneryCl);
+        msg_len += (pmap->RegionScen[r + 1] - pmap->RegionScen[r]) * sizeof(SceneryCl);
+    }
 
     // Header
     BOUT_BEGIN( cl );
@@ -2752,30 +2744,29 @@ void FOServer::Send_MapData( Client* cl, ProtoMap* pmap, uchar send_info )
     cl->Bout << map_pid;
     cl->Bout << maxhx;
     cl->Bout << maxhy;
-    cl->Bout << send_info;
-
-    // Tiles
-    if( FLAG( send_info, SENDMAP_TILES ) )
-    {
-        cl->Bout << (uint)pmap->Tiles.size();
-        if( pmap->Tiles.size() )
-            cl->Bout.Push( (char*)&pmap->Tiles[0], (uint)pmap->Tiles.size() * sizeof(ProtoMap::Tile) );
-    }
-
-    // Walls
-    if( FLAG( send_info, SENDMAP_WALLS ) )
-    {
-        cl->Bout << (uint)pmap->WallsToSend.size();
-        if( pmap->WallsToSend.size() )
-            cl->Bout.Push( (char*)&pmap->WallsToSend[0], (uint)pmap->WallsToSend.size() * sizeof(SceneryCl) );
-    }
-
-    // Scenery
-    if( FLAG( send_info, SENDMAP_SCENERY ) )
-    {
-        cl->Bout << (uint)pmap->SceneriesToSend.size();
-        if( pmap->SceneriesToSend.size() )
-            cl->Bout.Push( (char*)&pmap->SceneriesToSend[0], (uint)pmap->SceneriesToSend.size() * sizeof(SceneryCl) );
+    cl->Bout << pmap->HashRegions;
+    cl->Bout << regions_count;
+    cl->Bout << (ushort)regions.size();
+
+    // Regions
+    for( uint i = 0; i < regions.size(); i++ )
+    {
+        ushort r = regions[i];
+        uint   tiles_count = pmap->RegionTiles[r + 1] - pmap->RegionTiles[r];
+        uint   walls_count = pmap->RegionWalls[r + 1] - pmap->RegionWalls[r];
+        uint   scen_count = pmap->RegionScen[r + 1] - pmap->RegionScen[r];
+
+        cl->Bout << r;
+        cl->Bout << pmap->RegionHashes[r];
+        cl->Bout << tiles_count;
+        if( tiles_count )
+            cl->Bout.Push( (char*)&pmap->Tiles[pmap->RegionTiles[r]], tiles_count * sizeof(ProtoMap::Tile) );
+        cl->Bout << walls_count;
+        if( walls_count )
+            cl->Bout.Push( (char*)&pmap->WallsToSend[pmap->RegionWalls[r]], walls_count * sizeof(SceneryCl) );
+        cl->Bout << scen_count;
+        if( scen_count )
+            cl->Bout.Push( (char*)&pmap->SceneriesToSend[pmap->RegionScen[r]], scen_count * sizeof(SceneryCl) );
     }
     BOUT_END( cl );
 }
@@ -12,6 +12,7 @@
 #include "FileSystem.h"
 #include "Ini.h"
 #include "ItemManager.h"
+#include "Jobs.h"
 #include "Log.h"
 #include "Map.h"
 #include "MapManager.h"
@@ -743,6 +744,7 @@ bool FOServer::SScriptFunc::Item_SetScript( Item* item, ScriptString* script )
     if( !script || !script->length() )
     {
         item->Data.ScriptId = 0;
+        item->IsSaveChanged = true;
     }
     else
     {
@@ -887,7 +889,7 @@ bool FOServer::SScriptFunc::Item_ChangeProto( Item* item, ushort pid )
         SCRIPT_ERROR_R0( "Different types." );
 
     ProtoItem* old_proto_item = item->Proto;
-    item->Proto = proto_item;
+    ItemMngr.ChangeItemProto( item, proto_item );
 
     if( item->Accessory == ITEM_ACCESSORY_CRITTER )
     {
@@ -1197,6 +1199,7 @@ void FOServer::SScriptFunc::Item_set_Flags( Item* item, uint value )
 
     uint old = item->Data.Flags;
     item->Data.Flags = value;
+    item->IsSaveChanged = true;
     Map* map = NULL;
 
     // Recalculate view for this item
@@ -1285,6 +1288,7 @@ void FOServer::SScriptFunc::Item_set_TrapValue( Item* item, short value )
     if( item->IsNotValid )
         return;
     item->Data.TrapValue = value;
+    item->IsSaveChanged = true;
     if( item->Accessory == ITEM_ACCESSORY_HEX )
     {
         Map* map = MapMngr.GetMap( item->AccHex.MapId );
@@ -1595,6 +1599,9 @@ bool FOServer::SScriptFunc::Crit_ChangeCrType( Critter* cr, uint new_type )
         }
 
         cr->Data.BaseType = new_type;
+        Map* cr_map = (cr->GetMap() ? MapMngr.GetMap( cr->GetMap() ) : NULL);
+        if( cr_map )
+            cr_map->SetCritterGrid( cr, cr->GridVisRadius );
         cr->Send_ParamOther( OTHER_BASE_TYPE, new_type );
         cr->SendA_ParamOther( OTHER_BASE_TYPE, new_type );
     }
@@ -2892,6 +2899,7 @@ bool FOServer::SScriptFunc::Crit_SetScript( Critter* cr, ScriptString* script )
     if( !script || !script->length() )
     {
         cr->Data.ScriptId = 0;
+        cr->IsSaveChanged = true;
     }
     else
     {
@@ -2944,6 +2952,12 @@ void FOServer::SScriptFunc::Crit_SetMultihex( Critter* cr, int value )
             map->SetFlagCritter( cr->GetHexX(), cr->GetHexY(), new_mh, false );
         }
     }
+    if( old_mh != new_mh && cr->GetMap() )
+    {
+        Map* map = MapMngr.GetMap( cr->GetMap() );
+        if( map )
+            map->SetCritterGrid( cr, cr->GridVisRadius );
+    }
 
     cr->Send_ParamOther( OTHER_MULTIHEX, value );
     cr->SendA_ParamOther( OTHER_MULTIHEX, value );
@@ -3821,6 +3835,7 @@ bool FOServer::SScriptFunc::Map_SetEvent( Map* map, int event_type, ScriptString
                 map->NeedProcess = true;
             }
         }
+        Job::Wake( map );
     }
 
     if( func_name && func_name->length() && map->FuncId[event_type] <= 0 )
@@ -5740,7 +5755,10 @@ void FOServer::SScriptFunc::Global_SetSendParameterFunc( int index, bool enabled
 uint FOServer::SScriptFunc::Global_GetAllItems( ushort pid, ScriptArray* items )
 {
     ItemPtrVec game_items;
-    ItemMngr.GetGameItems( game_items );
+    if( pid )
+        ItemMngr.GetGameItems( pid, game_items );
+    else
+        ItemMngr.GetGameItems( game_items );
     ItemPtrVec game_items_;
     game_items_.reserve( game_items.size() );
     for( auto it = game_items.begin(), end = game_items.end(); it != end; ++it )
@@ -5807,7 +5825,10 @@ uint FOServer::SScriptFunc::Global_GetAllNpc( ushort pid, ScriptArray* npc )
 {
     PcVec npcs;
     CrVec npcs_;
-    CrMngr.GetCopyNpcs( npcs, true );
+    if( pid )
+        CrMngr.GetCopyNpcs( pid, npcs, true );
+    else
+        CrMngr.GetCopyNpcs( npcs, true );
     npcs_.reserve( npcs.size() );
     for( auto it = npcs.begin(), end = npcs.end(); it != end; ++it )
     {
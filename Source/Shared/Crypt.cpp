@@ -385,12 +385,12 @@ bool CryptManager::SetCacheTable( const char* cache_fname )
     return true;
 }
 
-void CryptManager::SetCache( const char* data_name, const uchar* data, uint data_len )
+bool CryptManager::SetCache( const char* data_name, const uchar* data, uint data_len )
 {
     // Load table
     FILE* f = fopen( CacheTableName.c_str(), "r+b" );
     if( !f )
-        return;
+        return false;
 
     // Fix path
     char data_name_[MAX_FOPATH];
@@ -460,7 +460,7 @@ void CryptManager::SetCache( const char* data_name, const uchar* data, uint data
         if( offset < 0 )
         {
             fclose( f );
-            return;
+            return false;
         }
 
         uint max_len = data_len * 2;
@@ -487,7 +487,7 @@ void CryptManager::SetCache( const char* data_name, const uchar* data, uint data
     }
 
     fclose( f );
-    return;
+    return false;
 label_PlaceFound:
 
     CacheDescriptor desc__ = desc_;
@@ -495,8 +495,9 @@ label_PlaceFound:
     fseek( f, desc_place * sizeof(CacheDescriptor), SEEK_SET );
     fwrite( (void*)&desc__, sizeof(uchar), sizeof(CacheDescriptor), f );
     fseek( f, sizeof(CacheTable) + desc_.DataOffset, SEEK_SET );
-    fwrite( data, sizeof(uchar), data_len, f );
+    bool result = (fwrite( data, sizeof(uchar), data_len, f ) == data_len);
     fclose( f );
+    return result;
 }
 
 uchar* CryptManager::GetCache( const char* data_name, uint& data_len )
@@ -49,7 +49,7 @@ public:
     bool   IsCacheTable( const char* cache_fname );
     bool   CreateCacheTable( const char* cache_fname );
     bool   SetCacheTable( const char* cache_fname );
-    void   SetCache( const char* data_name, const uchar* data, uint data_len );
+    bool   SetCache( const char* data_name, const uchar* data, uint data_len );
     uchar* GetCache( const char* data_name, uint& data_len );
 };
 
@@ -11,8 +11,9 @@ bool DataFileDat::Init( const char* fname )
 {
     datHandle = NULL;
     memTree = NULL;
+    datMap = NULL;
+    datMapSize = 0;
     fileName = fname;
-    readBuf.resize( 0x40000 );
 
     datHandle = FileOpen( fname, false );
     if( !datHandle )
@@ -29,11 +30,22 @@ bool DataFileDat::Init( const char* fname )
         return false;
     }
 
+    // Map whole file, entries are read without seeks and intermediate buffers
+    // If address space is not enough, fall back to regular reading
+    datMap = (uchar*)FileMap( datHandle, datMapSize );
+    if( !datMap )
+        readBuf.resize( 0x40000 );
+
     return true;
 }
 
 DataFileDat::~DataFileDat()
 {
+    if( datMap )
+    {
+        FileUnmap( datMap, datMapSize );
+        datMap = NULL;
+    }
     if( datHandle )
     {
         FileClose( datHandle );
@@ -180,6 +192,30 @@ uchar* DataFileDat::OpenFile( const char* fname, uint& len )
     memcpy( &packed_size, ptr + 5, sizeof(packed_size) );
     memcpy( &offset, ptr + 9, sizeof(offset) );
 
+    if( datMap )
+    {
+        uint size = (type ? packed_size : real_size);
+        if( offset > datMapSize || size > datMapSize - offset )
+            return NULL;
+
+        uchar* buf = new uchar[real_size + 1];
+        if( !type )
+        {
+            memcpy( buf, datMap + offset, real_size );
+        }
+        else if( !Inflate( datMap + offset, packed_size, buf, real_size ) )
+        {
+            delete[] buf;
+            return NULL;
+        }
+
+        len = real_size;
+        buf[len] = 0;
+        return buf;
+    }
+
+    SCOPE_LOCK( readLocker );
+
     if( !FileSetPointer( datHandle, offset, SEEK_SET ) )
         return NULL;
 
@@ -243,6 +279,25 @@ uchar* DataFileDat::OpenFile( const char* fname, uint& len )
     return buf;
 }
 
+bool DataFileDat::Inflate( const uchar* packed, uint packed_size, uchar* buf, uint real_size )
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = (Bytef*)packed;
+    stream.avail_in = packed_size;
+    if( inflateInit( &stream ) != Z_OK )
+        return false;
+
+    stream.next_out = buf;
+    stream.avail_out = real_size;
+
+    int r = inflate( &stream, Z_FINISH );
+    inflateEnd( &stream );
+    return r == Z_STREAM_END || ( (r == Z_OK || r == Z_BUF_ERROR) && !stream.avail_out );
+}
+
 void DataFileDat::GetFileNames( const char* path, bool include_subdirs, const char* ext, StrVec& result )
 {
     size_t path_len = Str::Length( path );
@@ -2,6 +2,7 @@
 #define __DATA_FILE__DAT__
 
 #include "DataFile.h"
+#include "Mutex.h"
 #include "Types.h"
 
 class DataFileDat : public DataFile
@@ -13,11 +14,15 @@ private:
     string   fileName;
     uchar*   memTree;
     void*    datHandle;
+    uchar*   datMap;
+    uint     datMapSize;
     UCharVec readBuf;
+    Mutex    readLocker; // Unmapped archive shares file pointer and read buffer
 
     uint64   timeCreate, timeAccess, timeWrite;
 
     bool ReadTree();
+    bool Inflate( const uchar* packed, uint packed_size, uchar* buf, uint real_size );
 
 public:
     bool Init( const char* fname );
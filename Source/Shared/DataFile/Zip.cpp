@@ -112,6 +112,8 @@ uchar* DataFileZip::OpenFile( const char* fname, uint& len )
 
     ZipFileInfo& info = (*it).second;
 
+    SCOPE_LOCK( zipLocker );
+
     if( unzGoToFilePos( zipHandle, &info.Pos ) != UNZ_OK )
         return NULL;
 
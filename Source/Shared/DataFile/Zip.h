@@ -4,6 +4,7 @@
 #include <unzip.h>
 
 #include "DataFile.h"
+#include "Mutex.h"
 #include "Types.h"
 
 class DataFileZip : public DataFile
@@ -19,6 +20,7 @@ private:
     IndexMap filesTree;
     string   fileName;
     unzFile  zipHandle;
+    Mutex    zipLocker; // Current file position of handle is shared
 
     uint64   timeCreate, timeAccess, timeWrite;
 
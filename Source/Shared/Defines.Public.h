@@ -454,6 +454,7 @@
 #define COMMAND_CHECKVAR                                  (34)
 #define COMMAND_SETVAR                                    (35)
 #define COMMAND_SETTIME                                   (36)
+#define COMMAND_PROFILER                                  (37)
 
 // Combat modes
 #define COMBAT_MODE_ANY                                   (0)
@@ -30,7 +30,8 @@
 
 // World dump versions
 #define WORLD_SAVE_V1                         (1)                                                    // unreleased
-#define WORLD_SAVE_LAST                       (WORLD_SAVE_V1)
+#define WORLD_SAVE_V2                         (2)                                                    // unreleased, compressed sections, npc params relative to proto
+#define WORLD_SAVE_LAST                       (WORLD_SAVE_V2)
 #define SINGLEPLAYER_SAVE_V1                  (1)                                                    // unreleased
 #define SINGLEPLAYER_SAVE_LAST                (SINGLEPLAYER_SAVE_V1)
 
@@ -69,11 +70,6 @@
 // Proto maps
 #define MAP_PROTO_EXT                         ".fomap"
 
-// Sendmap info
-#define SENDMAP_TILES                         BIN8( 00000001 )
-#define SENDMAP_WALLS                         BIN8( 00000010 )
-#define SENDMAP_SCENERY                       BIN8( 00000100 )
-
 // Ping
 #define PING_PING                             (0)
 #define PING_WAIT                             (1)
@@ -137,7 +133,8 @@
 
 // Client map
 #define SERVER_MAP_EXT                        ".map"
-#define CLIENT_MAP_FORMAT_VER                 (7)
+#define CLIENT_MAP_FORMAT_VER                 (9)
+#define MAP_REGION_HEXES                      (50) // Side of map square transferred and cached independently
 
 // Coordinates
 #define MAXHEX_DEF                            (200)
@@ -4,8 +4,56 @@
 #include "Text.h"
 
 #ifdef FO_WINDOWS
-
 # include <io.h>
+#endif
+
+struct FileDesc
+{
+    #ifdef FO_WINDOWS
+    HANDLE       h;
+    #else
+    FILE*        f;
+    bool         writeThrough;
+    #endif
+    // Memory file, used when no handle
+    const uchar* memData;
+    uint         memSize;
+    uint         memPos;
+};
+
+void* FileOpenMemory( const void* data, uint size )
+{
+    FileDesc* fd = new FileDesc();
+    fd->memData = (const uchar*)data;
+    fd->memSize = size;
+    return (void*)fd;
+}
+
+static bool MemoryRead( FileDesc* fd, void* buf, uint len, uint* rb )
+{
+    uint rb_ = MIN( len, fd->memSize - fd->memPos );
+    if( rb_ )
+        memcpy( buf, fd->memData + fd->memPos, rb_ );
+    fd->memPos += rb_;
+    if( rb )
+        *rb = rb_;
+    return rb_ == len;
+}
+
+static bool MemorySetPointer( FileDesc* fd, int offset, int origin )
+{
+    int64 pos = offset;
+    if( origin == SEEK_CUR )
+        pos += fd->memPos;
+    else if( origin == SEEK_END )
+        pos += fd->memSize;
+    if( pos < 0 || pos > (int64)fd->memSize )
+        return false;
+    fd->memPos = (uint)pos;
+    return true;
+}
+
+#ifdef FO_WINDOWS
 
 wchar_t* MBtoWC( const char* mb )
 {
@@ -32,7 +80,9 @@ void* FileOpen( const char* fname, bool write, bool write_through /* = false */
         file = CreateFileW( MBtoWC( fname ), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
     if( file == INVALID_HANDLE_VALUE )
         return NULL;
-    return file;
+    FileDesc* fd = new FileDesc();
+    fd->h = file;
+    return (void*)fd;
 }
 
 void* FileOpenForAppend( const char* fname, bool write_through /* = false */ )
@@ -40,24 +90,32 @@ void* FileOpenForAppend( const char* fname, bool write_through /* = false */ )
     HANDLE file = CreateFileW( MBtoWC( fname ), GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_EXISTING, write_through ? FILE_FLAG_WRITE_THROUGH : 0, NULL );
     if( file == INVALID_HANDLE_VALUE )
         return NULL;
-    if( !FileSetPointer( file, 0, SEEK_END ) )
+    FileDesc* fd = new FileDesc();
+    fd->h = file;
+    if( !FileSetPointer( fd, 0, SEEK_END ) )
     {
-        FileClose( file );
+        FileClose( fd );
         return NULL;
     }
-    return file;
+    return (void*)fd;
 }
 
 void FileClose( void* file )
 {
     if( file )
-        CloseHandle( (HANDLE)file );
+    {
+        if( ( (FileDesc*)file )->h )
+            CloseHandle( ( (FileDesc*)file )->h );
+        delete (FileDesc*)file;
+    }
 }
 
 bool FileRead( void* file, void* buf, uint len, uint* rb /* = NULL */ )
 {
+    if( !( (FileDesc*)file )->h )
+        return MemoryRead( (FileDesc*)file, buf, len, rb );
     DWORD dw = 0;
-    BOOL  result = ReadFile( (HANDLE)file, buf, len, &dw, NULL );
+    BOOL  result = ReadFile( ( (FileDesc*)file )->h, buf, len, &dw, NULL );
     if( rb )
         *rb = dw;
     return result && dw == len;
@@ -65,13 +123,17 @@ bool FileRead( void* file, void* buf, uint len, uint* rb /* = NULL */ )
 
 bool FileWrite( void* file, const void* buf, uint len )
 {
+    if( !( (FileDesc*)file )->h )
+        return false;
     DWORD dw = 0;
-    return WriteFile( (HANDLE)file, buf, len, &dw, NULL ) && dw == len;
+    return WriteFile( ( (FileDesc*)file )->h, buf, len, &dw, NULL ) && dw == len;
 }
 
 bool FileSetPointer( void* file, int offset, int origin )
 {
-    return SetFilePointer( (HANDLE)file, offset, NULL, origin ) != INVALID_SET_FILE_POINTER;
+    if( !( (FileDesc*)file )->h )
+        return MemorySetPointer( (FileDesc*)file, offset, origin );
+    return SetFilePointer( ( (FileDesc*)file )->h, offset, NULL, origin ) != INVALID_SET_FILE_POINTER;
 }
 
 void FileGetTime( void* file, uint64& tc, uint64& ta, uint64& tw )
@@ -81,7 +143,12 @@ void FileGetTime( void* file, uint64& tc, uint64& ta, uint64& tw )
         FILETIME       ft;
         ULARGE_INTEGER ul;
     } tc_, ta_, tw_;
-    GetFileTime( (HANDLE)file, &tc_.ft, &ta_.ft, &tw_.ft );
+    if( !( (FileDesc*)file )->h )
+    {
+        tc = ta = tw = 0;
+        return;
+    }
+    GetFileTime( ( (FileDesc*)file )->h, &tc_.ft, &ta_.ft, &tw_.ft );
     tc = PACKUINT64( tc_.ul.HighPart, tc_.ul.LowPart );
     ta = PACKUINT64( ta_.ul.HighPart, ta_.ul.LowPart );
     tw = PACKUINT64( tw_.ul.HighPart, tw_.ul.LowPart );
@@ -89,8 +156,32 @@ void FileGetTime( void* file, uint64& tc, uint64& ta, uint64& tw )
 
 uint FileGetSize( void* file )
 {
+    if( !( (FileDesc*)file )->h )
+        return ( (FileDesc*)file )->memSize;
     DWORD high;
-    return GetFileSize( (HANDLE)file, &high );
+    return GetFileSize( ( (FileDesc*)file )->h, &high );
+}
+
+void* FileMap( void* file, uint& size )
+{
+    size = FileGetSize( file );
+    if( !size || !( (FileDesc*)file )->h )
+        return NULL;
+
+    HANDLE mapping = CreateFileMappingW( ( (FileDesc*)file )->h, NULL, PAGE_READONLY, 0, 0, NULL );
+    if( !mapping )
+        return NULL;
+
+    // View holds mapping by itself
+    void* view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+    CloseHandle( mapping );
+    return view;
+}
+
+void FileUnmap( void* view, uint size )
+{
+    if( view )
+        UnmapViewOfFile( view );
 }
 
 bool FileDelete( const char* fname )
@@ -180,16 +271,11 @@ bool ResolvePath( char* path )
 
 #else
 
+# include <sys/mman.h>
 # include <sys/stat.h>
 # include <dirent.h>
 # include <unistd.h>
 
-struct FileDesc
-{
-    FILE* f;
-    bool  writeThrough;
-};
-
 void* FileOpen( const char* fname, bool write, bool write_through /* = false */ )
 {
     FILE* f = fopen( fname, write ? "wb" : "rb" );
@@ -218,13 +304,16 @@ void FileClose( void* file )
 {
     if( file )
     {
-        fclose( ( (FileDesc*)file )->f );
+        if( ( (FileDesc*)file )->f )
+            fclose( ( (FileDesc*)file )->f );
         delete (FileDesc*)file;
     }
 }
 
 bool FileRead( void* file, void* buf, uint len, uint* rb /* = NULL */ )
 {
+    if( !( (FileDesc*)file )->f )
+        return MemoryRead( (FileDesc*)file, buf, len, rb );
     uint rb_ = fread( buf, sizeof(char), len, ( (FileDesc*)file )->f );
     if( rb )
         *rb = rb_;
@@ -233,6 +322,8 @@ bool FileRead( void* file, void* buf, uint len, uint* rb /* = NULL */ )
 
 bool FileWrite( void* file, const void* buf, uint len )
 {
+    if( !( (FileDesc*)file )->f )
+        return false;
     bool result = (fwrite( buf, sizeof(char), len, ( (FileDesc*)file )->f ) == len);
     if( result && ( (FileDesc*)file )->writeThrough )
         fflush( ( (FileDesc*)file )->f );
@@ -241,11 +332,18 @@ bool FileWrite( void* file, const void* buf, uint len )
 
 bool FileSetPointer( void* file, int offset, int origin )
 {
+    if( !( (FileDesc*)file )->f )
+        return MemorySetPointer( (FileDesc*)file, offset, origin );
     return fseek( ( (FileDesc*)file )->f, offset, origin ) == 0;
 }
 
 void FileGetTime( void* file, uint64& tc, uint64& ta, uint64& tw )
 {
+    if( !( (FileDesc*)file )->f )
+    {
+        tc = ta = tw = 0;
+        return;
+    }
     int         fd = fileno( ( (FileDesc*)file )->f );
     struct stat st;
     fstat( fd, &st );
@@ -256,12 +354,32 @@ void FileGetTime( void* file, uint64& tc, uint64& ta, uint64& tw )
 
 uint FileGetSize( void* file )
 {
+    if( !( (FileDesc*)file )->f )
+        return ( (FileDesc*)file )->memSize;
     int         fd = fileno( ( (FileDesc*)file )->f );
     struct stat st;
     fstat( fd, &st );
     return (uint)st.st_size;
 }
 
+void* FileMap( void* file, uint& size )
+{
+    size = FileGetSize( file );
+    if( !size || !( (FileDesc*)file )->f )
+        return NULL;
+
+    void* view = mmap( NULL, size, PROT_READ, MAP_SHARED, fileno( ( (FileDesc*)file )->f ), 0 );
+    if( view == MAP_FAILED )
+        return NULL;
+    return view;
+}
+
+void FileUnmap( void* view, uint size )
+{
+    if( view )
+        munmap( view, size );
+}
+
 bool FileDelete( const char* fname )
 {
     return std::remove( fname );
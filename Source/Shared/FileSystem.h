@@ -24,12 +24,15 @@
 
 void* FileOpen( const char* fname, bool write, bool write_through = false );
 void* FileOpenForAppend( const char* fname, bool write_through = false );
+void* FileOpenMemory( const void* data, uint size ); // Read-only, data must outlive file
 void  FileClose( void* file );
 bool  FileRead( void* file, void* buf, uint len, uint* rb = NULL );
 bool  FileWrite( void* file, const void* buf, uint len );
 bool  FileSetPointer( void* file, int offset, int origin );
 void  FileGetTime( void* file, uint64& tc, uint64& ta, uint64& tw );
 uint  FileGetSize( void* file );
+void* FileMap( void* file, uint& size ); // Read-only view of whole file
+void  FileUnmap( void* view, uint size );
 bool  FileDelete( const char* fname );
 bool  FileExist( const char* fname );
 bool  FileRename( const char* fname, const char* new_fname );
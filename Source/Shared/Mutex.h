@@ -14,6 +14,7 @@
 #  define InterlockedExchange                             _InterlockedExchange
 #  define InterlockedIncrement                            _InterlockedIncrement
 #  define InterlockedDecrement                            _InterlockedDecrement
+#  define InterlockedExchangeAdd                          _InterlockedExchangeAdd
 # endif
 
 #else // !FO_WINDOWS
@@ -23,6 +24,7 @@
 # define InterlockedExchange( val, newval )               __sync_lock_test_and_set( val, newval )
 # define InterlockedIncrement( val )                      __sync_add_and_fetch( val, 1 )
 # define InterlockedDecrement( val )                      __sync_sub_and_fetch( val, 1 )
+# define InterlockedExchangeAdd( val, add )               __sync_fetch_and_add( val, add )
 
 #endif // FO_WINDOWS
 
@@ -0,0 +1,161 @@
+/************************************************************************/
+/* Task graph                                                           */
+/************************************************************************/
+
+#include "Core.h"
+
+#include "TaskGraph.h"
+#include "Text.h"
+#include "Thread.h"
+#include "Timer.h"
+
+TaskGraph::TaskGraph() : tasksLeft( 0 )
+{}
+
+uint TaskGraph::AddTask( const char* name, TaskFunc func, void* arg /* = NULL */, bool caller /* = false */ )
+{
+    Task task;
+    task.Name = name;
+    task.Func = func;
+    task.Arg = arg;
+    task.State = TaskWait;
+    task.Time = 0.0;
+    task.Caller = caller;
+    tasks.push_back( task );
+    return (uint)tasks.size() - 1;
+}
+
+void TaskGraph::AddDependency( uint task, uint depend )
+{
+    if( task < tasks.size() && depend < tasks.size() && task != depend )
+        tasks[task].Depends.push_back( depend );
+}
+
+void TaskGraph::Clear()
+{
+    tasks.clear();
+    tasksLeft = 0;
+}
+
+bool TaskGraph::RunNext( bool caller )
+{
+    Task* task = NULL;
+
+    tasksLocker.Lock();
+
+    // Caller thread keeps itself free for caller tasks while they are pending
+    bool caller_wait = false;
+    for( uint i = 0; i < tasks.size() && caller && !caller_wait; i++ )
+        caller_wait = (tasks[i].Caller && tasks[i].State == TaskWait);
+
+    for( uint i = 0; i < tasks.size() && !task; i++ )
+    {
+        Task& t = tasks[i];
+        if( t.State != TaskWait )
+            continue;
+
+        bool ready = true;
+        bool skip = false;
+        for( uint j = 0; j < t.Depends.size(); j++ )
+        {
+            int state = tasks[t.Depends[j]].State;
+            if( state == TaskFail || state == TaskSkip )
+                skip = true;
+            else if( state != TaskDone )
+                ready = false;
+        }
+
+        if( skip )
+        {
+            t.State = TaskSkip;
+            tasksLeft--;
+            i = (uint)-1; // Dependents of this task must be rechecked
+        }
+        else if( ready && (caller ? (t.Caller || !caller_wait) : !t.Caller) )
+        {
+            t.State = TaskRun;
+            task = &t;
+        }
+    }
+    bool finished = (tasksLeft == 0);
+    tasksLocker.Unlock();
+
+    if( !task )
+    {
+        if( finished )
+            return false;
+        Thread::Sleep( 1 );
+        return true;
+    }
+
+    double tick = Timer::AccurateTick();
+    bool   result = task->Func( task->Arg );
+    tick = Timer::AccurateTick() - tick;
+
+    tasksLocker.Lock();
+    task->Time = tick;
+    task->State = (result ? TaskDone : TaskFail);
+    tasksLeft--;
+    tasksLocker.Unlock();
+    return true;
+}
+
+void TaskGraph::Worker( void* graph )
+{
+    while( ( (TaskGraph*)graph )->RunNext( false ) )
+        ;
+}
+
+bool TaskGraph::Run( uint threads )
+{
+    tasksLeft = (uint)tasks.size();
+    for( uint i = 0; i < tasks.size(); i++ )
+    {
+        tasks[i].State = TaskWait;
+        tasks[i].Time = 0.0;
+    }
+
+    // Current thread is worker too
+    if( threads > tasks.size() )
+        threads = (uint)tasks.size();
+    vector<Thread*> workers;
+    for( uint i = 1; i < threads; i++ )
+    {
+        Thread* thread = new Thread();
+        if( !thread->Start( Worker, Str::FormatBuf( "TaskGraph%u", i ), this ) )
+        {
+            delete thread;
+            break;
+        }
+        workers.push_back( thread );
+    }
+
+    while( RunNext( true ) )
+        ;
+
+    for( uint i = 0; i < workers.size(); i++ )
+    {
+        workers[i]->Wait();
+        delete workers[i];
+    }
+
+    for( uint i = 0; i < tasks.size(); i++ )
+        if( tasks[i].State != TaskDone )
+            return false;
+    return true;
+}
+
+string TaskGraph::GetTimingReport()
+{
+    static const char* states[] = { "wait", "run", "done", "fail", "skip" };
+
+    string report;
+    double total = 0.0;
+    for( uint i = 0; i < tasks.size(); i++ )
+    {
+        report += Str::FormatBuf( "%-20s %10.2f ms  %s\n", tasks[i].Name.c_str(), tasks[i].Time, states[tasks[i].State] );
+        total += tasks[i].Time;
+    }
+    report += Str::FormatBuf( "%-20s %10.2f ms\n", "Sum", total );
+    return report;
+}
@@ -0,0 +1,58 @@
+#ifndef __TASK_GRAPH__
+#define __TASK_GRAPH__
+
+#include "Mutex.h"
+#include "Types.h"
+
+/************************************************************************/
+/* Task graph                                                           */
+/************************************************************************/
+
+#if !defined (FONLINE_NPCEDITOR) && !defined (FONLINE_MRFIXIT)
+
+// Runs tasks on pool of threads, task starts after all its dependencies succeeded
+// Tasks of failed dependencies are skipped, caller tasks run only on thread called Run
+class TaskGraph
+{
+public:
+    typedef bool (* TaskFunc)( void* );
+
+private:
+    enum TaskState { TaskWait, TaskRun, TaskDone, TaskFail, TaskSkip };
+    struct Task
+    {
+        string   Name;
+        TaskFunc Func;
+        void*    Arg;
+        UIntVec  Depends;
+        int      State;
+        double   Time;
+        bool     Caller;
+    };
+    typedef vector<Task> TaskVec;
+
+    TaskVec tasks;
+    Mutex   tasksLocker;
+    uint    tasksLeft;
+
+    static void Worker( void* graph );
+    bool        RunNext( bool caller );
+
+public:
+    TaskGraph();
+
+    uint AddTask( const char* name, TaskFunc func, void* arg = NULL, bool caller = false );
+    void AddDependency( uint task, uint depend );
+    bool Run( uint threads );
+    void Clear();
+
+    uint        GetTasksCount()          { return (uint)tasks.size(); }
+    const char* GetTaskName( uint task ) { return tasks[task].Name.c_str(); }
+    double      GetTaskTime( uint task ) { return tasks[task].Time; }
+    bool        IsTaskDone( uint task )  { return tasks[task].State == TaskDone; }
+    string      GetTimingReport();
+};
+
+#endif
+
+#endif // __TASK_GRAPH__ //
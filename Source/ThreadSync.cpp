@@ -4,11 +4,20 @@
 #include "ThreadSync.h"
 #include "Mutex.h"
 
-extern bool  LogicMT;    // ConfigFile.h
+extern bool LogicMT;    // ConfigFile.h
 
-static Mutex SyncLocker; // Defense code from simultaneously execution
+#ifdef FO_WINDOWS
+# define SYNC_CAS( ptr, exch, comp )    ( (SyncManager*)InterlockedCompareExchangePointer( (PVOID volatile*)(ptr), (PVOID)(exch), (PVOID)(comp) ) )
+#else
+# define SYNC_CAS( ptr, exch, comp )    __sync_val_compare_and_swap( ptr, comp, exch )
+#endif
 
-SyncObject::SyncObject() : curMngr( NULL )
+static Mutex         SyncLocker;        // Contended locks, steals and waits
+static volatile long SyncWaiters = 0;   // Threads parked in wait state
+
+volatile long        SyncObject::ContentionCount[SYNC_OBJECT_TYPES_COUNT] = { 0 };
+
+SyncObject::SyncObject() : curMngr( NULL ), syncType( SYNC_OBJECT_OTHER )
 {}
 
 void SyncObject::Lock()
@@ -16,89 +25,102 @@ void SyncObject::Lock()
     if( !LogicMT )
         return;
 
-    SyncLocker.Lock();
-
     SyncManager* curm = SyncManager::GetForCurThread();
 
+    // Object already locked by current thread
+    SyncManager* owner = curMngr;
+    if( owner == curm )
+        return;
+
     // Object is free
-    if( !curMngr )
+    // Own locked list changed by other threads only in wait state, so here is safe
+    if( !owner && SYNC_CAS( &curMngr, curm, NULL ) == NULL )
     {
-        curMngr = curm;
-        curMngr->lockedObjects.push_back( this );
+        curm->lockedObjects.push_back( this );
+        return;
     }
-    // Object busy by another thread
-    else if( curm != curMngr )
+
+    LockContended( curm );
+}
+
+// Must be called under SyncLocker
+bool SyncObject::TryTake( SyncManager* curm )
+{
+    SyncManager* owner = curMngr;
+
+    // Object is free
+    if( !owner )
     {
-        // Another thread in wait state
-        if( curMngr->isWaiting && curm->threadPriority >= curMngr->threadPriority )
-        {
-            // Pick from waiting thread
-            auto it = std::find( curMngr->lockedObjects.begin(), curMngr->lockedObjects.end(), this );
-            curMngr->lockedObjects.erase( it );
-            curMngr->busyObjects.push_back( this );
+        if( SYNC_CAS( &curMngr, curm, NULL ) != NULL )
+            return false;
+        curm->lockedObjects.push_back( this );
+        return true;
+    }
 
-            curMngr = curm;
-            curMngr->lockedObjects.push_back( this );
-        }
-        // Another thread work with object
-        else
-        {
-            // Go to wait state
-            curm->isWaiting = true;
-            curm->busyObjects.push_back( this );
+    if( owner == curm )
+        return true;
 
-            SyncLocker.Unlock();
+    // Another thread in wait state, pick from it
+    if( owner->isWaiting && curm->threadPriority >= owner->threadPriority )
+    {
+        if( SYNC_CAS( &curMngr, curm, owner ) != owner )
+            return false;
+
+        auto it = std::find( owner->lockedObjects.begin(), owner->lockedObjects.end(), this );
+        if( it != owner->lockedObjects.end() )
+            owner->lockedObjects.erase( it );
+        owner->busyObjects.push_back( this );
+        curm->lockedObjects.push_back( this );
+        return true;
+    }
 
-            // Wait and try lock all busy objects
-            while( true )
-            {
-                Thread::Sleep( 0 );
-
-                SyncLocker.Lock();
-
-                for( auto it = curm->busyObjects.begin(); it != curm->busyObjects.end();)
-                {
-                    SyncObject* obj = *it;
-                    if( !obj->curMngr )
-                    {
-                        // Object free
-                        obj->curMngr = curm;
-                        curm->lockedObjects.push_back( obj );
-                        it = curm->busyObjects.erase( it );
-                    }
-                    else if( obj->curMngr->isWaiting && curm->threadPriority >= obj->curMngr->threadPriority )
-                    {
-                        // Pick from waiting thread
-                        auto it_ = std::find( obj->curMngr->lockedObjects.begin(), obj->curMngr->lockedObjects.end(), obj );
-                        obj->curMngr->lockedObjects.erase( it_ );
-                        obj->curMngr->busyObjects.push_back( obj );
-
-                        obj->curMngr = curm;
-                        curm->lockedObjects.push_back( obj );
-                        it = curm->busyObjects.erase( it );
-                    }
-                    else
-                    {
-                        // Object busy
-                        ++it;
-                    }
-                }
-
-                if( curm->busyObjects.empty() )
-                {
-                    curm->isWaiting = false;
-
-                    SyncLocker.Unlock();
-                    return;
-                }
-
-                SyncLocker.Unlock();
-            }
-        }
+    // Another thread work with object
+    return false;
+}
+
+void SyncObject::LockContended( SyncManager* curm )
+{
+    InterlockedIncrement( &ContentionCount[syncType] );
+
+    SyncLocker.Lock();
+    if( TryTake( curm ) )
+    {
+        SyncLocker.Unlock();
+        return;
     }
-    // else object already locked by current thread
 
+    // Go to wait state, objects of current thread now can be picked by others
+    curm->isWaiting = true;
+    curm->busyObjects.push_back( this );
+    InterlockedIncrement( &SyncWaiters );
+    SyncManager::WakeWaiters();
     SyncLocker.Unlock();
+
+    // Park until some object released and try lock all busy objects
+    while( true )
+    {
+        SyncLocker.Lock();
+        curm->parkEvent.Disallow();
+
+        for( auto it = curm->busyObjects.begin(); it != curm->busyObjects.end();)
+        {
+            if( (*it)->TryTake( curm ) )
+                it = curm->busyObjects.erase( it );
+            else
+                ++it;
+        }
+
+        if( curm->busyObjects.empty() )
+        {
+            curm->isWaiting = false;
+            InterlockedDecrement( &SyncWaiters );
+            SyncLocker.Unlock();
+            return;
+        }
+
+        SyncLocker.Unlock();
+        curm->parkEvent.Wait();
+    }
 }
 
 void SyncObject::Unlock()
@@ -106,21 +128,20 @@ void SyncObject::Unlock()
     if( !LogicMT )
         return;
 
-    SCOPE_LOCK( SyncLocker );
+    // Only owner can release object
+    SyncManager* curm = SyncManager::GetForCurThread();
+    if( curMngr != curm )
+        return;
 
-    if( curMngr )
-    {
-        auto it = std::find( curMngr->lockedObjects.begin(), curMngr->lockedObjects.end(), this );
-        curMngr->lockedObjects.erase( it );
-        curMngr = NULL;
-    }
+    auto it = std::find( curm->lockedObjects.begin(), curm->lockedObjects.end(), this );
+    if( it != curm->lockedObjects.end() )
+        curm->lockedObjects.erase( it );
+    (void)SYNC_CAS( &curMngr, NULL, curm );
 
-    for( auto it = SyncManager::Managers.begin(), end = SyncManager::Managers.end(); it != end; ++it )
+    if( InterlockedCompareExchange( &SyncWaiters, 0, 0 ) )
     {
-        SyncManager* sync_mngr = *it;
-        auto         it_ = std::find( sync_mngr->busyObjects.begin(), sync_mngr->busyObjects.end(), this );
-        if( it_ != sync_mngr->busyObjects.end() )
-            sync_mngr->busyObjects.erase( it_ );
+        SCOPE_LOCK( SyncLocker );
+        SyncManager::WakeWaiters();
     }
 }
 
@@ -144,8 +165,7 @@ void SyncManager::PushPriority( int priority )
     if( !LogicMT )
         return;
 
-    SCOPE_LOCK( SyncLocker );
-
+    // Priority compared by other threads only while current thread waits, own stack not shared
     int prev_priority = threadPriority;
     priorityStack.push_back( prev_priority );
     threadPriority = priority;
@@ -156,25 +176,27 @@ void SyncManager::PopPriority()
     if( !LogicMT )
         return;
 
-    SCOPE_LOCK( SyncLocker );
-
     threadPriority = priorityStack.back();
     priorityStack.pop_back();
 }
 
 void SyncManager::UnlockAll()
 {
-    if( !LogicMT )
+    if( !LogicMT || lockedObjects.empty() )
         return;
 
-    SCOPE_LOCK( SyncLocker );
-
     for( auto it = lockedObjects.begin(), end = lockedObjects.end(); it != end; ++it )
     {
         SyncObject* obj = *it;
-        obj->curMngr = NULL;
+        (void)SYNC_CAS( &obj->curMngr, NULL, this );
     }
     lockedObjects.clear();
+
+    if( InterlockedCompareExchange( &SyncWaiters, 0, 0 ) )
+    {
+        SCOPE_LOCK( SyncLocker );
+        WakeWaiters();
+    }
 }
 
 void SyncManager::Suspend()
@@ -185,6 +207,8 @@ void SyncManager::Suspend()
     SCOPE_LOCK( SyncLocker );
 
     isWaiting = true;
+    if( InterlockedCompareExchange( &SyncWaiters, 0, 0 ) )
+        WakeWaiters();
 }
 
 void SyncManager::Resume()
@@ -215,6 +239,17 @@ void SyncManager::Resume()
     }
 }
 
+// Must be called under SyncLocker
+void SyncManager::WakeWaiters()
+{
+    for( auto it = Managers.begin(), end = Managers.end(); it != end; ++it )
+    {
+        SyncManager* sync_mngr = *it;
+        if( sync_mngr->isWaiting )
+            sync_mngr->parkEvent.Allow();
+    }
+}
+
 SyncManager* SyncManager::GetForCurThread()
 {
     static THREAD SyncManager* sync_mngr = NULL;
@@ -223,6 +258,7 @@ SyncManager* SyncManager::GetForCurThread()
         sync_mngr = new SyncManager();
         if( !sync_mngr )
             return NULL;
+        SCOPE_LOCK( SyncLocker );
         Managers.push_back( sync_mngr );
     }
     return sync_mngr;
@@ -2,9 +2,19 @@
 #define __THREAD_SYNC__
 
 #include "Types.h"
+#include "Mutex.h"
 
 #define SYNC_LOCK( obj )    (obj)->Sync.Lock()
 
+// Synchronized objects types, for contention statistics
+#define SYNC_OBJECT_OTHER         (0)
+#define SYNC_OBJECT_CRITTER       (1)
+#define SYNC_OBJECT_ITEM          (2)
+#define SYNC_OBJECT_MAP           (3)
+#define SYNC_OBJECT_LOCATION      (4)
+#define SYNC_OBJECT_VAR           (5)
+#define SYNC_OBJECT_TYPES_COUNT   (6)
+
 class SyncObject;
 class SyncManager;
 typedef vector<SyncObject*>  SyncObjectVec;
@@ -14,12 +24,19 @@ class SyncObject
 {
 private:
     friend class SyncManager;
-    SyncManager* curMngr;
+    SyncManager* volatile curMngr;  // Owner word, changed only by atomic operations
+    uchar                 syncType;
+
+    bool TryTake( SyncManager* curm );
+    void LockContended( SyncManager* curm );
 
 public:
     SyncObject();
+    void SetType( uchar type ) { syncType = type; }
     void Lock();
     void Unlock();
+
+    static volatile long ContentionCount[SYNC_OBJECT_TYPES_COUNT];
 };
 
 class SyncManager
@@ -31,6 +48,9 @@ private:
     SyncObjectVec lockedObjects;
     SyncObjectVec busyObjects;
     IntVec        priorityStack;
+    MutexEvent    parkEvent;
+
+    static void WakeWaiters();
 
 public:
     SyncManager();
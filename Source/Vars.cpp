@@ -18,6 +18,95 @@
 VarManager  VarMngr;
 FileLogger* DbgLog = NULL;
 
+/**************************************************************************************************
+***************************************************************************************************
+**************************************************************************************************/
+
+uint VarsHash::GetBucket( uint64 key )
+{
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return (uint)key & ( (uint)entries.size() - 1 );
+}
+
+GameVar* VarsHash::Find( uint64 key )
+{
+    if( !count )
+        return NULL;
+
+    uint mask = (uint)entries.size() - 1;
+    for( uint i = GetBucket( key ); entries[i].Var; i = (i + 1) & mask )
+        if( entries[i].Key == key )
+            return entries[i].Var;
+    return NULL;
+}
+
+void VarsHash::Insert( uint64 key, GameVar* var )
+{
+    // Load factor not more than half
+    if( (count + 1) * 2 > entries.size() )
+        Rehash( entries.empty() ? 16 : (uint)entries.size() * 2 );
+
+    uint mask = (uint)entries.size() - 1;
+    uint i = GetBucket( key );
+    while( entries[i].Var )
+        i = (i + 1) & mask;
+    entries[i].Key = key;
+    entries[i].Var = var;
+    count++;
+}
+
+bool VarsHash::Erase( uint64 key )
+{
+    if( !count )
+        return false;
+
+    uint mask = (uint)entries.size() - 1;
+    uint i = GetBucket( key );
+    while( entries[i].Var && entries[i].Key != key )
+        i = (i + 1) & mask;
+    if( !entries[i].Var )
+        return false;
+
+    // Shift back following entries of cluster, to not leave holes in probe sequences
+    for( uint j = (i + 1) & mask; entries[j].Var; j = (j + 1) & mask )
+    {
+        uint k = GetBucket( entries[j].Key );
+        bool stay = (i <= j ? (i < k && k <= j) : (i < k || k <= j) );
+        if( !stay )
+        {
+            entries[i] = entries[j];
+            i = j;
+        }
+    }
+    entries[i].Var = NULL;
+    count--;
+    return true;
+}
+
+void VarsHash::Clear()
+{
+    entries.clear();
+    count = 0;
+}
+
+void VarsHash::Rehash( uint capacity )
+{
+    vector<Entry> old_entries;
+    old_entries.swap( entries );
+    Entry empty = { 0, NULL };
+    entries.resize( capacity, empty );
+    count = 0;
+    for( auto it = old_entries.begin(), end = old_entries.end(); it != end; ++it )
+        if( (*it).Var )
+            Insert( (*it).Key, (*it).Var );
+}
+
+/**************************************************************************************************
+***************************************************************************************************
+**************************************************************************************************/
+
 bool VarManager::Init( const char* fpath )
 {
     WriteLog( "Initialize var manager...\n" );
@@ -43,32 +132,46 @@ bool VarManager::Init( const char* fpath )
 #ifdef FOCLASSIC_SERVER
 void VarManager::SaveVarsDataFile( void (*save_func)( void*, size_t ) )
 {
+    // Same records as SaveVar, but written by one call per template
+    const uint record_size = sizeof(ushort) + sizeof(uint) + sizeof(uint) + sizeof(int);
+    UCharVec   buf;
+
     save_func( &varsCount, sizeof(varsCount) );
     for( auto it = tempVars.begin(), end = tempVars.end(); it != end; ++it )
     {
         TemplateVar* tvar = *it;
-        if( tvar )
+        if( !tvar || !tvar->Vars.GetCount() )
+            continue;
+
+        buf.resize( tvar->Vars.GetCount() * record_size );
+        uchar* ptr = &buf[0];
+        for( uint i = 0, j = tvar->Vars.GetCapacity(); i < j; i++ )
         {
-            for( auto it_ = tvar->Vars.begin(), end_ = tvar->Vars.end(); it_ != end_; ++it_ )
-            {
-                GameVar* var = (*it_).second;
-                save_func( &var->VarTemplate->TempId, sizeof(var->VarTemplate->TempId) );
-                save_func( &var->MasterId, sizeof(var->MasterId) );
-                save_func( &var->SlaveId, sizeof(var->SlaveId) );
-                save_func( &var->VarValue, sizeof(var->VarValue) );
-            }
-            for( auto it_ = tvar->VarsUnicum.begin(), end_ = tvar->VarsUnicum.end(); it_ != end_; ++it_ )
-            {
-                GameVar* var = (*it_).second;
-                save_func( &var->VarTemplate->TempId, sizeof(var->VarTemplate->TempId) );
-                save_func( &var->MasterId, sizeof(var->MasterId) );
-                save_func( &var->SlaveId, sizeof(var->SlaveId) );
-                save_func( &var->VarValue, sizeof(var->VarValue) );
-            }
+            GameVar* var = tvar->Vars.GetByIndex( i );
+            if( !var )
+                continue;
+
+            memcpy( ptr, &tvar->TempId, sizeof(ushort) );
+            ptr += sizeof(ushort);
+            memcpy( ptr, &var->MasterId, sizeof(uint) );
+            ptr += sizeof(uint);
+            memcpy( ptr, &var->SlaveId, sizeof(uint) );
+            ptr += sizeof(uint);
+            memcpy( ptr, &var->VarValue, sizeof(int) );
+            ptr += sizeof(int);
         }
+        save_func( &buf[0], buf.size() );
     }
 }
 
+void VarManager::SaveVar( GameVar* var, void (*save_func)( void*, size_t ) )
+{
+    save_func( &var->VarTemplate->TempId, sizeof(var->VarTemplate->TempId) );
+    save_func( &var->MasterId, sizeof(var->MasterId) );
+    save_func( &var->SlaveId, sizeof(var->SlaveId) );
+    save_func( &var->VarValue, sizeof(var->VarValue) );
+}
+
 bool VarManager::LoadVarsDataFile( void* f, int version )
 {
     WriteLog( "Load vars...\n" );
@@ -118,6 +221,7 @@ bool VarManager::LoadVarsDataFile( void* f, int version )
         }
 
         var->VarValue = val;
+        var->IsSaveChanged = true;
     }
 
     for( auto it = failed_tvars.begin(), end = failed_tvars.end(); it != end; ++it )
@@ -156,12 +260,13 @@ void VarManager::Clear()
         TemplateVar* tvar = *it;
         if( tvar )
         {
-            for( auto it_ = tvar->Vars.begin(), end_ = tvar->Vars.end(); it_ != end_; ++it_ )
-                (*it_).second->Release();
-            tvar->Vars.clear();
-            for( auto it_ = tvar->VarsUnicum.begin(), end_ = tvar->VarsUnicum.end(); it_ != end_; ++it_ )
-                (*it_).second->Release();
-            tvar->VarsUnicum.clear();
+            for( uint i = 0, j = tvar->Vars.GetCapacity(); i < j; i++ )
+            {
+                GameVar* var = tvar->Vars.GetByIndex( i );
+                if( var )
+                    var->Release();
+            }
+            tvar->Vars.Clear();
         }
     }
     varsCount = 0;
@@ -559,8 +664,8 @@ GameVar* VarManager::GetVar( ushort temp_id, uint master_id, uint slave_id,  boo
     {
         SCOPE_LOCK( varsLocker );
 
-        auto it = tvar->Vars.find( master_id );
-        if( it == tvar->Vars.end() )
+        var = tvar->Vars.Find( master_id );
+        if( !var )
         {
             if( !create )
                 return NULL;
@@ -569,18 +674,14 @@ GameVar* VarManager::GetVar( ushort temp_id, uint master_id, uint slave_id,  boo
                 return NULL;
             allocated = true;
         }
-        else
-        {
-            var = (*it).second;
-        }
     }
     else
     {
         SCOPE_LOCK( varsLocker );
 
         uint64 id = ( ( (uint64)slave_id ) << 32 ) | ( (uint64)master_id );
-        auto   it = tvar->VarsUnicum.find( id );
-        if( it == tvar->VarsUnicum.end() )
+        var = tvar->Vars.Find( id );
+        if( !var )
         {
             if( !create )
                 return NULL;
@@ -589,10 +690,6 @@ GameVar* VarManager::GetVar( ushort temp_id, uint master_id, uint slave_id,  boo
                 return NULL;
             allocated = true;
         }
-        else
-        {
-            var = (*it).second;
-        }
     }
 
     SYNC_LOCK( var );
@@ -622,7 +719,7 @@ GameVar* VarManager::CreateVar( uint master_id, TemplateVar* tvar )
     if( !var )
         return NULL;
 
-    tvar->Vars.insert( PAIR( master_id, var ) );
+    tvar->Vars.Insert( master_id, var );
 
     if( tvar->IsQuest() )
     {
@@ -655,7 +752,7 @@ GameVar* VarManager::CreateVarUnicum( uint64 id, uint master_id, uint slave_id,
     if( !var )
         return NULL;
 
-    tvar->VarsUnicum.insert( PAIR( id, var ) );
+    tvar->Vars.Insert( id, var );
 
     varsCount++;
     return var;
@@ -678,20 +775,20 @@ void VarManager::SwapVars( uint id1, uint id2 )
         {
             if( tvar->IsNotUnicum() )
             {
-                for( auto it_ = tvar->Vars.begin(), end_ = tvar->Vars.end(); it_ != end_; ++it_ )
-                {
-                    GameVar* var = (*it_).second;
-                    if( var->MasterId == id1 )
-                        swap_vars1.push_back( var );
-                    else if( var->MasterId == id2 )
-                        swap_vars2.push_back( var );
-                }
+                GameVar* var1 = tvar->Vars.Find( id1 );
+                if( var1 )
+                    swap_vars1.push_back( var1 );
+                GameVar* var2 = tvar->Vars.Find( id2 );
+                if( var2 )
+                    swap_vars2.push_back( var2 );
             }
             else
             {
-                for( auto it_ = tvar->VarsUnicum.begin(), end_ = tvar->VarsUnicum.end(); it_ != end_; ++it_ )
+                for( uint i = 0, j = tvar->Vars.GetCapacity(); i < j; i++ )
                 {
-                    GameVar* var = (*it_).second;
+                    GameVar* var = tvar->Vars.GetByIndex( i );
+                    if( !var )
+                        continue;
                     if( (var->MasterId == id1 && var->SlaveId == id2) ||
                         (var->MasterId == id2 && var->SlaveId == id1) )
                         swap_vars_share.push_back( var );
@@ -715,14 +812,15 @@ void VarManager::SwapVars( uint id1, uint id2 )
 
     // Swap shared
     varsLocker.Lock();
-    for( auto it = swap_vars_share.begin(), end = swap_vars_share.end(); it != end;)
+    for( auto it = swap_vars_share.begin(), end = swap_vars_share.end(); it != end; ++it )
     {
         GameVar*     var = *it;
         TemplateVar* tvar = var->VarTemplate;
 
-        tvar->VarsUnicum.erase( var->GetUid() );
+        AddRemovedVarKey( var );
+        tvar->Vars.Erase( var->GetUid() );
         std::swap( var->MasterId, var->SlaveId );
-        tvar->VarsUnicum.insert( PAIR( var->GetUid(), var ) );
+        tvar->Vars.Insert( var->GetUid(), var );
     }
 
     // Erase vars
@@ -730,19 +828,21 @@ void VarManager::SwapVars( uint id1, uint id2 )
     {
         GameVar*     var = *it;
         TemplateVar* tvar = var->VarTemplate;
+        AddRemovedVarKey( var );
         if( tvar->IsNotUnicum() )
-            tvar->Vars.erase( id1 );
+            tvar->Vars.Erase( id1 );
         else
-            tvar->VarsUnicum.erase( var->GetUid() );
+            tvar->Vars.Erase( var->GetUid() );
     }
     for( auto it = swap_vars2.begin(), end = swap_vars2.end(); it != end; ++it )
     {
         GameVar*     var = *it;
         TemplateVar* tvar = var->VarTemplate;
+        AddRemovedVarKey( var );
         if( tvar->IsNotUnicum() )
-            tvar->Vars.erase( id2 );
+            tvar->Vars.Erase( id2 );
         else
-            tvar->VarsUnicum.erase( var->GetUid() );
+            tvar->Vars.Erase( var->GetUid() );
     }
 
     // Change owner, place
@@ -754,7 +854,7 @@ void VarManager::SwapVars( uint id1, uint id2 )
         if( tvar->IsNotUnicum() )
         {
             var->MasterId = id2;
-            tvar->Vars.insert( PAIR( id2, var ) );
+            tvar->Vars.Insert( id2, var );
         }
         else
         {
@@ -762,7 +862,7 @@ void VarManager::SwapVars( uint id1, uint id2 )
                 var->MasterId = id2;
             else
                 var->SlaveId = id2;
-            tvar->VarsUnicum.insert( PAIR( var->GetUid(), var ) );
+            tvar->Vars.Insert( var->GetUid(), var );
         }
     }
     for( auto it = swap_vars2.begin(), end = swap_vars2.end(); it != end; ++it )
@@ -773,7 +873,7 @@ void VarManager::SwapVars( uint id1, uint id2 )
         if( tvar->IsNotUnicum() )
         {
             var->MasterId = id1;
-            tvar->Vars.insert( PAIR( id1, var ) );
+            tvar->Vars.Insert( id1, var );
         }
         else
         {
@@ -781,71 +881,60 @@ void VarManager::SwapVars( uint id1, uint id2 )
                 var->MasterId = id1;
             else
                 var->SlaveId = id1;
-            tvar->VarsUnicum.insert( PAIR( var->GetUid(), var ) );
+            tvar->Vars.Insert( var->GetUid(), var );
         }
     }
     varsLocker.Unlock();
 }
 
-uint VarManager::ClearUnusedVars( UIntSet& ids1, UIntSet& ids2, UIntSet& ids_locs, UIntSet& ids_maps, UIntSet& ids_items )
+bool VarManager::IsVarUnused( GameVar* var, CIdMask& ids1, CIdMask& ids2, CIdMask& ids_locs, CIdMask& ids_maps, CIdMask& ids_items )
 {
-    // Collect all vars
-    varsLocker.Lock();
-    VarsVec all_vars;
-    for( auto it = tempVars.begin(), end = tempVars.end(); it != end; ++it )
+    TemplateVar* tvar = var->VarTemplate;
+    if( var->VarValue == tvar->StartVal && !tvar->IsRandom() && !tvar->IsQuest() )
+        return true;
+
+    switch( var->Type )
     {
-        TemplateVar* tvar = *it;
-        if( tvar && tvar->Type != VAR_TYPE_GLOBAL )
-        {
-            for( auto it_ = tvar->Vars.begin(), end_ = tvar->Vars.end(); it_ != end_; ++it_ )
-                all_vars.push_back( (*it_).second );
-            for( auto it_ = tvar->VarsUnicum.begin(), end_ = tvar->VarsUnicum.end(); it_ != end_; ++it_ )
-                all_vars.push_back( (*it_).second );
-        }
+        case VAR_TYPE_LOCAL:
+            return !ids1.GetBit( var->MasterId ) && !ids2.GetBit( var->MasterId );
+        case VAR_TYPE_UNICUM:
+            return !ids1.GetBit( var->MasterId ) && !ids2.GetBit( var->MasterId ) &&
+                   !ids1.GetBit( var->SlaveId ) && !ids2.GetBit( var->SlaveId );
+        case VAR_TYPE_LOCAL_LOCATION:
+            return !ids_locs.GetBit( var->MasterId );
+        case VAR_TYPE_LOCAL_MAP:
+            return !ids_maps.GetBit( var->MasterId );
+        case VAR_TYPE_LOCAL_ITEM:
+            return !ids_items.GetBit( var->MasterId );
+        default:
+            break;
     }
-    varsLocker.Unlock();
+    return true;
+}
 
-    // Collect non used vars, synchronize it
+uint VarManager::ClearUnusedVars( CIdMask& ids1, CIdMask& ids2, CIdMask& ids_locs, CIdMask& ids_maps, CIdMask& ids_items )
+{
+    // Collect non used vars
     VarsVec del_vars;
-    for( auto it = all_vars.begin(); it != all_vars.end(); ++it )
+    varsLocker.Lock();
+    for( auto it = tempVars.begin(), end = tempVars.end(); it != end; ++it )
     {
-        GameVar*     var = *it;
-        TemplateVar* tvar = var->VarTemplate;
-
-        if( var->VarValue != var->VarTemplate->StartVal || tvar->IsRandom() || tvar->IsQuest() )
+        TemplateVar* tvar = *it;
+        if( tvar && tvar->Type != VAR_TYPE_GLOBAL )
         {
-            switch( var->Type )
+            for( uint i = 0, j = tvar->Vars.GetCapacity(); i < j; i++ )
             {
-                case VAR_TYPE_LOCAL:
-                    if( ids1.count( var->MasterId ) || ids2.count( var->MasterId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_UNICUM:
-                    if( ids1.count( var->MasterId ) || ids2.count( var->MasterId ) )
-                        continue;
-                    if( ids1.count( var->SlaveId ) || ids2.count( var->SlaveId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_LOCAL_LOCATION:
-                    if( ids_locs.count( var->MasterId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_LOCAL_MAP:
-                    if( ids_maps.count( var->MasterId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_LOCAL_ITEM:
-                    if( ids_items.count( var->MasterId ) )
-                        continue;
-                    break;
-                default:
-                    break;
+                GameVar* var = tvar->Vars.GetByIndex( i );
+                if( var && IsVarUnused( var, ids1, ids2, ids_locs, ids_maps, ids_items ) )
+                    del_vars.push_back( var );
             }
         }
-
-        del_vars.push_back( var );
-        SYNC_LOCK( var );
     }
+    varsLocker.Unlock();
+
+    // Synchronize
+    for( auto it = del_vars.begin(); it != del_vars.end(); ++it )
+        SYNC_LOCK( *it );
 
     // Delete vars
     uint del_count = 0;
@@ -856,45 +945,15 @@ uint VarManager::ClearUnusedVars( UIntSet& ids1, UIntSet& ids2, UIntSet& ids_loc
         TemplateVar* tvar = var->VarTemplate;
 
         // Be sure what var not changed between collection
-        if( var->VarValue != var->VarTemplate->StartVal || tvar->IsRandom() || tvar->IsQuest() )
-        {
-            switch( var->Type )
-            {
-                case VAR_TYPE_LOCAL:
-                    if( ids1.count( var->MasterId ) || ids2.count( var->MasterId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_UNICUM:
-                    if( ids1.count( var->MasterId ) || ids2.count( var->MasterId ) )
-                        continue;
-                    if( ids1.count( var->SlaveId ) || ids2.count( var->SlaveId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_LOCAL_LOCATION:
-                    if( ids_locs.count( var->MasterId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_LOCAL_MAP:
-                    if( ids_maps.count( var->MasterId ) )
-                        continue;
-                    break;
-                case VAR_TYPE_LOCAL_ITEM:
-                    if( ids_items.count( var->MasterId ) )
-                        continue;
-                    break;
-                default:
-                    break;
-            }
-        }
+        if( !IsVarUnused( var, ids1, ids2, ids_locs, ids_maps, ids_items ) )
+            continue;
 
         // Delete it
         if( tvar->IsQuest() )
             allQuestVars[var->QuestVarIndex] = NULL;
 
-        if( tvar->IsNotUnicum() )
-            tvar->Vars.erase( var->MasterId );
-        else
-            tvar->VarsUnicum.erase( var->GetUid() );
+        tvar->Vars.Erase( var->GetUid() );
+        AddRemovedVarKey( var );
 
         Job::DeferredRelease( var );
 
@@ -906,6 +965,21 @@ uint VarManager::ClearUnusedVars( UIntSet& ids1, UIntSet& ids2, UIntSet& ids_loc
     return del_count;
 }
 
+void VarManager::AddRemovedVarKey( GameVar* var )
+{
+    removedVarKeys.push_back( var->VarTemplate->TempId );
+    removedVarKeys.push_back( var->MasterId );
+    removedVarKeys.push_back( var->SlaveId );
+    var->IsSaveChanged = true;
+}
+
+void VarManager::GetRemovedVarKeys( UIntVec& keys )
+{
+    SCOPE_LOCK( varsLocker );
+    keys.swap( removedVarKeys );
+    removedVarKeys.clear();
+}
+
 void VarManager::GetQuestVars( uint master_id, UIntVec& vars )
 {
     SCOPE_LOCK( varsLocker );
@@ -942,10 +1016,50 @@ void SendQuestVar( GameVar* var )
         cl->Send_Quest( var->GetQuestStr() );
 }
 
+// Vars pool, memory is not returned to system
+#define VAR_POOL_CHUNK    (4096)
+MutexSpinlock VarPoolLocker;
+void*         VarPoolFree = NULL;
+
+void* GameVar::operator new( size_t )
+{
+    SCOPE_LOCK( VarPoolLocker );
+
+    if( !VarPoolFree )
+    {
+        size_t slot_size = MAX( sizeof(GameVar), sizeof(void*) );
+        char*  chunk = (char*)malloc( slot_size * VAR_POOL_CHUNK );
+        if( !chunk )
+            throw std::bad_alloc();
+        for( uint i = 0; i < VAR_POOL_CHUNK; i++ )
+        {
+            void* slot = chunk + slot_size * i;
+            *(void**)slot = VarPoolFree;
+            VarPoolFree = slot;
+        }
+    }
+
+    void* ptr = VarPoolFree;
+    VarPoolFree = *(void**)ptr;
+    return ptr;
+}
+
+void GameVar::operator delete( void* ptr )
+{
+    if( !ptr )
+        return;
+
+    SCOPE_LOCK( VarPoolLocker );
+
+    *(void**)ptr = VarPoolFree;
+    VarPoolFree = ptr;
+}
+
 GameVar::GameVar( uint master_id, uint slave_id, TemplateVar* var_template, int val ) : MasterId( master_id ), SlaveId( slave_id ), VarTemplate( var_template ), QuestVarIndex( 0 ),
-    Type( var_template->Type ), VarValue( val ), RefCount( 1 )
+    Type( var_template->Type ), VarValue( val ), RefCount( 1 ), IsSaveChanged( true ), SaveCrc( 0 )
 {
     MEMORY_PROCESS( MEMORY_VAR, sizeof(GameVar) );
+    Sync.SetType( SYNC_OBJECT_VAR );
 }
 
 GameVar::~GameVar()
@@ -956,6 +1070,7 @@ GameVar::~GameVar()
 GameVar& GameVar::operator+=( const int _right )
 {
     VarValue += _right;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue > VarTemplate->MaxVal )
         VarValue = VarTemplate->MaxVal;
     if( IsQuest() )
@@ -968,6 +1083,7 @@ GameVar& GameVar::operator+=( const int _right )
 GameVar& GameVar::operator-=( const int _right )
 {
     VarValue -= _right;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue < VarTemplate->MinVal )
         VarValue = VarTemplate->MinVal;
     if( IsQuest() )
@@ -980,6 +1096,7 @@ GameVar& GameVar::operator-=( const int _right )
 GameVar& GameVar::operator*=( const int _right )
 {
     VarValue *= _right;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue > VarTemplate->MaxVal )
         VarValue = VarTemplate->MaxVal;
     if( IsQuest() )
@@ -992,6 +1109,7 @@ GameVar& GameVar::operator*=( const int _right )
 GameVar& GameVar::operator/=( const int _right )
 {
     VarValue /= _right;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue < VarTemplate->MinVal )
         VarValue = VarTemplate->MinVal;
     if( IsQuest() )
@@ -1004,6 +1122,7 @@ GameVar& GameVar::operator/=( const int _right )
 GameVar& GameVar::operator=( const int _right )
 {
     VarValue = _right;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() )
     {
         if( VarValue > VarTemplate->MaxVal )
@@ -1021,6 +1140,7 @@ GameVar& GameVar::operator=( const int _right )
 GameVar& GameVar::operator+=( const GameVar& _right )
 {
     VarValue += _right.VarValue;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue > VarTemplate->MaxVal )
         VarValue = VarTemplate->MaxVal;
     if( IsQuest() )
@@ -1033,6 +1153,7 @@ GameVar& GameVar::operator+=( const GameVar& _right )
 GameVar& GameVar::operator-=( const GameVar& _right )
 {
     VarValue -= _right.VarValue;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue < VarTemplate->MinVal )
         VarValue = VarTemplate->MinVal;
     if( IsQuest() )
@@ -1045,6 +1166,7 @@ GameVar& GameVar::operator-=( const GameVar& _right )
 GameVar& GameVar::operator*=( const GameVar& _right )
 {
     VarValue *= _right.VarValue;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue > VarTemplate->MaxVal )
         VarValue = VarTemplate->MaxVal;
     if( IsQuest() )
@@ -1057,6 +1179,7 @@ GameVar& GameVar::operator*=( const GameVar& _right )
 GameVar& GameVar::operator/=( const GameVar& _right )
 {
     VarValue /= _right.VarValue;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() && VarValue < VarTemplate->MinVal )
         VarValue = VarTemplate->MinVal;
     if( IsQuest() )
@@ -1069,6 +1192,7 @@ GameVar& GameVar::operator/=( const GameVar& _right )
 GameVar& GameVar::operator=( const GameVar& _right )
 {
     VarValue = _right.VarValue;
+    IsSaveChanged = true;
     if( !VarTemplate->IsNoBorders() )
     {
         if( VarValue > VarTemplate->MaxVal )
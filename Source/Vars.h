@@ -1,6 +1,7 @@
 #ifndef __VARS__
 #define __VARS__
 
+#include "DataMask.h"
 #include "Defines.h"
 #include "Mutex.h"
 #include "ThreadSync.h"
@@ -15,10 +16,34 @@
 // Typedefs
 class TemplateVar;
 class GameVar;
-typedef vector<TemplateVar*>  TempVarVec;
-typedef map<uint, GameVar*>   VarsMap32;
-typedef map<uint64, GameVar*> VarsMap64;
-typedef vector<GameVar*>      VarsVec;
+typedef vector<TemplateVar*> TempVarVec;
+typedef vector<GameVar*>     VarsVec;
+
+// Open addressing hash with linear probing, key is var uid
+class VarsHash
+{
+public:
+    VarsHash() : count( 0 ) {}
+    GameVar* Find( uint64 key );
+    void     Insert( uint64 key, GameVar* var ); // Key must be absent
+    bool     Erase( uint64 key );
+    void     Clear();
+    uint     GetCount()                { return count; }
+    uint     GetCapacity()             { return (uint)entries.size(); }
+    GameVar* GetByIndex( uint index )  { return entries[index].Var; } // Null for empty slot
+
+private:
+    struct Entry
+    {
+        uint64   Key;
+        GameVar* Var;
+    };
+    vector<Entry> entries;
+    uint          count;
+
+    uint GetBucket( uint64 key );
+    void Rehash( uint capacity );
+};
 
 
 class TemplateVar
@@ -33,8 +58,7 @@ public:
     int       MaxVal;
     uint      Flags;
 
-    VarsMap32 Vars;
-    VarsMap64 VarsUnicum;
+    VarsHash  Vars; // Uid of var, master id for not unicum
 
     bool IsNotUnicum() { return Type != VAR_TYPE_UNICUM; }
     bool IsError()     { return !TempId || !Name.size() || (IsNoBorders() && (MinVal > MaxVal || StartVal < MinVal || StartVal > MaxVal) ) || (IsQuest() && Type != VAR_TYPE_LOCAL);  }
@@ -56,8 +80,10 @@ public:
     TemplateVar* VarTemplate;
     uint         QuestVarIndex;
     ushort       Type;
-    short        RefCount;
+    long         RefCount;
     SyncObject   Sync;
+    bool         IsSaveChanged; // Written to next world save journal
+    uint         SaveCrc;       // Checksum of last saved record
 
     GameVar& operator+=( const int _right );
     GameVar& operator-=( const int _right );
@@ -101,8 +127,12 @@ public:
     uint         GetMasterId()    { return MasterId; }
     uint         GetSlaveId()     { return SlaveId; }
 
-    void AddRef()  { RefCount++; }
-    void Release() { if( !--RefCount ) delete this; }
+    void AddRef()  { InterlockedIncrement( &RefCount ); }
+    void Release() { if( !InterlockedDecrement( &RefCount ) ) delete this; }
+
+    // Allocated from pool
+    static void* operator new( size_t size );
+    static void  operator delete( void* ptr );
 
     GameVar( uint master_id, uint slave_id, TemplateVar* var_template, int val );
     ~GameVar();
@@ -153,6 +183,7 @@ public:
     #ifdef FOCLASSIC_SERVER
 public:
     void     SaveVarsDataFile( void (* save_func)( void*, size_t ) );
+    void     SaveVar( GameVar* var, void (* save_func)( void*, size_t ) );
     bool     LoadVarsDataFile( void* f, int version );
     bool     CheckVar( const char* var_name, uint master_id, uint slave_id, char oper, int val );
     bool     CheckVar( ushort temp_id, uint master_id, uint slave_id, char oper, int val );
@@ -161,7 +192,8 @@ public:
     GameVar* GetVar( const char* var_name, uint master_id, uint slave_id,  bool create );
     GameVar* GetVar( ushort temp_id, uint master_id, uint slave_id,  bool create );
     void     SwapVars( uint id1, uint id2 );
-    uint     ClearUnusedVars( UIntSet& ids1, UIntSet& ids2, UIntSet& ids_locs, UIntSet& ids_maps, UIntSet& ids_items );
+    uint     ClearUnusedVars( CIdMask& ids1, CIdMask& ids2, CIdMask& ids_locs, CIdMask& ids_maps, CIdMask& ids_items );
+    void     GetRemovedVarKeys( UIntVec& keys );
     void     GetQuestVars( uint master_id, UIntVec& vars );
     VarsVec& GetQuestVars() { return allQuestVars; }
     uint     GetVarsCount() { return varsCount; }
@@ -169,9 +201,13 @@ public:
 private:
     VarsVec allQuestVars;
     uint    varsCount;
+    UIntVec removedVarKeys; // Temp id, master id, slave id of removed or rekeyed vars, for world save journal
+
+    void     AddRemovedVarKey( GameVar* var );
 
     bool     CheckVar( GameVar* var, char oper, int val );
     void     ChangeVar( GameVar* var, char oper, int val );
+    bool     IsVarUnused( GameVar* var, CIdMask& ids1, CIdMask& ids2, CIdMask& ids_locs, CIdMask& ids_maps, CIdMask& ids_items );
     GameVar* CreateVar( uint master_id, TemplateVar* tvar );
     GameVar* CreateVarUnicum( uint64 id, uint master_id, uint slave_id, TemplateVar* tvar );
     #endif // FOCLASSIC_SERVER